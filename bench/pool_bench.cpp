@@ -0,0 +1,93 @@
+#include "klv.h"
+#include "klv_thread_pool.h"
+#include "st0601.h"
+#include "st0601_scan.h"
+#include "stanag.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+template <typename Fn>
+static double time_ms(Fn fn) {
+    const auto start = Clock::now();
+    fn();
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+// Synthetic ST 0601 corpus: |n| packets of a slowly moving platform
+static std::vector<std::vector<stanag::TagValue>> make_corpus(size_t n) {
+    using namespace misb::st0601;
+    std::vector<std::vector<stanag::TagValue>> corpus;
+    corpus.reserve(n);
+    for (size_t i = 0; i < n; ++i) {
+        const double t = static_cast<double>(i);
+        corpus.push_back({
+            stanag::TagValue(UNIX_TIMESTAMP, 1700000000000000.0 + t * 33333.0),
+            stanag::TagValue(PLATFORM_HEADING_ANGLE, static_cast<double>(i % 360)),
+            stanag::TagValue(PLATFORM_PITCH_ANGLE, 2.5),
+            stanag::TagValue(PLATFORM_ROLL_ANGLE, -1.5),
+            stanag::TagValue(SENSOR_LATITUDE, 45.0 + 1e-5 * t),
+            stanag::TagValue(SENSOR_LONGITUDE, -75.0 + 1e-5 * t),
+            stanag::TagValue(SENSOR_TRUE_ALTITUDE, 1500.0),
+            stanag::TagValue(FRAME_CENTER_LATITUDE, 45.01 + 1e-5 * t),
+            stanag::TagValue(FRAME_CENTER_LONGITUDE, -75.01 + 1e-5 * t),
+            stanag::TagValue(UAS_LS_VERSION_NUMBER, 12.0)
+        });
+    }
+    return corpus;
+}
+
+int main(int argc, char** argv) {
+    auto& reg = KLVRegistry::instance();
+    misb::st0601::register_st0601(reg);
+
+    const size_t packets = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 100000;
+    const unsigned max_threads = std::max(1u, std::thread::hardware_concurrency());
+    const auto corpus = make_corpus(packets);
+
+    std::vector<uint8_t> archive;
+    {
+        ThreadPool pool(max_threads);
+        for (const auto& p : stanag::create_stanag4609_packets(corpus, pool)) {
+            archive.insert(archive.end(), p.begin(), p.end());
+        }
+    }
+    misb::st0601::ScanQuery query;
+    query.frame_center_within(45.0, 46.0, -76.0, -74.0);
+
+    std::printf("%zu packets, %zu bytes\n", packets, archive.size());
+    std::printf("%8s %12s %12s %12s %10s\n", "threads", "encode ms", "scan ms", "decode ms", "speedup");
+    // 1, 2, 4, ... and the full machine
+    std::vector<unsigned> counts;
+    for (unsigned threads = 1; threads < max_threads; threads *= 2) counts.push_back(threads);
+    counts.push_back(max_threads);
+
+    double base = 0.0;
+    for (unsigned threads : counts) {
+        ThreadPoolConfig config;
+        config.threads = threads;
+        config.pin_threads = true;
+        ThreadPool pool(config);
+        const double encode = time_ms([&]() {
+            auto out = stanag::create_stanag4609_packets(corpus, pool);
+            (void)out;
+        });
+        std::vector<stanag::PacketView> hits;
+        const double scan = time_ms([&]() {
+            hits = misb::st0601::scan(archive.data(), archive.size(), query, pool);
+        });
+        const double decode = time_ms([&]() {
+            auto sets = misb::st0601::decode_matches(archive.data(), hits, pool);
+            (void)sets;
+        });
+        const double total = encode + scan + decode;
+        if (threads == 1) base = total;
+        std::printf("%8u %12.1f %12.1f %12.1f %9.2fx\n", threads, encode, scan, decode, base / total);
+    }
+    return 0;
+}
@@ -0,0 +1,96 @@
+#include "klv.h"
+#include "st0601.h"
+#include "st0102.h"
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+template <typename Fn>
+static double ns_per_op(size_t ops, Fn fn) {
+    const auto start = Clock::now();
+    fn();
+    const auto elapsed = std::chrono::duration<double, std::nano>(Clock::now() - start);
+    return elapsed.count() / static_cast<double>(ops);
+}
+
+// ST 0601 packet with a nested ST 0102 security set
+static KLVSet make_packet() {
+    using namespace misb::st0601;
+    KLVSet packet(false, ST_ID);
+    packet.add(std::make_shared<KLVLeaf>(UNIX_TIMESTAMP, 1700000000000000.0, true));
+    packet.add(std::make_shared<KLVLeaf>(PLATFORM_HEADING_ANGLE, 90.0, true));
+    packet.add(std::make_shared<KLVLeaf>(PLATFORM_PITCH_ANGLE, 2.5, true));
+    packet.add(std::make_shared<KLVLeaf>(PLATFORM_ROLL_ANGLE, -1.5, true));
+    packet.add(std::make_shared<KLVLeaf>(SENSOR_LATITUDE, 45.0, true));
+    packet.add(std::make_shared<KLVLeaf>(SENSOR_LONGITUDE, -75.0, true));
+    packet.add(std::make_shared<KLVLeaf>(SENSOR_TRUE_ALTITUDE, 1500.0, true));
+    packet.add(std::make_shared<KLVLeaf>(FRAME_CENTER_LATITUDE, 45.01, true));
+    packet.add(std::make_shared<KLVLeaf>(FRAME_CENTER_LONGITUDE, -75.01, true));
+    auto security = std::make_shared<KLVSet>(false, misb::st0102::ST_ID);
+    security->add(std::make_shared<KLVLeaf>(misb::st0102::CLASSIFICATION, 1.0, true));
+    security->add(std::make_shared<KLVLeaf>(misb::st0102::CLASSIFICATION_SYSTEM, 1.0, true));
+    packet.add(security);
+    packet.add(std::make_shared<KLVLeaf>(UAS_LS_VERSION_NUMBER, 12.0, true));
+    return packet;
+}
+
+int main() {
+    auto& reg = KLVRegistry::instance();
+    misb::st0601::register_st0601(reg);
+    misb::st0102::register_st0102(reg);
+
+    const size_t n = 1u << 18;
+    const KLVSet packet = make_packet();
+    const std::vector<uint8_t> bytes = packet.encode();
+    volatile size_t sink = 0;
+
+    const double copy = ns_per_op(n, [&]() {
+        for (size_t i = 0; i < n; ++i) {
+            KLVSet c(packet);
+            sink = sink + c.children().size();
+        }
+    });
+    const double decode = ns_per_op(n, [&]() {
+        KLVSet s(false, misb::st0601::ST_ID);
+        for (size_t i = 0; i < n; ++i) {
+            s.decode(bytes);
+            sink = sink + s.children().size();
+        }
+    });
+    const double encode = ns_per_op(n, [&]() {
+        std::vector<uint8_t> out;
+        for (size_t i = 0; i < n; ++i) {
+            out.clear();
+            packet.encode_into(out);
+            sink = sink + out.size();
+        }
+    });
+
+    KLVSet memo = make_packet();
+    memo.set_encode_cache(true);
+    const double memo_copy = ns_per_op(n, [&]() {
+        for (size_t i = 0; i < n; ++i) {
+            KLVSet c(memo);
+            sink = sink + c.children().size();
+        }
+    });
+    const double memo_encode = ns_per_op(n, [&]() {
+        std::vector<uint8_t> out;
+        for (size_t i = 0; i < n; ++i) {
+            out.clear();
+            memo.encode_into(out);
+            sink = sink + out.size();
+        }
+    });
+
+    std::printf("%zu-item ST 0601 set, %zu ops\n", packet.children().size(), n);
+    std::printf("copy          %8.1f ns/op\n", copy);
+    std::printf("decode        %8.1f ns/op\n", decode);
+    std::printf("encode        %8.1f ns/op\n", encode);
+    std::printf("memo copy     %8.1f ns/op\n", memo_copy);
+    std::printf("memo encode   %8.1f ns/op\n", memo_encode);
+    return 0;
+}
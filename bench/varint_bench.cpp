@@ -0,0 +1,83 @@
+#include "klv_varint.h"
+#include "st_common.h"
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+template <typename Fn>
+static double ns_per_op(size_t ops, Fn fn) {
+    const auto start = Clock::now();
+    fn();
+    const auto elapsed = std::chrono::duration<double, std::nano>(Clock::now() - start);
+    return elapsed.count() / static_cast<double>(ops);
+}
+
+int main() {
+    const size_t n = 1u << 22;
+    std::vector<uint64_t> values(n);
+    uint64_t x = 0x9E3779B97F4A7C15ull;
+    for (auto& v : values) {
+        x ^= x << 13;
+        x ^= x >> 7;
+        x ^= x << 17;
+        v = x >> (x & 63); // spread across all widths
+    }
+    std::vector<uint8_t> out(n * 10);
+    volatile uint64_t sink = 0;
+
+    const double vec_len = ns_per_op(n, [&]() {
+        for (uint64_t v : values) {
+            auto bytes = misb::encode_ber_length(static_cast<size_t>(v));
+            sink = sink + bytes.size();
+        }
+    });
+    const double ptr_len = ns_per_op(n, [&]() {
+        uint8_t* p = out.data();
+        for (uint64_t v : values) {
+            p += misb::write_ber_length(p, 16, v);
+        }
+        sink = sink + static_cast<uint64_t>(p - out.data());
+    });
+    const double read_len = ns_per_op(n, [&]() {
+        const uint8_t* p = out.data();
+        const uint8_t* end = out.data() + out.size();
+        for (size_t i = 0; i < n; ++i) {
+            size_t len = 0;
+            p += misb::read_ber_length(p, static_cast<size_t>(end - p), len);
+            sink = sink + len;
+        }
+    });
+    const double write_oid = ns_per_op(n, [&]() {
+        uint8_t* p = out.data();
+        for (uint64_t v : values) {
+            p += misb::write_ber_oid(p, 16, v);
+        }
+        sink = sink + static_cast<uint64_t>(p - out.data());
+    });
+    const double read_oid = ns_per_op(n, [&]() {
+        const uint8_t* p = out.data();
+        const uint8_t* end = out.data() + out.size();
+        for (size_t i = 0; i < n; ++i) {
+            uint64_t v = 0;
+            p += misb::read_ber_oid(p, static_cast<size_t>(end - p), v);
+            sink = sink + v;
+        }
+    });
+    const double write_uint = ns_per_op(n, [&]() {
+        uint8_t* p = out.data();
+        for (uint64_t v : values) {
+            p += misb::write_uint_be(p, 8, v, misb::uint_byte_width(v));
+        }
+        sink = sink + static_cast<uint64_t>(p - out.data());
+    });
+
+    std::printf("encode_ber_length (vector) %6.2f ns/op\n", vec_len);
+    std::printf("write_ber_length           %6.2f ns/op\n", ptr_len);
+    std::printf("read_ber_length            %6.2f ns/op\n", read_len);
+    std::printf("write_ber_oid              %6.2f ns/op\n", write_oid);
+    std::printf("read_ber_oid               %6.2f ns/op\n", read_oid);
+    std::printf("write_uint_be (min width)  %6.2f ns/op\n", write_uint);
+    return 0;
+}
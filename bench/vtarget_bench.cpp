@@ -0,0 +1,96 @@
+#include "klv.h"
+#include "klv_macros.h"
+#include "st0903.h"
+#include "st0903_table.h"
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+template <typename Fn>
+static double time_us(int iterations, Fn fn) {
+    const auto start = Clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        fn();
+    }
+    const auto elapsed = std::chrono::duration<double, std::micro>(Clock::now() - start);
+    return elapsed.count() / iterations;
+}
+
+static misb::st0903::VTargetTable make_table(size_t n) {
+    using namespace misb::st0903;
+    VTargetTable t;
+    t.reserve(n);
+    for (size_t i = 0; i < n; ++i) {
+        const size_t r = t.add(i + 1);
+        t.centroid[r] = 100000 + i;
+        t.bbox_top_left[r] = 90000 + i;
+        t.bbox_bottom_right[r] = 110000 + i;
+        t.confidence[r] = 0.5;
+        t.lat_offset[r] = 0.001 * static_cast<double>(i % 100);
+        t.lon_offset[r] = -0.001 * static_cast<double>(i % 100);
+        t.hae[r] = 250.0;
+        t.detection_status[r] = 1;
+        t.present[r] = VTARGET_FIELD_CENTROID | VTARGET_FIELD_BBOX_TOP_LEFT |
+                       VTARGET_FIELD_BBOX_BOTTOM_RIGHT | VTARGET_FIELD_CONFIDENCE |
+                       VTARGET_FIELD_LAT_OFFSET | VTARGET_FIELD_LON_OFFSET |
+                       VTARGET_FIELD_HAE | VTARGET_FIELD_DETECTION_STATUS;
+    }
+    return t;
+}
+
+static std::vector<misb::st0903::VTargetPack> make_packs(const misb::st0903::VTargetTable& t) {
+    using namespace misb::st0903;
+    std::vector<VTargetPack> packs;
+    packs.reserve(t.size());
+    for (size_t r = 0; r < t.size(); ++r) {
+        packs.push_back(KLV_VTARGET_PACK(
+            t.id[r],
+            KLV_TAG(VTARGET_CENTROID, static_cast<double>(t.centroid[r])),
+            KLV_TAG(VTARGET_BBOX_TOP_LEFT_PIXEL, static_cast<double>(t.bbox_top_left[r])),
+            KLV_TAG(VTARGET_BBOX_BOTTOM_RIGHT_PIXEL, static_cast<double>(t.bbox_bottom_right[r])),
+            KLV_TAG(VTARGET_CONFIDENCE_LEVEL, t.confidence[r]),
+            KLV_TAG(VTARGET_LOCATION_OFFSET_LAT, t.lat_offset[r]),
+            KLV_TAG(VTARGET_LOCATION_OFFSET_LON, t.lon_offset[r]),
+            KLV_TAG(VTARGET_LOCATION_HAE, t.hae[r]),
+            KLV_TAG(VTARGET_DETECTION_STATUS, static_cast<double>(t.detection_status[r]))
+        ));
+    }
+    return packs;
+}
+
+int main() {
+    auto& reg = KLVRegistry::instance();
+    misb::st0903::register_st0903(reg);
+
+    std::printf("%8s %14s %14s %14s %14s %14s\n", "targets", "series enc us",
+                "table enc us", "table enc 4t", "series dec us", "table dec us");
+    const size_t sizes[] = {100, 1000, 10000};
+    for (size_t n : sizes) {
+        const int iterations = n >= 10000 ? 5 : 50;
+        auto table = make_table(n);
+        auto packs = make_packs(table);
+        std::vector<uint8_t> series;
+        const double legacy_enc = time_us(iterations, [&]() {
+            series = misb::st0903::encode_vtarget_series(packs);
+        });
+        const double table_enc = time_us(iterations, [&]() {
+            series = misb::st0903::encode_vtarget_table(table);
+        });
+        const double table_enc_mt = time_us(iterations, [&]() {
+            series = misb::st0903::encode_vtarget_table(table, 4);
+        });
+        const double legacy_dec = time_us(iterations, [&]() {
+            auto decoded = misb::st0903::decode_vtarget_series(series);
+            (void)decoded;
+        });
+        misb::st0903::VTargetTable decoded_table;
+        const double table_dec = time_us(iterations, [&]() {
+            misb::st0903::decode_vtarget_table(series, decoded_table);
+        });
+        std::printf("%8zu %14.1f %14.1f %14.1f %14.1f %14.1f\n", n, legacy_enc, table_enc,
+                    table_enc_mt, legacy_dec, table_dec);
+    }
+    return 0;
+}
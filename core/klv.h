@@ -1,7 +1,9 @@
 #pragma once
 #include "klv_types.h"
+#include "klv_buffer.h"
 #include "klv_node.h"
 #include "klv_leaf.h"
 #include "klv_bytes.h"
 #include "klv_set.h"
+#include "klv_flat_set.h"
 #include "klv_registry.h"
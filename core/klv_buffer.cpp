@@ -0,0 +1,143 @@
+#include "klv_buffer.h"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#ifdef KLV_HAVE_IOVEC
+#include <cerrno>
+#include <climits>
+#include <unistd.h>
+#ifndef IOV_MAX
+#define IOV_MAX 1024
+#endif
+#endif
+
+constexpr size_t SegmentList::REFERENCE_THRESHOLD;
+
+ByteSlice::ByteSlice(Buffer buffer)
+    : buffer_(std::move(buffer)), offset_(0), size_(buffer_ ? buffer_->size() : 0) {}
+
+ByteSlice::ByteSlice(Buffer buffer, size_t offset, size_t size)
+    : buffer_(std::move(buffer)), offset_(offset), size_(size) {
+    const size_t available = buffer_ ? buffer_->size() : 0;
+    if (offset > available || size > available - offset) {
+        throw std::out_of_range("ByteSlice outside of its buffer");
+    }
+}
+
+ByteSlice ByteSlice::copy(const uint8_t* data, size_t size) {
+    return ByteSlice(std::make_shared<const std::vector<uint8_t>>(data, data + size));
+}
+
+ByteSlice ByteSlice::adopt(std::vector<uint8_t>&& bytes) {
+    return ByteSlice(std::make_shared<const std::vector<uint8_t>>(std::move(bytes)));
+}
+
+ByteSlice ByteSlice::borrow(const std::vector<uint8_t>& bytes) {
+    // Aliasing constructor with an empty owner: no reference is kept
+    return ByteSlice(Buffer(std::shared_ptr<void>(), &bytes));
+}
+
+ByteSlice ByteSlice::slice(size_t offset, size_t size) const {
+    if (offset > size_ || size > size_ - offset) {
+        throw std::out_of_range("ByteSlice::slice outside of the slice");
+    }
+    return ByteSlice(buffer_, offset_ + offset, size);
+}
+
+bool operator==(const ByteSlice& a, const ByteSlice& b) {
+    return a.size() == b.size() &&
+           (a.size() == 0 || std::memcmp(a.data(), b.data(), a.size()) == 0);
+}
+
+void SegmentList::append(const uint8_t* data, size_t size) {
+    if (size == 0) return;
+    if (parts_.empty() || !parts_.back().in_scratch) {
+        parts_.push_back(Part{true, scratch_.size(), 0, ByteSlice()});
+    }
+    scratch_.insert(scratch_.end(), data, data + size);
+    parts_.back().size += size;
+    size_ += size;
+}
+
+void SegmentList::append(const ByteSlice& slice) {
+    if (slice.size() < REFERENCE_THRESHOLD) {
+        append(slice.data(), slice.size());
+        return;
+    }
+    parts_.push_back(Part{false, 0, slice.size(), slice});
+    size_ += slice.size();
+}
+
+void SegmentList::append(const SegmentList& other) {
+    for (const auto& part : other.parts_) {
+        if (part.in_scratch) {
+            append(other.scratch_.data() + part.offset, part.size);
+        } else {
+            parts_.push_back(part);
+            size_ += part.size;
+        }
+    }
+}
+
+SegmentList::Segment SegmentList::segment(size_t i) const {
+    const Part& part = parts_.at(i);
+    if (part.in_scratch) return Segment{scratch_.data() + part.offset, part.size};
+    return Segment{part.slice.data(), part.size};
+}
+
+void SegmentList::clear() {
+    scratch_.clear();
+    parts_.clear();
+    size_ = 0;
+}
+
+std::vector<uint8_t> SegmentList::flatten() const {
+    std::vector<uint8_t> out;
+    out.reserve(size_);
+    for (size_t i = 0; i < parts_.size(); ++i) {
+        const Segment s = segment(i);
+        out.insert(out.end(), s.data, s.data + s.size);
+    }
+    return out;
+}
+
+#ifdef KLV_HAVE_IOVEC
+size_t fill_iovec(const SegmentList& segments, std::vector<struct iovec>& out) {
+    const size_t count = segments.segment_count();
+    out.reserve(out.size() + count);
+    for (size_t i = 0; i < count; ++i) {
+        const SegmentList::Segment s = segments.segment(i);
+        struct iovec v;
+        v.iov_base = const_cast<uint8_t*>(s.data);
+        v.iov_len = s.size;
+        out.push_back(v);
+    }
+    return count;
+}
+
+bool write_segments(int fd, const SegmentList& segments) {
+    std::vector<struct iovec> iov;
+    fill_iovec(segments, iov);
+    size_t first = 0;
+    while (first < iov.size()) {
+        const int count = static_cast<int>(std::min<size_t>(iov.size() - first, IOV_MAX));
+        const ssize_t written = ::writev(fd, iov.data() + first, count);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        // Skip fully written segments, trim a partially written one
+        size_t left = static_cast<size_t>(written);
+        while (first < iov.size() && left >= iov[first].iov_len) {
+            left -= iov[first].iov_len;
+            ++first;
+        }
+        if (left > 0) {
+            iov[first].iov_base = static_cast<uint8_t*>(iov[first].iov_base) + left;
+            iov[first].iov_len -= left;
+        }
+    }
+    return true;
+}
+#endif
@@ -0,0 +1,109 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/uio.h>
+#define KLV_HAVE_IOVEC 1
+#endif
+
+// Reference-counted view into an immutable byte buffer. Slices of a
+// received packet keep the packet alive instead of copying large values
+// (VChip images, VMask polygons, opaque nested sets) out of it.
+class ByteSlice {
+public:
+    using Buffer = std::shared_ptr<const std::vector<uint8_t>>;
+
+    ByteSlice() : offset_(0), size_(0) {}
+    // Whole buffer
+    explicit ByteSlice(Buffer buffer);
+    // [offset, offset + size) of |buffer|; throws std::out_of_range
+    ByteSlice(Buffer buffer, size_t offset, size_t size);
+
+    static ByteSlice copy(const uint8_t* data, size_t size);
+    static ByteSlice copy(const std::vector<uint8_t>& bytes) {
+        return copy(bytes.data(), bytes.size());
+    }
+    // Take ownership of |bytes| without copying
+    static ByteSlice adopt(std::vector<uint8_t>&& bytes);
+    // Non-owning view: |bytes| must outlive the slice and its copies
+    static ByteSlice borrow(const std::vector<uint8_t>& bytes);
+
+    const uint8_t* data() const { return buffer_ ? buffer_->data() + offset_ : nullptr; }
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    const uint8_t* begin() const { return data(); }
+    const uint8_t* end() const { return data() + size_; }
+    uint8_t operator[](size_t i) const { return data()[i]; }
+
+    // Sub-slice sharing the same buffer; throws std::out_of_range
+    ByteSlice slice(size_t offset, size_t size) const;
+
+    const Buffer& buffer() const { return buffer_; }
+    size_t offset() const { return offset_; }
+    // True when the slice spans its entire buffer
+    bool whole() const { return buffer_ && offset_ == 0 && size_ == buffer_->size(); }
+
+    std::vector<uint8_t> to_vector() const { return std::vector<uint8_t>(begin(), end()); }
+
+private:
+    Buffer buffer_;
+    size_t offset_;
+    size_t size_;
+};
+
+bool operator==(const ByteSlice& a, const ByteSlice& b);
+inline bool operator!=(const ByteSlice& a, const ByteSlice& b) { return !(a == b); }
+
+// Encoded output as an ordered list of segments. Keys, lengths and small
+// values are appended to an owned scratch buffer; large slices are
+// referenced in place, so a writer can hand the segments to writev/sendmsg
+// without flattening them.
+class SegmentList {
+public:
+    // Slices at least this long are referenced instead of copied
+    static constexpr size_t REFERENCE_THRESHOLD = 256;
+
+    struct Segment {
+        const uint8_t* data;
+        size_t size;
+    };
+
+    void append(const uint8_t* data, size_t size);
+    void append(uint8_t byte) { append(&byte, 1); }
+    void append(const std::vector<uint8_t>& bytes) { append(bytes.data(), bytes.size()); }
+    void append(const ByteSlice& slice);
+    void append(const SegmentList& other);
+
+    // Total encoded size
+    size_t size() const { return size_; }
+    size_t segment_count() const { return parts_.size(); }
+    // Segment |i|; pointers stay valid until the list is modified
+    Segment segment(size_t i) const;
+
+    void clear();
+    std::vector<uint8_t> flatten() const;
+
+private:
+    struct Part {
+        bool in_scratch;
+        size_t offset; // into scratch_ when in_scratch
+        size_t size;
+        ByteSlice slice;
+    };
+
+    std::vector<uint8_t> scratch_;
+    std::vector<Part> parts_;
+    size_t size_ = 0;
+};
+
+#ifdef KLV_HAVE_IOVEC
+// Append one iovec per segment of |segments| to |out|; returns the count
+size_t fill_iovec(const SegmentList& segments, std::vector<struct iovec>& out);
+
+// writev() every segment to |fd|, resuming after partial writes and
+// splitting at IOV_MAX. Returns false on a write error (errno is kept).
+bool write_segments(int fd, const SegmentList& segments);
+#endif
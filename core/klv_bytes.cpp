@@ -4,45 +4,70 @@
 #include <stdexcept>
 
 KLVBytes::KLVBytes(const UL& ul, const std::vector<uint8_t>& value, bool use_tag)
-    : ul_(ul), value_(value), use_tag_(use_tag) {}
+    : ul_(ul), value_(ByteSlice::copy(value)), use_tag_(use_tag),
+      revision_(next_revision()) {}
+
+std::shared_ptr<KLVBytes> KLVBytes::view(const UL& ul, const ByteSlice& value, bool use_tag) {
+    auto node = std::make_shared<KLVBytes>(ul, std::vector<uint8_t>(), use_tag);
+    node->value_ = value;
+    return node;
+}
+
+void KLVBytes::set_value(const std::vector<uint8_t>& v) {
+    set_value(ByteSlice::copy(v));
+}
+
+void KLVBytes::set_value(const ByteSlice& v) {
+    value_ = v;
+    revision_ = touch();
+}
 
 std::vector<uint8_t> KLVBytes::encode() const {
     std::vector<uint8_t> out;
+    encode_into(out);
+    return out;
+}
+
+void KLVBytes::encode_into(std::vector<uint8_t>& out) const {
+    uint8_t len_bytes[9];
+    const size_t len_size = misb::write_ber_length(len_bytes, sizeof(len_bytes), value_.size());
     if (use_tag_) {
         out.push_back(ul_[15]);
-        auto len_bytes = misb::encode_ber_length(value_.size());
-        out.insert(out.end(), len_bytes.begin(), len_bytes.end());
     } else {
         out.insert(out.end(), ul_.begin(), ul_.end());
-        auto len_bytes = misb::encode_ber_length(value_.size());
-        out.insert(out.end(), len_bytes.begin(), len_bytes.end());
     }
+    out.insert(out.end(), len_bytes, len_bytes + len_size);
     out.insert(out.end(), value_.begin(), value_.end());
-    return out;
+}
+
+void KLVBytes::encode_segments(SegmentList& out) const {
+    uint8_t len_bytes[9];
+    const size_t len_size = misb::write_ber_length(len_bytes, sizeof(len_bytes), value_.size());
+    if (use_tag_) {
+        out.append(ul_[15]);
+    } else {
+        out.append(ul_.data(), ul_.size());
+    }
+    out.append(len_bytes, len_size);
+    out.append(value_);
 }
 
 void KLVBytes::decode(const std::vector<uint8_t>& bytes) {
+    size_t key_size = 16;
     if (use_tag_) {
         if (bytes.size() < 2) throw std::runtime_error("Too short");
         if (bytes[0] != ul_[15]) throw std::runtime_error("Tag mismatch");
-        size_t len = 0, len_bytes = 0;
-        if (!misb::decode_ber_length(bytes, 1, len, len_bytes))
-            throw std::runtime_error("Length parse error");
-        if (bytes.size() < 1 + len_bytes + len)
-            throw std::runtime_error("Length mismatch");
-        value_.assign(bytes.begin() + 1 + len_bytes,
-                      bytes.begin() + 1 + len_bytes + len);
+        key_size = 1;
     } else {
         if (bytes.size() < 18) throw std::runtime_error("Too short");
         UL ul;
         std::copy(bytes.begin(), bytes.begin() + 16, ul.begin());
         if (ul != ul_) throw std::runtime_error("UL mismatch");
-        size_t len = 0, len_bytes = 0;
-        if (!misb::decode_ber_length(bytes, 16, len, len_bytes))
-            throw std::runtime_error("Length parse error");
-        if (bytes.size() < 16 + len_bytes + len)
-            throw std::runtime_error("Length mismatch");
-        value_.assign(bytes.begin() + 16 + len_bytes,
-                      bytes.begin() + 16 + len_bytes + len);
     }
+    size_t len = 0, len_bytes = 0;
+    if (!misb::decode_ber_length(bytes, key_size, len, len_bytes))
+        throw std::runtime_error("Length parse error");
+    if (bytes.size() < key_size + len_bytes + len)
+        throw std::runtime_error("Length mismatch");
+    set_value(ByteSlice::copy(bytes.data() + key_size + len_bytes, len));
 }
@@ -1,18 +1,31 @@
 #pragma once
 #include "klv_node.h"
 #include "klv_types.h"
+#include <memory>
 #include <vector>
 
 class KLVBytes : public KLVNode {
 public:
     KLVBytes(const UL& ul, const std::vector<uint8_t>& value = {}, bool use_tag = false);
+    // Item referencing |value| without copying it
+    static std::shared_ptr<KLVBytes> view(const UL& ul, const ByteSlice& value, bool use_tag = false);
     std::vector<uint8_t> encode() const override;
+    void encode_into(std::vector<uint8_t>& out) const override;
+    void encode_segments(SegmentList& out) const override;
     void decode(const std::vector<uint8_t>& data) override;
-    const std::vector<uint8_t>& value() const { return value_; }
-    void set_value(const std::vector<uint8_t>& v) { value_ = v; }
+    uint64_t revision() const override { return revision_; }
+    // Owned copy of the value bytes
+    std::vector<uint8_t> value() const { return value_.to_vector(); }
+    // The value bytes without copying, possibly a view into a larger
+    // received buffer
+    const ByteSlice& slice() const { return value_; }
+    void set_value(const std::vector<uint8_t>& v);
+    void set_value(const ByteSlice& v);
     const UL& ul() const { return ul_; }
+    bool uses_tag() const { return use_tag_; }
 private:
     UL ul_;
-    std::vector<uint8_t> value_;
+    ByteSlice value_;
     bool use_tag_;
+    uint64_t revision_;
 };
@@ -0,0 +1,177 @@
+#include "klv_flat_set.h"
+#include "klv_leaf.h"
+#include "klv_bytes.h"
+#include "klv_metrics.h"
+#include "klv_registry.h"
+#include "klv_trace.h"
+#include "st_common.h"
+#include <algorithm>
+#include <stdexcept>
+
+KLVFlatSet::KLVFlatSet(bool use_ul_keys, uint8_t st_id)
+    : use_ul_keys_(use_ul_keys), st_id_(st_id), revision_(next_revision()) {}
+
+void KLVFlatSet::decode(const std::vector<uint8_t>& data) {
+    decode(ByteSlice::copy(data));
+}
+
+void KLVFlatSet::decode(const ByteSlice& data) {
+    if (data.size() > UINT32_MAX) throw std::length_error("KLVFlatSet source exceeds 4 GiB");
+    source_ = data;
+    parse();
+}
+
+void KLVFlatSet::parse() {
+    KLV_METRIC_STAGE(SetDecode);
+    KLV_TRACE_SPAN_ARG("KLVFlatSet::decode", "st_id", st_id_);
+    entries_.clear();
+    keys_.clear();
+    revision_ = touch();
+    const KLVRegistry& registry = KLVRegistry::instance();
+    const uint8_t* data = source_.data();
+    const size_t size = source_.size();
+    size_t i = 0;
+    while (true) {
+        UL ul;
+        uint32_t key;
+        if (use_ul_keys_) {
+            if (i + 18 > size) {
+                if (i < size) KLV_METRIC_ADD(ErrorTruncated, 1);
+                break;
+            }
+            std::copy(data + i, data + i + 16, ul.begin());
+            i += 16;
+            const auto it = std::find(keys_.begin(), keys_.end(), ul);
+            key = static_cast<uint32_t>(it - keys_.begin());
+            if (it == keys_.end()) keys_.push_back(ul);
+        } else {
+            if (i + 1 > size) break;
+            key = data[i++];
+            ul = misb::make_st_ul(st_id_, static_cast<uint8_t>(key));
+        }
+        size_t len = 0;
+        const size_t len_bytes = misb::read_ber_length(data + i, size - i, len);
+        if (len_bytes == 0) {
+            KLV_METRIC_ADD(ErrorBerLength, 1);
+            break;
+        }
+        i += len_bytes;
+        if (len > size - i) {
+            KLV_METRIC_ADD(ErrorTruncated, 1);
+            break;
+        }
+
+        KLVFlatEntry entry;
+        entry.key = key;
+        entry.offset = static_cast<uint32_t>(i);
+        entry.length = static_cast<uint32_t>(len);
+        const KLVCodecRef codec = registry.lookup(ul);
+        if (codec) {
+            entry.value = codec.decode(data + i, len);
+            entry.kind = KLVFlatKind::Numeric;
+        } else {
+            KLV_METRIC_ADD(UnknownTags, 1);
+            entry.value = std::numeric_limits<double>::quiet_NaN();
+            entry.kind = KLVFlatKind::Bytes;
+        }
+        entries_.push_back(entry);
+        i += len;
+    }
+}
+
+UL KLVFlatSet::ul(const KLVFlatEntry& e) const {
+    if (use_ul_keys_) return keys_[e.key];
+    return misb::make_st_ul(st_id_, static_cast<uint8_t>(e.key));
+}
+
+const KLVFlatEntry* KLVFlatSet::find(const UL& ul) const {
+    uint32_t key;
+    if (use_ul_keys_) {
+        const auto it = std::find(keys_.begin(), keys_.end(), ul);
+        if (it == keys_.end()) return nullptr;
+        key = static_cast<uint32_t>(it - keys_.begin());
+    } else {
+        if (ul != misb::make_st_ul(st_id_, ul[15])) return nullptr;
+        key = ul[15];
+    }
+    for (const auto& e : entries_) {
+        if (e.key == key) return &e;
+    }
+    return nullptr;
+}
+
+bool KLVFlatSet::get(const UL& ul, double& out) const {
+    const KLVFlatEntry* e = find(ul);
+    if (!e || e->kind != KLVFlatKind::Numeric) return false;
+    out = e->value;
+    return true;
+}
+
+bool KLVFlatSet::get(const UL& ul, ByteSlice& out) const {
+    const KLVFlatEntry* e = find(ul);
+    if (!e) return false;
+    out = slice(*e);
+    return true;
+}
+
+bool KLVFlatSet::get(const UL& ul, std::string& out) const {
+    const KLVFlatEntry* e = find(ul);
+    if (!e) return false;
+    out.assign(reinterpret_cast<const char*>(data(*e)), e->length);
+    return true;
+}
+
+double KLVFlatSet::value(const UL& ul, double fallback) const {
+    double v = fallback;
+    get(ul, v);
+    return v;
+}
+
+std::shared_ptr<KLVNode> KLVFlatSet::node(size_t i) const {
+    const KLVFlatEntry& e = entries_.at(i);
+    if (e.kind == KLVFlatKind::Numeric) return std::make_shared<KLVLeaf>(ul(e), e.value, !use_ul_keys_);
+    return KLVBytes::view(ul(e), slice(e), !use_ul_keys_);
+}
+
+KLVSet KLVFlatSet::to_set() const {
+    KLVSet set(use_ul_keys_, st_id_);
+    for (size_t i = 0; i < entries_.size(); ++i) {
+        set.add(node(i));
+    }
+    return set;
+}
+
+std::vector<uint8_t> KLVFlatSet::encode() const {
+    std::vector<uint8_t> out;
+    encode_into(out);
+    return out;
+}
+
+void KLVFlatSet::encode_into(std::vector<uint8_t>& out) const {
+    KLV_TRACE_SPAN_ARG("KLVFlatSet::encode", "st_id", st_id_);
+    uint8_t len_bytes[9];
+    for (const auto& e : entries_) {
+        if (use_ul_keys_) {
+            out.insert(out.end(), keys_[e.key].begin(), keys_[e.key].end());
+        } else {
+            out.push_back(static_cast<uint8_t>(e.key));
+        }
+        const size_t len_size = misb::write_ber_length(len_bytes, sizeof(len_bytes), e.length);
+        out.insert(out.end(), len_bytes, len_bytes + len_size);
+        out.insert(out.end(), data(e), data(e) + e.length);
+    }
+}
+
+void KLVFlatSet::encode_segments(SegmentList& out) const {
+    uint8_t len_bytes[9];
+    for (const auto& e : entries_) {
+        if (use_ul_keys_) {
+            out.append(keys_[e.key].data(), keys_[e.key].size());
+        } else {
+            out.append(static_cast<uint8_t>(e.key));
+        }
+        const size_t len_size = misb::write_ber_length(len_bytes, sizeof(len_bytes), e.length);
+        out.append(len_bytes, len_size);
+        out.append(slice(e));
+    }
+}
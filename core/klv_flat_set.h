@@ -0,0 +1,93 @@
+#pragma once
+#include "klv_buffer.h"
+#include "klv_node.h"
+#include "klv_set.h"
+#include "klv_types.h"
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+enum class KLVFlatKind : uint8_t {
+    Numeric,  // decoded by a registry codec, |value| holds the result
+    Bytes     // no codec; the value is only the source bytes
+};
+
+// One decoded item. The value bytes stay in the source buffer of the set.
+struct KLVFlatEntry {
+    double value;     // cached numeric value, NaN for Bytes
+    uint32_t key;     // tag byte, or index into the UL table of the set
+    uint32_t offset;  // value bytes in the source buffer
+    uint32_t length;
+    KLVFlatKind kind;
+};
+
+static_assert(sizeof(KLVFlatEntry) == 24, "KLVFlatEntry is meant to stay compact");
+
+// Compact decoded form of a local or universal set: one contiguous vector
+// of fixed-size entries over a shared source buffer, instead of a tree of
+// heap-allocated KLVLeaf/KLVBytes nodes. Numeric values are decoded once
+// through KLVRegistry::lookup; byte values are never copied. UL keys are
+// stored once each in a side table. Sources are limited to 4 GiB.
+//
+// As a KLVNode the set re-encodes its source items as read, so it can be
+// nested in a KLVSet; node() and to_set() rebuild KLVLeaf/KLVBytes nodes
+// for code written against the tree API.
+class KLVFlatSet : public KLVNode {
+public:
+    typedef std::vector<KLVFlatEntry>::const_iterator const_iterator;
+
+    KLVFlatSet(bool use_ul_keys = true, uint8_t st_id = 0);
+
+    // Items reference |data|, which is kept alive by the set. Parsing stops
+    // at the first malformed or truncated item, as KLVSet does.
+    void decode(const ByteSlice& data);
+    // Copies |data| once
+    void decode(const std::vector<uint8_t>& data) override;
+
+    std::vector<uint8_t> encode() const override;
+    void encode_into(std::vector<uint8_t>& out) const override;
+    void encode_segments(SegmentList& out) const override;
+    uint64_t revision() const override { return revision_; }
+
+    size_t size() const { return entries_.size(); }
+    bool empty() const { return entries_.empty(); }
+    const KLVFlatEntry& operator[](size_t i) const { return entries_[i]; }
+    const_iterator begin() const { return entries_.begin(); }
+    const_iterator end() const { return entries_.end(); }
+    const std::vector<KLVFlatEntry>& entries() const { return entries_; }
+    const ByteSlice& source() const { return source_; }
+    bool uses_ul_keys() const { return use_ul_keys_; }
+    uint8_t st_id() const { return st_id_; }
+
+    UL ul(const KLVFlatEntry& e) const;
+    const uint8_t* data(const KLVFlatEntry& e) const { return source_.data() + e.offset; }
+    ByteSlice slice(const KLVFlatEntry& e) const { return source_.slice(e.offset, e.length); }
+
+    // First item with key |ul|, nullptr when absent
+    const KLVFlatEntry* find(const UL& ul) const;
+
+    // Typed access to the first item with key |ul|; false when it is absent
+    // or, for the numeric form, not decoded by a codec
+    bool get(const UL& ul, double& out) const;
+    bool get(const UL& ul, ByteSlice& out) const;
+    bool get(const UL& ul, std::string& out) const;
+    double value(const UL& ul, double fallback = std::numeric_limits<double>::quiet_NaN()) const;
+
+    // Tree form of item |i|: a KLVLeaf, or a KLVBytes viewing the source
+    std::shared_ptr<KLVNode> node(size_t i) const;
+    // Same children as KLVSet::decode(const ByteSlice&) on the source
+    KLVSet to_set() const;
+
+private:
+    void parse();
+
+    ByteSlice source_;
+    std::vector<KLVFlatEntry> entries_;
+    std::vector<UL> keys_;  // UL-keyed sets only
+    bool use_ul_keys_;
+    uint8_t st_id_;
+    uint64_t revision_;
+};
@@ -0,0 +1,158 @@
+#include "klv_index.h"
+#include "stanag.h"
+#include "st_common.h"
+#include "st0601.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+namespace stanag {
+
+namespace {
+
+void put_le(std::vector<uint8_t>& out, uint64_t v, size_t width) {
+    for (size_t i = 0; i < width; ++i) {
+        out.push_back(static_cast<uint8_t>((v >> (8 * i)) & 0xFFu));
+    }
+}
+
+uint64_t get_le(const uint8_t* p, size_t width) {
+    uint64_t v = 0;
+    for (size_t i = width; i-- > 0;) {
+        v = (v << 8) | p[i];
+    }
+    return v;
+}
+
+} // namespace
+
+size_t IndexBuilder::scan(const uint8_t* data, size_t size, uint32_t feed_id, uint64_t base_offset) {
+    const uint8_t ts_tag = misb::st0601::UNIX_TIMESTAMP[15];
+    uint64_t last_ts = 0;
+    size_t added = 0;
+    size_t from = 0;
+    PacketView view;
+    while (find_next_packet(data, size, from, view)) {
+        size_t value_offset = 0, value_len = 0;
+        const uint8_t* payload = data + view.payload_offset;
+        if (misb::find_local_tag(payload, view.payload_length, ts_tag, value_offset, value_len) &&
+            value_len == 8) {
+            misb::read_uint_be(payload + value_offset, value_len, 8, last_ts);
+        }
+        IndexEntry e;
+        e.timestamp = last_ts;
+        e.offset = base_offset + view.offset;
+        e.length = static_cast<uint32_t>(view.length);
+        e.feed_id = feed_id;
+        entries_.push_back(e);
+        ++added;
+        from = view.offset + view.length;
+    }
+    return added;
+}
+
+size_t IndexBuilder::scan_file(const std::string& archive_path, uint32_t feed_id) {
+    MappedFile archive;
+    if (!archive.open(archive_path)) {
+        throw std::runtime_error("Unable to open archive " + archive_path);
+    }
+    return scan(archive.data(), archive.size(), feed_id);
+}
+
+bool IndexBuilder::write(const std::string& index_path) {
+    std::stable_sort(entries_.begin(), entries_.end(),
+                     [](const IndexEntry& a, const IndexEntry& b) {
+                         return a.timestamp != b.timestamp ? a.timestamp < b.timestamp
+                                                           : a.offset < b.offset;
+                     });
+    std::vector<uint8_t> out;
+    out.reserve(INDEX_HEADER_SIZE + entries_.size() * INDEX_ENTRY_SIZE);
+    out.insert(out.end(), INDEX_MAGIC, INDEX_MAGIC + sizeof(INDEX_MAGIC));
+    put_le(out, INDEX_VERSION, 4);
+    put_le(out, INDEX_ENTRY_SIZE, 4);
+    put_le(out, entries_.size(), 8);
+    for (const auto& e : entries_) {
+        put_le(out, e.timestamp, 8);
+        put_le(out, e.offset, 8);
+        put_le(out, e.length, 4);
+        put_le(out, e.feed_id, 4);
+    }
+    std::ofstream file(index_path, std::ios::binary | std::ios::trunc);
+    if (!file) return false;
+    file.write(reinterpret_cast<const char*>(out.data()), static_cast<std::streamsize>(out.size()));
+    return static_cast<bool>(file);
+}
+
+IndexReader::IndexReader(const std::string& index_path)
+    : file_(index_path), count_(0) {
+    if (file_.size() < INDEX_HEADER_SIZE ||
+        std::memcmp(file_.data(), INDEX_MAGIC, sizeof(INDEX_MAGIC)) != 0) {
+        throw std::runtime_error("Not a KLV index: " + index_path);
+    }
+    if (get_le(file_.data() + 8, 4) != INDEX_VERSION ||
+        get_le(file_.data() + 12, 4) != INDEX_ENTRY_SIZE) {
+        throw std::runtime_error("Unsupported KLV index version");
+    }
+    count_ = static_cast<size_t>(get_le(file_.data() + 16, 8));
+    if (count_ > (file_.size() - INDEX_HEADER_SIZE) / INDEX_ENTRY_SIZE) {
+        throw std::runtime_error("Truncated KLV index");
+    }
+}
+
+uint64_t IndexReader::timestamp(size_t i) const {
+    return get_le(record(i), 8);
+}
+
+IndexEntry IndexReader::entry(size_t i) const {
+    const uint8_t* p = record(i);
+    IndexEntry e;
+    e.timestamp = get_le(p, 8);
+    e.offset = get_le(p + 8, 8);
+    e.length = static_cast<uint32_t>(get_le(p + 16, 4));
+    e.feed_id = static_cast<uint32_t>(get_le(p + 20, 4));
+    return e;
+}
+
+size_t IndexReader::lower_bound(uint64_t t) const {
+    size_t lo = 0;
+    size_t hi = count_;
+    while (lo < hi) {
+        const size_t mid = lo + (hi - lo) / 2;
+        if (timestamp(mid) < t) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+std::pair<size_t, size_t> IndexReader::find(uint64_t t0, uint64_t t1) const {
+    if (t1 < t0) return {0, 0};
+    const size_t first = lower_bound(t0);
+    const size_t last = t1 == UINT64_MAX ? count_ : lower_bound(t1 + 1);
+    return {first, last};
+}
+
+ByteRange IndexReader::range(uint64_t t0, uint64_t t1, int64_t feed_id) const {
+    ByteRange r{0, 0, 0};
+    const auto span = find(t0, t1);
+    for (size_t i = span.first; i < span.second; ++i) {
+        const IndexEntry e = entry(i);
+        if (feed_id >= 0 && e.feed_id != static_cast<uint64_t>(feed_id)) continue;
+        const uint64_t end = e.offset + e.length;
+        if (r.packets == 0) {
+            r.begin = e.offset;
+            r.end = end;
+        } else {
+            r.begin = std::min(r.begin, e.offset);
+            r.end = std::max(r.end, end);
+        }
+        ++r.packets;
+    }
+    return r;
+}
+
+} // namespace stanag
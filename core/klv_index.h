@@ -0,0 +1,81 @@
+#pragma once
+
+#include "klv_mapped_file.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace stanag {
+
+// One packet of a raw KLV archive as recorded in a sidecar index
+struct IndexEntry {
+    uint64_t timestamp; // UNIX_TIMESTAMP (tag 2), carried forward when absent
+    uint64_t offset;    // byte offset of the packet UL in the archive
+    uint32_t length;    // full packet length including UL and BER length
+    uint32_t feed_id;
+};
+
+// Byte window [begin, end) of an archive covering a time query
+struct ByteRange {
+    uint64_t begin;
+    uint64_t end;
+    size_t packets;
+};
+
+// Sidecar layout (little-endian):
+//   "KLVIDX01" | u32 version | u32 entry size | u64 count
+//   count x { u64 timestamp | u64 offset | u32 length | u32 feed id }
+// Entries are sorted by timestamp, then offset.
+constexpr char INDEX_MAGIC[8] = {'K','L','V','I','D','X','0','1'};
+constexpr uint32_t INDEX_VERSION = 1;
+constexpr size_t INDEX_HEADER_SIZE = 24;
+constexpr size_t INDEX_ENTRY_SIZE = 24;
+
+// Scans raw archives once (UL sync, BER length, tag 2) and writes the index
+class IndexBuilder {
+public:
+    // Index every packet found in |data|; offsets are shifted by |base_offset|.
+    // Returns the number of packets added.
+    size_t scan(const uint8_t* data, size_t size, uint32_t feed_id, uint64_t base_offset = 0);
+    size_t scan_file(const std::string& archive_path, uint32_t feed_id);
+
+    // Sort and write the sidecar file. Returns false on I/O error.
+    bool write(const std::string& index_path);
+
+    const std::vector<IndexEntry>& entries() const { return entries_; }
+    void clear() { entries_.clear(); }
+
+private:
+    std::vector<IndexEntry> entries_;
+};
+
+// Memory-maps a sidecar index and answers time-window queries by binary search
+class IndexReader {
+public:
+    explicit IndexReader(const std::string& index_path);
+
+    size_t size() const { return count_; }
+    IndexEntry entry(size_t i) const;
+    uint64_t timestamp(size_t i) const;
+
+    // Entry indices [first, last) whose timestamps fall in [t0, t1]
+    std::pair<size_t, size_t> find(uint64_t t0, uint64_t t1) const;
+
+    // Smallest byte range holding every packet of |feed_id| in [t0, t1].
+    // A negative feed id matches every feed. Empty range when nothing matches.
+    ByteRange range(uint64_t t0, uint64_t t1, int64_t feed_id = -1) const;
+
+private:
+    const uint8_t* record(size_t i) const {
+        return file_.data() + INDEX_HEADER_SIZE + i * INDEX_ENTRY_SIZE;
+    }
+    size_t lower_bound(uint64_t t) const;
+
+    MappedFile file_;
+    size_t count_;
+};
+
+} // namespace stanag
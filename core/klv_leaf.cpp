@@ -5,24 +5,27 @@
 #include <stdexcept>
 
 KLVLeaf::KLVLeaf(const UL& ul, double value, bool use_tag)
-    : ul_(ul), value_(value), use_tag_(use_tag) {}
+    : ul_(ul), value_(value), use_tag_(use_tag), revision_(next_revision()) {}
 
 std::vector<uint8_t> KLVLeaf::encode() const {
-    auto* entry = KLVRegistry::instance().find(ul_);
-    if (!entry) throw std::runtime_error("Unknown UL");
-    auto data = entry->encoder(value_);
     std::vector<uint8_t> out;
+    encode_into(out);
+    return out;
+}
+
+void KLVLeaf::encode_into(std::vector<uint8_t>& out) const {
+    const KLVCodecRef codec = KLVRegistry::instance().lookup(ul_);
+    if (!codec) throw std::runtime_error("Unknown UL");
+    auto data = codec.encode(value_);
+    uint8_t len_bytes[9];
+    const size_t len_size = misb::write_ber_length(len_bytes, sizeof(len_bytes), data.size());
     if (use_tag_) {
         out.push_back(ul_[15]);
-        auto len_bytes = misb::encode_ber_length(data.size());
-        out.insert(out.end(), len_bytes.begin(), len_bytes.end());
     } else {
         out.insert(out.end(), ul_.begin(), ul_.end());
-        auto len_bytes = misb::encode_ber_length(data.size());
-        out.insert(out.end(), len_bytes.begin(), len_bytes.end());
     }
+    out.insert(out.end(), len_bytes, len_bytes + len_size);
     out.insert(out.end(), data.begin(), data.end());
-    return out;
 }
 
 void KLVLeaf::decode(const std::vector<uint8_t>& bytes) {
@@ -34,11 +37,9 @@ void KLVLeaf::decode(const std::vector<uint8_t>& bytes) {
             throw std::runtime_error("Length parse error");
         if (bytes.size() < 1 + len_bytes + len)
             throw std::runtime_error("Length mismatch");
-        std::vector<uint8_t> data(bytes.begin() + 1 + len_bytes,
-                                  bytes.begin() + 1 + len_bytes + len);
-        auto* entry = KLVRegistry::instance().find(ul_);
-        if (!entry) throw std::runtime_error("Unknown UL");
-        value_ = entry->decoder(data);
+        const KLVCodecRef codec = KLVRegistry::instance().lookup(ul_);
+        if (!codec) throw std::runtime_error("Unknown UL");
+        value_ = codec.decode(bytes.data() + 1 + len_bytes, len);
     } else {
         if (bytes.size() < 18) throw std::runtime_error("Too short");
         UL ul;
@@ -49,10 +50,9 @@ void KLVLeaf::decode(const std::vector<uint8_t>& bytes) {
             throw std::runtime_error("Length parse error");
         if (bytes.size() < 16 + len_bytes + len)
             throw std::runtime_error("Length mismatch");
-        std::vector<uint8_t> data(bytes.begin() + 16 + len_bytes,
-                                  bytes.begin() + 16 + len_bytes + len);
-        auto* entry = KLVRegistry::instance().find(ul_);
-        if (!entry) throw std::runtime_error("Unknown UL");
-        value_ = entry->decoder(data);
+        const KLVCodecRef codec = KLVRegistry::instance().lookup(ul_);
+        if (!codec) throw std::runtime_error("Unknown UL");
+        value_ = codec.decode(bytes.data() + 16 + len_bytes, len);
     }
+    revision_ = touch();
 }
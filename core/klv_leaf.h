@@ -7,12 +7,19 @@ class KLVLeaf : public KLVNode {
 public:
     KLVLeaf(const UL& ul, double value = 0.0, bool use_tag = false);
     std::vector<uint8_t> encode() const override;
+    void encode_into(std::vector<uint8_t>& out) const override;
     void decode(const std::vector<uint8_t>& data) override;
+    uint64_t revision() const override { return revision_; }
     double value() const { return value_; }
-    void set_value(double v) { value_ = v; }
+    void set_value(double v) {
+        value_ = v;
+        revision_ = touch();
+    }
     const UL& ul() const { return ul_; }
+    bool uses_tag() const { return use_tag_; }
 private:
     UL ul_;
     double value_;
     bool use_tag_;
+    uint64_t revision_;
 };
@@ -147,7 +147,7 @@ inline double target_centroid_pixel(double row,
     for (const auto& node : dataset.children()) {                          \
         auto bytes = std::dynamic_pointer_cast<KLVBytes>(node);            \
         if (bytes && bytes->ul() == tag) {                                 \
-            out.decode(bytes->value());                                    \
+            out.decode(bytes->slice());                                    \
         }                                                                  \
     }
 
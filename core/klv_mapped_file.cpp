@@ -0,0 +1,66 @@
+#include "klv_mapped_file.h"
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define KLV_HAVE_MMAP 1
+#endif
+
+MappedFile::MappedFile(const std::string& path) {
+    if (!open(path)) throw std::runtime_error("Unable to open " + path);
+}
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+bool MappedFile::open(const std::string& path) {
+    close();
+#ifdef KLV_HAVE_MMAP
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+        ::close(fd);
+        return false;
+    }
+    size_ = static_cast<size_t>(st.st_size);
+    if (size_ > 0) {
+        void* addr = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (addr == MAP_FAILED) {
+            ::close(fd);
+            size_ = 0;
+            return false;
+        }
+        data_ = static_cast<const uint8_t*>(addr);
+        mapped_ = true;
+    }
+    ::close(fd);
+#else
+    std::ifstream in(path, std::ios::binary);
+    if (!in) return false;
+    fallback_.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    data_ = fallback_.data();
+    size_ = fallback_.size();
+#endif
+    open_ = true;
+    return true;
+}
+
+void MappedFile::close() {
+#ifdef KLV_HAVE_MMAP
+    if (mapped_) {
+        ::munmap(const_cast<uint8_t*>(data_), size_);
+    }
+#endif
+    fallback_.clear();
+    data_ = nullptr;
+    size_ = 0;
+    open_ = false;
+    mapped_ = false;
+}
@@ -0,0 +1,269 @@
+#include "klv_metrics.h"
+#include "klv_varint.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <limits>
+#include <mutex>
+#include <vector>
+
+namespace {
+
+// Written by its owning thread only: relaxed load + store is enough and
+// avoids locked read-modify-write instructions on the hot path
+inline void bump(std::atomic<uint64_t>& v, uint64_t n) {
+    v.store(v.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+}
+
+struct StageBlock {
+    std::array<std::atomic<uint64_t>, LatencyHistogram::BUCKETS> buckets;
+    std::atomic<uint64_t> sum;
+    std::atomic<uint64_t> min;
+    std::atomic<uint64_t> max;
+};
+
+// Bumped by reset(). Each thread clears its own block on its first update
+// after a reset, so reset() never races with the owner's load + store.
+std::atomic<uint64_t> current_epoch(0);
+
+struct ThreadBlock {
+    ThreadBlock() : epoch(0) { clear(); }
+    void clear() {
+        for (auto& c : counters) c.store(0, std::memory_order_relaxed);
+        for (auto& s : stages) {
+            for (auto& b : s.buckets) b.store(0, std::memory_order_relaxed);
+            s.sum.store(0, std::memory_order_relaxed);
+            s.min.store(std::numeric_limits<uint64_t>::max(), std::memory_order_relaxed);
+            s.max.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    std::array<std::atomic<uint64_t>, KLV_COUNTER_COUNT> counters;
+    std::array<StageBlock, KLV_STAGE_COUNT> stages;
+    std::atomic<uint64_t> epoch;    // reset() the values belong to
+};
+
+// Live thread blocks and the totals of exited threads
+struct Registry {
+    std::mutex mutex;
+    std::vector<ThreadBlock*> blocks;
+    KLVMetricsSnapshot retired;
+};
+
+Registry& registry() {
+    // Leaked so that threads exiting during static destruction can retire
+    static Registry* r = new Registry();
+    return *r;
+}
+
+void accumulate(const ThreadBlock& block, KLVMetricsSnapshot& out);
+bool current(const ThreadBlock& block);
+
+// Owns the calling thread's block; folds it into the retired totals on exit
+struct ThreadHolder {
+    ThreadHolder() : block(new ThreadBlock()) {
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        r.blocks.push_back(block);
+    }
+    ~ThreadHolder() {
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        if (current(*block)) accumulate(*block, r.retired);
+        r.blocks.erase(std::find(r.blocks.begin(), r.blocks.end(), block));
+        delete block;
+    }
+    ThreadBlock* block;
+};
+
+ThreadBlock& local_block() {
+    thread_local ThreadHolder holder;
+    ThreadBlock& block = *holder.block;
+    const uint64_t epoch = current_epoch.load(std::memory_order_acquire);
+    if (block.epoch.load(std::memory_order_relaxed) != epoch) {
+        // Values from before the reset; published only with the new epoch
+        block.clear();
+        block.epoch.store(epoch, std::memory_order_release);
+    }
+    return block;
+}
+
+// False for blocks not updated since the last reset()
+bool current(const ThreadBlock& block) {
+    return block.epoch.load(std::memory_order_acquire) == current_epoch.load(std::memory_order_relaxed);
+}
+
+void accumulate(const ThreadBlock& block, KLVMetricsSnapshot& out) {
+    for (size_t i = 0; i < KLV_COUNTER_COUNT; ++i) {
+        out.counters[i] += block.counters[i].load(std::memory_order_relaxed);
+    }
+    for (size_t s = 0; s < KLV_STAGE_COUNT; ++s) {
+        const StageBlock& in = block.stages[s];
+        LatencyHistogram one;
+        for (size_t b = 0; b < LatencyHistogram::BUCKETS; ++b) {
+            const uint64_t n = in.buckets[b].load(std::memory_order_relaxed);
+            if (n) one.add_bucket(b, n);
+        }
+        if (one.count() == 0) continue;
+        // Buckets only bound the values: sum, min and max are kept exactly
+        one.add_totals(in.sum.load(std::memory_order_relaxed),
+                       in.min.load(std::memory_order_relaxed),
+                       in.max.load(std::memory_order_relaxed));
+        out.stages[s].merge(one);
+    }
+}
+
+} // namespace
+
+const char* to_string(KLVStage stage) {
+    switch (stage) {
+    case KLVStage::Framing: return "framing";
+    case KLVStage::SetDecode: return "set_decode";
+    case KLVStage::SeriesDecode: return "series_decode";
+    case KLVStage::PacketEncode: return "packet_encode";
+    default: return "unknown";
+    }
+}
+
+const char* to_string(KLVCounter counter) {
+    switch (counter) {
+    case KLVCounter::PacketsFramed: return "packets_framed";
+    case KLVCounter::BytesFramed: return "bytes_framed";
+    case KLVCounter::PacketsEncoded: return "packets_encoded";
+    case KLVCounter::BytesEncoded: return "bytes_encoded";
+    case KLVCounter::UnknownTags: return "unknown_tags";
+    case KLVCounter::ErrorBerLength: return "errors_ber_length";
+    case KLVCounter::ErrorTruncated: return "errors_truncated";
+    case KLVCounter::ErrorChecksum: return "errors_checksum";
+    case KLVCounter::ErrorSeries: return "errors_series";
+    default: return "unknown";
+    }
+}
+
+size_t LatencyHistogram::bucket_index(uint64_t value) {
+    if (value < SUB_BUCKETS) return static_cast<size_t>(value);
+    const unsigned msb = 63u - misb::detail::clz64(value);
+    const unsigned shift = msb - static_cast<unsigned>(SUB_BUCKET_BITS);
+    return (shift + 1) * SUB_BUCKETS + static_cast<size_t>((value >> shift) & (SUB_BUCKETS - 1));
+}
+
+uint64_t LatencyHistogram::bucket_low(size_t bucket) {
+    if (bucket < SUB_BUCKETS) return bucket;
+    const size_t shift = bucket / SUB_BUCKETS - 1;
+    return static_cast<uint64_t>(SUB_BUCKETS + bucket % SUB_BUCKETS) << shift;
+}
+
+uint64_t LatencyHistogram::bucket_high(size_t bucket) {
+    if (bucket < SUB_BUCKETS) return bucket;
+    const size_t shift = bucket / SUB_BUCKETS - 1;
+    return bucket_low(bucket) + ((uint64_t{1} << shift) - 1);
+}
+
+void LatencyHistogram::record(uint64_t value, uint64_t n) {
+    buckets_[bucket_index(value)] += n;
+    count_ += n;
+    sum_ += value * n;
+    min_ = std::min(min_, value);
+    max_ = std::max(max_, value);
+}
+
+void LatencyHistogram::add_totals(uint64_t sum, uint64_t min, uint64_t max) {
+    sum_ += sum;
+    min_ = std::min(min_, min);
+    max_ = std::max(max_, max);
+}
+
+void LatencyHistogram::merge(const LatencyHistogram& other) {
+    for (size_t i = 0; i < BUCKETS; ++i) buckets_[i] += other.buckets_[i];
+    count_ += other.count_;
+    sum_ += other.sum_;
+    min_ = std::min(min_, other.min_);
+    max_ = std::max(max_, other.max_);
+}
+
+void LatencyHistogram::reset() {
+    buckets_.fill(0);
+    count_ = 0;
+    sum_ = 0;
+    min_ = std::numeric_limits<uint64_t>::max();
+    max_ = 0;
+}
+
+uint64_t LatencyHistogram::percentile(double q) const {
+    if (count_ == 0) return 0;
+    q = std::min(1.0, std::max(0.0, q));
+    const uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(q * count_ + 0.5));
+    uint64_t seen = 0;
+    for (size_t i = 0; i < BUCKETS; ++i) {
+        seen += buckets_[i];
+        if (seen >= rank) return std::min(bucket_high(i), max_);
+    }
+    return max_;
+}
+
+std::string KLVMetricsSnapshot::to_text() const {
+    std::string out;
+    char line[160];
+    for (size_t i = 0; i < KLV_COUNTER_COUNT; ++i) {
+        std::snprintf(line, sizeof(line), "klv_%s_total %llu\n",
+                      to_string(static_cast<KLVCounter>(i)),
+                      static_cast<unsigned long long>(counters[i]));
+        out += line;
+    }
+    static const double quantiles[] = {0.5, 0.9, 0.99};
+    for (size_t s = 0; s < KLV_STAGE_COUNT; ++s) {
+        const LatencyHistogram& h = stages[s];
+        const char* name = to_string(static_cast<KLVStage>(s));
+        std::snprintf(line, sizeof(line), "klv_stage_latency_ns_count{stage=\"%s\"} %llu\n",
+                      name, static_cast<unsigned long long>(h.count()));
+        out += line;
+        std::snprintf(line, sizeof(line), "klv_stage_latency_ns_sum{stage=\"%s\"} %llu\n",
+                      name, static_cast<unsigned long long>(h.sum()));
+        out += line;
+        for (double q : quantiles) {
+            std::snprintf(line, sizeof(line),
+                          "klv_stage_latency_ns{stage=\"%s\",quantile=\"%g\"} %llu\n",
+                          name, q, static_cast<unsigned long long>(h.percentile(q)));
+            out += line;
+        }
+        std::snprintf(line, sizeof(line), "klv_stage_latency_ns_max{stage=\"%s\"} %llu\n",
+                      name, static_cast<unsigned long long>(h.max()));
+        out += line;
+    }
+    return out;
+}
+
+void KLVMetrics::add(KLVCounter counter, uint64_t n) {
+    bump(local_block().counters[static_cast<size_t>(counter)], n);
+}
+
+void KLVMetrics::record(KLVStage stage, uint64_t nanoseconds) {
+    StageBlock& s = local_block().stages[static_cast<size_t>(stage)];
+    bump(s.buckets[LatencyHistogram::bucket_index(nanoseconds)], 1);
+    bump(s.sum, nanoseconds);
+    if (nanoseconds < s.min.load(std::memory_order_relaxed)) {
+        s.min.store(nanoseconds, std::memory_order_relaxed);
+    }
+    if (nanoseconds > s.max.load(std::memory_order_relaxed)) {
+        s.max.store(nanoseconds, std::memory_order_relaxed);
+    }
+}
+
+KLVMetricsSnapshot KLVMetrics::snapshot() {
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    KLVMetricsSnapshot out = r.retired;
+    for (const ThreadBlock* block : r.blocks) {
+        if (current(*block)) accumulate(*block, out);
+    }
+    return out;
+}
+
+void KLVMetrics::reset() {
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    current_epoch.fetch_add(1, std::memory_order_release);
+    r.retired.counters.fill(0);
+    for (auto& h : r.retired.stages) h.reset();
+}
@@ -0,0 +1,141 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Codec instrumentation: per-stage latency histograms and counters.
+//
+// Every thread records into its own block of relaxed atomics, so the hot
+// path never contends; a snapshot sums the blocks of live threads and the
+// totals left by exited ones. Building with KLV_METRICS=0 (CMake option
+// KLV_METRICS=OFF) turns the recording macros into no-ops; the snapshot API
+// stays available and reports zeros.
+
+#ifndef KLV_METRICS
+#define KLV_METRICS 1
+#endif
+
+enum class KLVStage : uint8_t {
+    Framing,        // find_next_packet: UL sync and BER length
+    SetDecode,      // KLVSet::decode, nested sets included
+    SeriesDecode,   // ST 0903 vTarget / algorithm / ontology series
+    PacketEncode,   // create_stanag4609_packet
+    Count
+};
+
+enum class KLVCounter : uint8_t {
+    PacketsFramed,
+    BytesFramed,
+    PacketsEncoded,
+    BytesEncoded,
+    UnknownTags,        // items without a registered codec
+    ErrorBerLength,     // malformed BER length
+    ErrorTruncated,     // item or packet running past its buffer
+    ErrorChecksum,      // packet checksum mismatch
+    ErrorSeries,        // rejected series
+    Count
+};
+
+constexpr size_t KLV_STAGE_COUNT = static_cast<size_t>(KLVStage::Count);
+constexpr size_t KLV_COUNTER_COUNT = static_cast<size_t>(KLVCounter::Count);
+
+const char* to_string(KLVStage stage);
+const char* to_string(KLVCounter counter);
+
+// HDR-style histogram of nanosecond latencies: 8 linear sub-buckets per
+// power of two, so any recorded value is known within 12.5%.
+class LatencyHistogram {
+public:
+    static constexpr size_t SUB_BUCKET_BITS = 3;
+    static constexpr size_t SUB_BUCKETS = size_t{1} << SUB_BUCKET_BITS;
+    static constexpr size_t BUCKETS = (64 - SUB_BUCKET_BITS + 1) * SUB_BUCKETS;
+
+    LatencyHistogram() { reset(); }
+
+    static size_t bucket_index(uint64_t value);
+    // Smallest and largest value falling in |bucket|
+    static uint64_t bucket_low(size_t bucket);
+    static uint64_t bucket_high(size_t bucket);
+
+    void record(uint64_t value, uint64_t n = 1);
+    // Merge externally bucketed samples: counts per bucket, then the exact
+    // sum, min and max of the same samples
+    void add_bucket(size_t bucket, uint64_t n) { buckets_[bucket] += n; count_ += n; }
+    void add_totals(uint64_t sum, uint64_t min, uint64_t max);
+    void merge(const LatencyHistogram& other);
+    void reset();
+
+    uint64_t count() const { return count_; }
+    uint64_t sum() const { return sum_; }
+    uint64_t min() const { return count_ ? min_ : 0; }
+    uint64_t max() const { return max_; }
+    double mean() const { return count_ ? static_cast<double>(sum_) / count_ : 0.0; }
+    // Upper bound of the bucket holding quantile |q| in [0, 1]
+    uint64_t percentile(double q) const;
+    uint64_t bucket(size_t i) const { return buckets_[i]; }
+
+private:
+    std::array<uint64_t, BUCKETS> buckets_;
+    uint64_t count_;
+    uint64_t sum_;
+    uint64_t min_;
+    uint64_t max_;
+};
+
+struct KLVMetricsSnapshot {
+    KLVMetricsSnapshot() { counters.fill(0); }
+
+    std::array<uint64_t, KLV_COUNTER_COUNT> counters;
+    std::array<LatencyHistogram, KLV_STAGE_COUNT> stages;
+
+    uint64_t counter(KLVCounter c) const { return counters[static_cast<size_t>(c)]; }
+    const LatencyHistogram& stage(KLVStage s) const { return stages[static_cast<size_t>(s)]; }
+
+    // Prometheus-style text: one counter per line, then count, sum and
+    // p50/p90/p99/max per stage
+    std::string to_text() const;
+};
+
+class KLVMetrics {
+public:
+    static void add(KLVCounter counter, uint64_t n = 1);
+    static void record(KLVStage stage, uint64_t nanoseconds);
+
+    static KLVMetricsSnapshot snapshot();
+    // Zero every thread's block and the retired totals. Safe while other
+    // threads record: each one clears its own block on its next update.
+    static void reset();
+
+    static uint64_t now_ns() {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+};
+
+// Records the lifetime of the scope into |stage|
+class KLVStageTimer {
+public:
+    explicit KLVStageTimer(KLVStage stage) : stage_(stage), start_(KLVMetrics::now_ns()) {}
+    ~KLVStageTimer() { KLVMetrics::record(stage_, KLVMetrics::now_ns() - start_); }
+    KLVStageTimer(const KLVStageTimer&) = delete;
+    KLVStageTimer& operator=(const KLVStageTimer&) = delete;
+
+private:
+    KLVStage stage_;
+    uint64_t start_;
+};
+
+#define KLV_METRICS_CONCAT_(a, b) a##b
+#define KLV_METRICS_CONCAT(a, b) KLV_METRICS_CONCAT_(a, b)
+
+#if KLV_METRICS
+#define KLV_METRIC_ADD(counter, n) KLVMetrics::add(KLVCounter::counter, (n))
+#define KLV_METRIC_STAGE(stage) \
+    KLVStageTimer KLV_METRICS_CONCAT(klv_stage_timer_, __LINE__)(KLVStage::stage)
+#else
+#define KLV_METRIC_ADD(counter, n) ((void)0)
+#define KLV_METRIC_STAGE(stage) ((void)0)
+#endif
@@ -0,0 +1,93 @@
+#include "klv_node.h"
+#include <algorithm>
+#include <thread>
+
+struct KLVNode::Links {
+    Links() : busy(false) {}
+
+    void lock() {
+        while (busy.exchange(true, std::memory_order_acquire)) {
+            std::this_thread::yield();
+        }
+    }
+    void unlock() { busy.store(false, std::memory_order_release); }
+
+    std::atomic<bool> busy;
+    std::vector<KLVNode*> parents;
+};
+
+KLVNode::~KLVNode() {
+    delete links_.load(std::memory_order_relaxed);
+}
+
+uint64_t KLVNode::next_revision() {
+    static const uint64_t BLOCK = 1024;
+    static std::atomic<uint64_t> counter{0};
+    static thread_local uint64_t next = 0;
+    static thread_local uint64_t limit = 0;
+    if (next == limit) {
+        next = counter.fetch_add(BLOCK, std::memory_order_relaxed) + 1;
+        limit = next + BLOCK;
+    }
+    return next++;
+}
+
+void KLVNode::notify_parents(int untracked) {
+    Links* links = links_.load(std::memory_order_acquire);
+    if (!links) return;
+    links->lock();
+    for (KLVNode* p : links->parents) {
+        p->child_changed(untracked);
+    }
+    links->unlock();
+}
+
+void KLVNode::link_parent(KLVNode* parent) {
+    Links* links = links_.load(std::memory_order_acquire);
+    if (!links) {
+        Links* fresh = new Links();
+        if (links_.compare_exchange_strong(links, fresh, std::memory_order_acq_rel)) {
+            links = fresh;
+        } else {
+            delete fresh;
+        }
+    }
+    links->lock();
+    try {
+        links->parents.push_back(parent);
+        if (links->parents.size() == 1) linked_changed(true);
+    } catch (...) {
+        links->unlock();
+        throw;
+    }
+    links->unlock();
+}
+
+void KLVNode::unlink_parent(KLVNode* parent) {
+    Links* links = links_.load(std::memory_order_acquire);
+    if (!links) return;
+    links->lock();
+    auto it = std::find(links->parents.begin(), links->parents.end(), parent);
+    if (it != links->parents.end()) {
+        links->parents.erase(it);
+        if (links->parents.empty()) linked_changed(false);
+    }
+    links->unlock();
+}
+
+void KLVNode::relink_parent(KLVNode* from, KLVNode* to) {
+    Links* links = links_.load(std::memory_order_acquire);
+    if (!links) return;
+    links->lock();
+    std::replace(links->parents.begin(), links->parents.end(), from, to);
+    links->unlock();
+}
+
+bool KLVNode::linked() const {
+    Links* links = links_.load(std::memory_order_acquire);
+    if (!links) return false;
+    links->lock();
+    const bool any = !links->parents.empty();
+    links->unlock();
+    return any;
+}
@@ -1,10 +1,75 @@
 #pragma once
+#include "klv_buffer.h"
+#include <atomic>
 #include <vector>
 #include <cstdint>
 
 class KLVNode {
 public:
-    virtual ~KLVNode() = default;
+    KLVNode() : links_(nullptr) {}
+    // A copy belongs to no set
+    KLVNode(const KLVNode&) : KLVNode() {}
+    KLVNode& operator=(const KLVNode&) { return *this; }
+    virtual ~KLVNode();
     virtual std::vector<uint8_t> encode() const = 0;
     virtual void decode(const std::vector<uint8_t>& data) = 0;
+
+    // Append the encoding to |out|
+    virtual void encode_into(std::vector<uint8_t>& out) const {
+        auto data = encode();
+        out.insert(out.end(), data.begin(), data.end());
+    }
+
+    // Append the encoding as segments, referencing large values in place
+    virtual void encode_segments(SegmentList& out) const {
+        std::vector<uint8_t> data;
+        encode_into(data);
+        out.append(data);
+    }
+
+    // Changes whenever the next encode() may differ from the previous one.
+    // 0 means untracked: memoizing parents re-encode the node every time.
+    virtual uint64_t revision() const { return 0; }
+
+protected:
+    // Unique process-wide and increasing within a thread. Each thread takes
+    // ids from a shared counter in blocks, so nodes built concurrently do
+    // not contend on it.
+    static uint64_t next_revision();
+
+    // New revision for a tracked node that changed after construction.
+    // Memoizing sets above the node get newer revisions, so they know
+    // their subtree changed without walking it.
+    uint64_t touch() {
+        const uint64_t rev = next_revision();
+        notify_parents(0);
+        return rev;
+    }
+
+    // Called on a set when a child changed. |untracked| is +1 when the
+    // child became untracked, -1 when it became tracked again, else 0.
+    virtual void child_changed(int untracked) { (void)untracked; }
+
+    // Called with the links locked when the node gains its first set or
+    // loses its last one
+    virtual void linked_changed(bool linked) { (void)linked; }
+
+    void notify_parents(int untracked);
+
+private:
+    friend class KLVSet;
+    struct Links;
+
+    // Sets holding the node, only recorded under memoizing sets. Linking
+    // is thread-safe, so read-only sets shared between threads can be
+    // copied concurrently.
+    void link_parent(KLVNode* parent);
+    void unlink_parent(KLVNode* parent);
+    void relink_parent(KLVNode* from, KLVNode* to);
+    // True when a set holds the node
+    bool linked() const;
+
+    // Allocated on the first link; nullptr for nodes never held by a
+    // memoizing set
+    std::atomic<Links*> links_;
 };
@@ -0,0 +1,201 @@
+#include "klv_pipeline.h"
+#include "st0601.h"
+
+#include <chrono>
+#include <stdexcept>
+
+namespace stanag {
+
+namespace {
+
+// Idle wait of a polling stage: spin on yield first, then sleep briefly
+class Backoff {
+public:
+    Backoff() : spins_(0) {}
+    void pause() {
+        if (++spins_ < 64) {
+            std::this_thread::yield();
+        } else {
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+        }
+    }
+    void reset() { spins_ = 0; }
+
+private:
+    unsigned spins_;
+};
+
+void note_depth(std::atomic<size_t>& max_depth, size_t depth) {
+    size_t seen = max_depth.load(std::memory_order_relaxed);
+    while (depth > seen &&
+           !max_depth.compare_exchange_weak(seen, depth, std::memory_order_relaxed)) {
+    }
+}
+
+QueueStats queue_stats(size_t capacity, size_t depth, size_t max_depth, uint64_t drops) {
+    QueueStats s;
+    s.capacity = capacity;
+    s.depth = depth;
+    s.max_depth = max_depth;
+    s.drops = drops;
+    return s;
+}
+
+} // namespace
+
+IngestPipeline::IngestPipeline(const PipelineConfig& config, Consumer consumer)
+    : config_(config),
+      consumer_(std::move(consumer)),
+      running_(false),
+      inputs_closed_(false),
+      output_closed_(false),
+      framed_(0),
+      decoded_(0),
+      invalid_(0),
+      delivered_(0),
+      discarded_bytes_(0),
+      feed_count_(0) {
+    if (config_.decode_workers == 0) config_.decode_workers = 1;
+    for (unsigned i = 0; i < config_.decode_workers; ++i) {
+        inputs_.emplace_back(new Stage<Job>(config_.queue_capacity));
+    }
+    output_.reset(new Stage<DecodedPacket>(config_.queue_capacity));
+}
+
+IngestPipeline::~IngestPipeline() {
+    stop();
+}
+
+void IngestPipeline::start() {
+    if (running_) return;
+    running_ = true;
+    inputs_closed_.store(false);
+    output_closed_.store(false);
+    for (size_t i = 0; i < inputs_.size(); ++i) {
+        workers_.emplace_back([this, i]() { decode_loop(i); });
+    }
+    consumer_thread_ = std::thread([this]() { consume_loop(); });
+}
+
+void IngestPipeline::stop() {
+    if (!running_) return;
+    running_ = false;
+    // Close stage by stage so every queued packet is delivered
+    inputs_closed_.store(true, std::memory_order_release);
+    for (auto& worker : workers_) worker.join();
+    workers_.clear();
+    output_closed_.store(true, std::memory_order_release);
+    consumer_thread_.join();
+}
+
+template <typename T>
+void IngestPipeline::enqueue(Stage<T>& stage, T&& item) {
+    Backoff backoff;
+    while (!stage.ring.try_push(std::move(item))) {
+        if (config_.backpressure == Backpressure::DropOldest) {
+            T victim;
+            if (stage.ring.try_pop(victim)) {
+                stage.metrics.drops.fetch_add(1, std::memory_order_relaxed);
+            }
+        } else {
+            backoff.pause();
+        }
+    }
+    note_depth(stage.metrics.max_depth, stage.ring.size());
+}
+
+void IngestPipeline::dispatch(uint32_t feed, uint64_t sequence, ByteSlice bytes) {
+    framed_.fetch_add(1, std::memory_order_relaxed);
+    Job job;
+    job.feed = feed;
+    job.sequence = sequence;
+    job.bytes = std::move(bytes);
+    enqueue(*inputs_[feed % inputs_.size()], std::move(job));
+}
+
+void IngestPipeline::push(uint32_t feed, const uint8_t* data, size_t size) {
+    if (!running_) throw std::runtime_error("IngestPipeline is not running");
+    auto it = feeds_.find(feed);
+    if (it == feeds_.end()) {
+        it = feeds_.emplace(feed, FeedState(config_.max_pending)).first;
+        feed_count_.store(feeds_.size(), std::memory_order_relaxed);
+    }
+    FeedState& state = it->second;
+    const uint64_t discarded = state.framer.discarded_bytes();
+    state.framer.push(data, size, [&](const uint8_t* packet, size_t length) {
+        dispatch(feed, state.sequence++, ByteSlice::copy(packet, length));
+    });
+    discarded_bytes_.fetch_add(state.framer.discarded_bytes() - discarded,
+                               std::memory_order_relaxed);
+}
+
+void IngestPipeline::push_packet(uint32_t feed, const ByteSlice& packet) {
+    if (!running_) throw std::runtime_error("IngestPipeline is not running");
+    auto it = feeds_.find(feed);
+    if (it == feeds_.end()) {
+        it = feeds_.emplace(feed, FeedState(config_.max_pending)).first;
+        feed_count_.store(feeds_.size(), std::memory_order_relaxed);
+    }
+    dispatch(feed, it->second.sequence++, packet);
+}
+
+void IngestPipeline::decode_loop(size_t worker) {
+    Stage<Job>& input = *inputs_[worker];
+    Backoff backoff;
+    Job job;
+    while (true) {
+        if (!input.ring.try_pop(job)) {
+            // Closed and empty: the producer has stopped pushing
+            if (inputs_closed_.load(std::memory_order_acquire) && input.ring.empty()) return;
+            backoff.pause();
+            continue;
+        }
+        backoff.reset();
+        DecodedPacket out;
+        if (!decode_stanag4609_packet(job.bytes, out.set)) {
+            invalid_.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+        decoded_.fetch_add(1, std::memory_order_relaxed);
+        out.feed = job.feed;
+        out.sequence = job.sequence;
+        out.bytes = std::move(job.bytes);
+        enqueue(*output_, std::move(out));
+    }
+}
+
+void IngestPipeline::consume_loop() {
+    Backoff backoff;
+    DecodedPacket packet;
+    while (true) {
+        if (!output_->ring.try_pop(packet)) {
+            if (output_closed_.load(std::memory_order_acquire) && output_->ring.empty()) return;
+            backoff.pause();
+            continue;
+        }
+        backoff.reset();
+        if (consumer_) consumer_(packet);
+        delivered_.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+PipelineStats IngestPipeline::stats() const {
+    PipelineStats s;
+    s.framed = framed_.load();
+    s.decoded = decoded_.load();
+    s.invalid = invalid_.load();
+    s.delivered = delivered_.load();
+    s.discarded_bytes = discarded_bytes_.load();
+    s.feeds = feed_count_.load();
+    for (const auto& input : inputs_) {
+        s.decode_queues.push_back(queue_stats(input->ring.capacity(), input->ring.size(),
+                                              input->metrics.max_depth.load(),
+                                              input->metrics.drops.load()));
+    }
+    s.output_queue = queue_stats(output_->ring.capacity(), output_->ring.size(),
+                                 output_->metrics.max_depth.load(),
+                                 output_->metrics.drops.load());
+    return s;
+}
+
+} // namespace stanag
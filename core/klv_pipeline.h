@@ -0,0 +1,137 @@
+#pragma once
+
+#include "klv.h"
+#include "klv_ring.h"
+#include "stanag.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace stanag {
+
+// What a stage does when the queue to the next stage is full
+enum class Backpressure {
+    Block,      // wait for room
+    DropOldest  // discard the oldest queued packet
+};
+
+struct PipelineConfig {
+    unsigned decode_workers = 2;
+    size_t queue_capacity = 1024;       // per decoder input and for the output
+    Backpressure backpressure = Backpressure::Block;
+    size_t max_pending = 1 << 20;       // PacketFramer buffer per feed
+};
+
+// Packet handed to the consumer
+struct DecodedPacket {
+    uint32_t feed;
+    uint64_t sequence;  // per feed, from 0 in framing order
+    ByteSlice bytes;    // the complete packet
+    KLVSet set;         // decoded ST 0601 local set
+};
+
+struct QueueStats {
+    size_t capacity;
+    size_t depth;       // at the time of the snapshot
+    size_t max_depth;   // high-water mark
+    uint64_t drops;     // DropOldest discards
+};
+
+struct PipelineStats {
+    uint64_t framed;
+    uint64_t decoded;
+    uint64_t invalid;   // malformed or bad checksum, not delivered
+    uint64_t delivered;
+    uint64_t discarded_bytes;
+    size_t feeds;
+    std::vector<QueueStats> decode_queues;
+    QueueStats output_queue;
+};
+
+// Multi-feed ingest: framer stage -> decoder workers -> consumer.
+//
+// The framer stage runs on the thread calling push(): it reassembles each
+// feed's packets and routes them to the worker owning the feed (feed id
+// modulo decode_workers). Workers decode and hand results to a single
+// consumer thread that calls the consumer callback. Stages are connected by
+// bounded lock-free rings, and as a feed only ever goes through one worker
+// its packets reach the consumer in order without any lock.
+class IngestPipeline {
+public:
+    using Consumer = std::function<void(const DecodedPacket&)>;
+
+    IngestPipeline(const PipelineConfig& config, Consumer consumer);
+    ~IngestPipeline();
+    IngestPipeline(const IngestPipeline&) = delete;
+    IngestPipeline& operator=(const IngestPipeline&) = delete;
+
+    void start();
+    // Deliver everything pushed so far, then join the threads
+    void stop();
+
+    // Framer stage: bytes of |feed|'s stream, in arbitrary pieces. Call from
+    // a single thread, after start(); throws std::runtime_error otherwise.
+    void push(uint32_t feed, const uint8_t* data, size_t size);
+    // One complete packet of |feed|, bypassing the framer
+    void push_packet(uint32_t feed, const ByteSlice& packet);
+
+    PipelineStats stats() const;
+
+private:
+    struct Job {
+        uint32_t feed;
+        uint64_t sequence;
+        ByteSlice bytes;
+    };
+    struct Metrics {
+        Metrics() : max_depth(0), drops(0) {}
+        std::atomic<size_t> max_depth;
+        std::atomic<uint64_t> drops;
+    };
+    template <typename T>
+    struct Stage {
+        explicit Stage(size_t capacity) : ring(capacity) {}
+        BoundedRing<T> ring;
+        Metrics metrics;
+    };
+    struct FeedState {
+        explicit FeedState(size_t max_pending) : framer(max_pending), sequence(0) {}
+        PacketFramer framer;
+        uint64_t sequence;
+    };
+
+    template <typename T>
+    void enqueue(Stage<T>& stage, T&& item);
+    void dispatch(uint32_t feed, uint64_t sequence, ByteSlice bytes);
+    void decode_loop(size_t worker);
+    void consume_loop();
+
+    PipelineConfig config_;
+    Consumer consumer_;
+    bool running_;
+
+    std::vector<std::unique_ptr<Stage<Job>>> inputs_;
+    std::unique_ptr<Stage<DecodedPacket>> output_;
+    std::vector<std::thread> workers_;
+    std::thread consumer_thread_;
+    std::atomic<bool> inputs_closed_;
+    std::atomic<bool> output_closed_;
+
+    // Framer stage state, owned by the pushing thread
+    std::unordered_map<uint32_t, FeedState> feeds_;
+
+    std::atomic<uint64_t> framed_;
+    std::atomic<uint64_t> decoded_;
+    std::atomic<uint64_t> invalid_;
+    std::atomic<uint64_t> delivered_;
+    std::atomic<uint64_t> discarded_bytes_;
+    std::atomic<size_t> feed_count_;
+};
+
+} // namespace stanag
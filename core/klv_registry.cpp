@@ -1,7 +1,35 @@
 #include "klv_registry.h"
+#include "st0102.h"
+#include "st0601.h"
+#include "st0903.h"
+#include "st_common.h"
+
+#include <algorithm>
+#include <vector>
+
+constexpr size_t KLVCodec::MAX_SIZE;
 
 void KLVRegistry::register_ul(const UL& ul, const KLVEntry& entry) {
     entries_[ul] = entry;
+    const KLVCodec* codec = builtin(ul);
+    if (codec && entry.codec != codec) {
+        overrides_.insert(ul);
+    } else {
+        overrides_.erase(ul);
+    }
+}
+
+void KLVRegistry::register_codec(const UL& ul, const KLVCodec& codec) {
+    const KLVCodec* c = &codec;
+    register_ul(ul, {
+        [c](double v) {
+            uint8_t buf[KLVCodec::MAX_SIZE];
+            const size_t n = c->encode(c->params, v, buf);
+            return std::vector<uint8_t>(buf, buf + n);
+        },
+        [c](const std::vector<uint8_t>& bytes) { return c->decode(c->params, bytes.data(), bytes.size()); },
+        c
+    });
 }
 
 const KLVEntry* KLVRegistry::find(const UL& ul) const {
@@ -10,6 +38,34 @@ const KLVEntry* KLVRegistry::find(const UL& ul) const {
     return nullptr;
 }
 
+KLVCodecRef KLVRegistry::lookup(const UL& ul) const {
+    const KLVCodec* codec = builtin(ul);
+    if (codec && (overrides_.empty() || !overrides_.count(ul))) return KLVCodecRef{codec, nullptr};
+    const KLVEntry* entry = find(ul);
+    return KLVCodecRef{entry ? entry->codec : nullptr, entry};
+}
+
+const KLVCodec* KLVRegistry::builtin(const UL& ul) {
+    // Bytes 0..11 are common to every synthetic UL, 13 and 14 are zero
+    static constexpr UL base = misb::make_st_ul(0, 0);
+    if (!std::equal(base.begin(), base.begin() + 12, ul.begin()) || ul[13] != 0 || ul[14] != 0) {
+        return nullptr;
+    }
+    switch (ul[12]) {
+    case misb::st0102::ST_ID:
+        return misb::st0102::builtin_codec(ul[15]);
+    case misb::st0601::ST_ID:
+        return misb::st0601::builtin_codec(ul[15]);
+    case misb::st0903::ST_ID:
+    case misb::st0903::VTARGET_ST_ID:
+    case misb::st0903::ALGORITHM_ST_ID:
+    case misb::st0903::ONTOLOGY_ST_ID:
+        return misb::st0903::builtin_codec(ul[12], ul[15]);
+    default:
+        return nullptr;
+    }
+}
+
 KLVRegistry& KLVRegistry::instance() {
     static KLVRegistry inst;
     return inst;
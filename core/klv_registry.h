@@ -1,19 +1,79 @@
 #pragma once
 #include "klv_types.h"
+#include <cstddef>
 #include <map>
+#include <set>
 #include <vector>
 #include <functional>
+#include <utility>
+
+// Codec of a built-in standard: plain function pointers over a constant
+// parameter block, so the codec tables of ST 0102, ST 0601 and ST 0903 are
+// constant-initialized data and need no registration. Values encode to at
+// most MAX_SIZE bytes.
+struct KLVCodec {
+    static constexpr size_t MAX_SIZE = 8;
+
+    uint8_t tag;
+    // Writes the value bytes to |dst| and returns their count
+    size_t (*encode)(const void* params, double value, uint8_t* dst);
+    double (*decode)(const void* params, const uint8_t* data, size_t size);
+    const void* params;
+};
 
 struct KLVEntry {
+    KLVEntry() : codec(nullptr) {}
+    // Run-time codecs register as {encoder, decoder}
+    KLVEntry(std::function<std::vector<uint8_t>(double)> enc,
+             std::function<double(const std::vector<uint8_t>&)> dec,
+             const KLVCodec* builtin = nullptr)
+        : encoder(std::move(enc)), decoder(std::move(dec)), codec(builtin) {}
+
     std::function<std::vector<uint8_t>(double)> encoder;
     std::function<double(const std::vector<uint8_t>&)> decoder;
+    // Built-in codec the entry stands for, nullptr for run-time codecs
+    const KLVCodec* codec;
+};
+
+// Codec resolved for one UL: a built-in codec when |codec| is set, else a
+// run-time entry
+struct KLVCodecRef {
+    const KLVCodec* codec;
+    const KLVEntry* entry;
+
+    explicit operator bool() const { return codec || entry; }
+
+    std::vector<uint8_t> encode(double value) const {
+        if (!codec) return entry->encoder(value);
+        uint8_t buf[KLVCodec::MAX_SIZE];
+        const size_t n = codec->encode(codec->params, value, buf);
+        return std::vector<uint8_t>(buf, buf + n);
+    }
+
+    double decode(const uint8_t* data, size_t size) const {
+        if (codec) return codec->decode(codec->params, data, size);
+        return entry->decoder(std::vector<uint8_t>(data, data + size));
+    }
 };
 
 class KLVRegistry {
 public:
     void register_ul(const UL& ul, const KLVEntry& entry);
+    // Expose a built-in codec through find(), as register_st0601 and
+    // friends do for compatibility; lookup() sees it either way
+    void register_codec(const UL& ul, const KLVCodec& codec);
+    // Registered entry only
     const KLVEntry* find(const UL& ul) const;
+    // Built-in codec of |ul| unless a run-time entry overrides it, else the
+    // registered entry. Needs no prior registration for built-in standards.
+    KLVCodecRef lookup(const UL& ul) const;
     static KLVRegistry& instance();
+
+    // Built-in codec of a synthetic make_st_ul(st_id, tag) UL, nullptr when
+    // |ul| belongs to no built-in standard
+    static const KLVCodec* builtin(const UL& ul);
 private:
     std::map<UL, KLVEntry> entries_;
+    // Built-in ULs registered with a run-time codec
+    std::set<UL> overrides_;
 };
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+// Bounded lock-free FIFO (sequence-numbered ring). Any number of threads may
+// push and pop; the pipeline uses it single-producer/single-consumer between
+// the framer and a decoder, and multi-producer/single-consumer between the
+// decoders and the consumer. Items popped by a producer to make room
+// (drop-oldest) keep FIFO order for the rest.
+//
+// T must be default constructible and move assignable; popped cells keep a
+// moved-from T until they are reused.
+template <typename T>
+class BoundedRing {
+public:
+    // |capacity| is rounded up to a power of two, at least 2
+    explicit BoundedRing(size_t capacity);
+    BoundedRing(const BoundedRing&) = delete;
+    BoundedRing& operator=(const BoundedRing&) = delete;
+
+    bool try_push(T&& value);
+    bool try_pop(T& out);
+
+    size_t capacity() const { return mask_ + 1; }
+    // Approximate while other threads push or pop
+    size_t size() const {
+        const size_t tail = enqueue_.load(std::memory_order_acquire);
+        const size_t head = dequeue_.load(std::memory_order_acquire);
+        return tail > head ? tail - head : 0;
+    }
+    bool empty() const { return size() == 0; }
+
+private:
+    struct Cell {
+        std::atomic<size_t> sequence;
+        T value;
+    };
+
+    std::unique_ptr<Cell[]> cells_;
+    size_t mask_;
+    // Producers and consumers touch different cache lines
+    char pad0_[64];
+    std::atomic<size_t> enqueue_;
+    char pad1_[64];
+    std::atomic<size_t> dequeue_;
+    char pad2_[64];
+};
+
+template <typename T>
+BoundedRing<T>::BoundedRing(size_t capacity) : enqueue_(0), dequeue_(0) {
+    size_t n = 2;
+    while (n < capacity) n <<= 1;
+    cells_.reset(new Cell[n]);
+    for (size_t i = 0; i < n; ++i) cells_[i].sequence.store(i, std::memory_order_relaxed);
+    mask_ = n - 1;
+}
+
+template <typename T>
+bool BoundedRing<T>::try_push(T&& value) {
+    size_t pos = enqueue_.load(std::memory_order_relaxed);
+    while (true) {
+        Cell& cell = cells_[pos & mask_];
+        const size_t seq = cell.sequence.load(std::memory_order_acquire);
+        const intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+        if (diff == 0) {
+            if (enqueue_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                cell.value = std::move(value);
+                cell.sequence.store(pos + 1, std::memory_order_release);
+                return true;
+            }
+        } else if (diff < 0) {
+            return false; // full
+        } else {
+            pos = enqueue_.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+template <typename T>
+bool BoundedRing<T>::try_pop(T& out) {
+    size_t pos = dequeue_.load(std::memory_order_relaxed);
+    while (true) {
+        Cell& cell = cells_[pos & mask_];
+        const size_t seq = cell.sequence.load(std::memory_order_acquire);
+        const intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+        if (diff == 0) {
+            if (dequeue_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                out = std::move(cell.value);
+                cell.sequence.store(pos + mask_ + 1, std::memory_order_release);
+                return true;
+            }
+        } else if (diff < 0) {
+            return false; // empty
+        } else {
+            pos = dequeue_.load(std::memory_order_relaxed);
+        }
+    }
+}
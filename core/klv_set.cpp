@@ -1,81 +1,309 @@
 #include "klv_set.h"
 #include "klv_leaf.h"
 #include "klv_bytes.h"
+#include "klv_metrics.h"
 #include "klv_registry.h"
+#include "klv_trace.h"
 #include "st_common.h"
 #include <algorithm>
 
+struct KLVSet::Cache {
+    Cache() : valid(false), rev(0) {}
+
+    bool valid;
+    uint64_t rev;                    // revision() at encode
+    std::vector<uint8_t> bytes;
+    std::vector<size_t> ends;        // end of each child's bytes
+    std::vector<uint64_t> revs;      // child revisions at encode
+    std::vector<uint64_t> scratch_revs;
+    std::vector<uint8_t> scratch;
+};
+
 KLVSet::KLVSet(bool use_ul_keys, uint8_t st_id)
-    : use_ul_keys_(use_ul_keys), st_id_(st_id) {}
+    : use_ul_keys_(use_ul_keys), st_id_(st_id), revision_(next_revision()), tracking_(false),
+      untracked_(0) {}
+
+KLVSet::KLVSet(const KLVSet& other)
+    : KLVNode(), children_(other.children_), use_ul_keys_(other.use_ul_keys_),
+      st_id_(other.st_id_), revision_(next_revision()), tracking_(false), untracked_(0),
+      cache_(other.cache_ ? new Cache() : nullptr) {
+    // A new set has no parents yet
+    if (cache_) set_tracking(true);
+}
+
+KLVSet::KLVSet(KLVSet&& other) noexcept
+    : KLVNode(), use_ul_keys_(other.use_ul_keys_), st_id_(other.st_id_),
+      revision_(next_revision()), tracking_(false), untracked_(0),
+      cache_(std::move(other.cache_)) {
+    if (cache_) cache_->valid = false;
+    take_children(other);
+}
+
+KLVSet& KLVSet::operator=(const KLVSet& other) {
+    if (this == &other) return *this;
+    const bool was_untracked = untracked_ != 0;
+    release_children();
+    use_ul_keys_ = other.use_ul_keys_;
+    st_id_ = other.st_id_;
+    if (!other.cache_) {
+        cache_.reset();
+    } else if (cache_) {
+        cache_->valid = false;
+    } else {
+        cache_.reset(new Cache());
+    }
+    copy_children(other);
+    revision_ = next_revision();
+    notify_parents((untracked_ != 0) - was_untracked);
+    return *this;
+}
+
+KLVSet& KLVSet::operator=(KLVSet&& other) noexcept {
+    if (this == &other) return *this;
+    const bool was_untracked = untracked_ != 0;
+    release_children();
+    use_ul_keys_ = other.use_ul_keys_;
+    st_id_ = other.st_id_;
+    cache_ = std::move(other.cache_);
+    if (cache_) cache_->valid = false;
+    take_children(other);
+    revision_ = next_revision();
+    notify_parents((untracked_ != 0) - was_untracked);
+    return *this;
+}
+
+KLVSet::~KLVSet() {
+    release_children();
+}
+
+void KLVSet::set_tracking(bool tracking) {
+    if (tracking == tracking_) return;
+    tracking_ = tracking;
+    untracked_ = 0;
+    for (const auto& child : children_) {
+        if (tracking) {
+            child->link_parent(this);
+            if (child->revision() == 0) ++untracked_;
+        } else {
+            child->unlink_parent(this);
+        }
+    }
+    // Changes made while untracked were never notified
+    revision_ = next_revision();
+}
+
+void KLVSet::linked_changed(bool linked) {
+    if (!cache_) set_tracking(linked);
+}
+
+void KLVSet::release_children() {
+    if (tracking_) {
+        for (const auto& child : children_) {
+            child->unlink_parent(this);
+        }
+        untracked_ = 0;
+    }
+    children_.clear();
+}
+
+void KLVSet::copy_children(const KLVSet& other) {
+    // Linked below only if the set memoizes or is held by a memoizing set
+    children_ = other.children_;
+    tracking_.store(false, std::memory_order_relaxed);
+    set_tracking(cache_ || linked());
+}
+
+void KLVSet::take_children(KLVSet& other) {
+    const bool was_untracked = other.untracked_ != 0;
+    const bool track = cache_ || linked();
+    children_.swap(other.children_);
+    if (other.tracking_) {
+        // Moving between two tracking sets only swaps the parent pointers
+        for (const auto& child : children_) {
+            if (track) {
+                child->relink_parent(&other, this);
+            } else {
+                child->unlink_parent(&other);
+            }
+        }
+        tracking_ = track;
+        untracked_ = track ? other.untracked_.load() : 0;
+    } else {
+        tracking_ = false;
+        set_tracking(track);
+    }
+    other.untracked_ = 0;
+    other.tracking_ = other.cache_ || other.linked();
+    other.revision_ = next_revision();
+    other.notify_parents(was_untracked ? -1 : 0);
+}
+
+void KLVSet::adopt(std::shared_ptr<KLVNode> node) {
+    if (tracking_) node->link_parent(this);
+    children_.push_back(std::move(node));
+}
 
 void KLVSet::add(std::shared_ptr<KLVNode> node) {
+    int untracked = 0;
+    if (tracking_) {
+        node->link_parent(this);
+        if (node->revision() == 0 && untracked_++ == 0) untracked = 1;
+    }
     children_.push_back(node);
+    revision_ = next_revision();
+    notify_parents(untracked);
+}
+
+void KLVSet::child_changed(int untracked) {
+    int change = 0;
+    if (untracked > 0 && untracked_++ == 0) change = 1;
+    if (untracked < 0 && --untracked_ == 0) change = -1;
+    revision_ = next_revision();
+    notify_parents(change);
+}
+
+uint64_t KLVSet::revision() const {
+    if (tracking_.load(std::memory_order_relaxed)) {
+        return untracked_.load(std::memory_order_relaxed) ? 0 : revision_.load(std::memory_order_relaxed);
+    }
+    uint64_t rev = revision_.load(std::memory_order_relaxed);
+    for (const auto& child : children_) {
+        const uint64_t r = child->revision();
+        if (r == 0) return 0;
+        rev = (rev ^ r) * 0x9E3779B97F4A7C15ull;
+        rev ^= rev >> 29;
+    }
+    return rev ? rev : 1;
 }
 
 std::vector<uint8_t> KLVSet::encode() const {
     std::vector<uint8_t> out;
+    encode_into(out);
+    return out;
+}
+
+void KLVSet::set_encode_cache(bool enabled) {
+    if (enabled) {
+        cache_.reset(new Cache());
+    } else {
+        cache_.reset();
+    }
+    set_tracking(enabled || linked());
+}
+
+void KLVSet::encode_segments(SegmentList& out) const {
     for (const auto& child : children_) {
-        auto data = child->encode();
-        out.insert(out.end(), data.begin(), data.end());
+        child->encode_segments(out);
     }
-    return out;
+}
+
+void KLVSet::encode_into(std::vector<uint8_t>& out) const {
+    KLV_TRACE_SPAN_ARG("KLVSet::encode", "st_id", st_id_);
+    if (!cache_) {
+        for (const auto& child : children_) {
+            child->encode_into(out);
+        }
+        return;
+    }
+    Cache& cache = *cache_;
+
+    // Nothing below the set changed since the cache was built
+    const uint64_t rev = revision();
+    if (cache.valid && rev != 0 && rev == cache.rev) {
+        out.insert(out.end(), cache.bytes.begin(), cache.bytes.end());
+        return;
+    }
+
+    const size_t n = children_.size();
+    cache.scratch_revs.resize(n);
+    bool clean = cache.valid && cache.revs.size() == n;
+    for (size_t i = 0; i < n; ++i) {
+        cache.scratch_revs[i] = children_[i]->revision();
+        if (cache.scratch_revs[i] == 0 || (clean && cache.scratch_revs[i] != cache.revs[i])) {
+            clean = false;
+        }
+    }
+
+    if (!clean) {
+        // Rebuild, copying the bytes of children that did not change
+        const bool reuse = cache.valid && cache.revs.size() == n;
+        cache.scratch.clear();
+        std::vector<size_t> ends(n);
+        for (size_t i = 0; i < n; ++i) {
+            if (reuse && cache.scratch_revs[i] != 0 && cache.scratch_revs[i] == cache.revs[i]) {
+                const size_t begin = i ? cache.ends[i - 1] : 0;
+                cache.scratch.insert(cache.scratch.end(), cache.bytes.begin() + begin,
+                                     cache.bytes.begin() + cache.ends[i]);
+            } else {
+                children_[i]->encode_into(cache.scratch);
+            }
+            ends[i] = cache.scratch.size();
+        }
+        cache.bytes.swap(cache.scratch);
+        cache.ends.swap(ends);
+        cache.revs.swap(cache.scratch_revs);
+        cache.valid = true;
+    }
+    cache.rev = rev;
+    out.insert(out.end(), cache.bytes.begin(), cache.bytes.end());
 }
 
 void KLVSet::decode(const std::vector<uint8_t>& data) {
-    children_.clear();
+    parse(data.data(), data.size(), nullptr);
+}
+
+void KLVSet::decode(const ByteSlice& data) {
+    parse(data.data(), data.size(), &data);
+}
+
+void KLVSet::parse(const uint8_t* data, size_t size, const ByteSlice* owner) {
+    KLV_METRIC_STAGE(SetDecode);
+    KLV_TRACE_SPAN_ARG("KLVSet::decode", "st_id", st_id_);
+    const bool was_untracked = untracked_ != 0;
+    release_children();
+    revision_ = next_revision();
+    if (cache_) cache_->valid = false;
+    notify_parents(was_untracked ? -1 : 0);
+    const KLVRegistry& registry = KLVRegistry::instance();
     size_t i = 0;
     while (true) {
+        UL ul;
         if (use_ul_keys_) {
-            if (i + 18 > data.size()) break;
-            UL ul;
-            std::copy(data.begin() + i, data.begin() + i + 16, ul.begin());
-            i += 16;
-            size_t len = 0, len_bytes = 0;
-            if (!misb::decode_ber_length(data, i, len, len_bytes)) break;
-            i += len_bytes;
-            if (i + len > data.size()) break;
-            std::vector<uint8_t> value(data.begin() + i, data.begin() + i + len);
-            i += len;
-
-            const KLVEntry* entry = KLVRegistry::instance().find(ul);
-            if (entry) {
-                std::vector<uint8_t> item;
-                item.insert(item.end(), ul.begin(), ul.end());
-                auto len_vec = misb::encode_ber_length(len);
-                item.insert(item.end(), len_vec.begin(), len_vec.end());
-                item.insert(item.end(), value.begin(), value.end());
-                auto leaf = std::make_shared<KLVLeaf>(ul);
-                leaf->decode(item);
-                children_.push_back(leaf);
-            } else {
-                auto bytes = std::make_shared<KLVBytes>(ul, value);
-                children_.push_back(bytes);
+            if (i + 18 > size) {
+                if (i < size) KLV_METRIC_ADD(ErrorTruncated, 1);
+                break;
             }
+            std::copy(data + i, data + i + 16, ul.begin());
+            i += 16;
         } else {
-            if (i + 1 > data.size()) break;
-            uint8_t tag = data[i++];
-            size_t len = 0, len_bytes = 0;
-            if (!misb::decode_ber_length(data, i, len, len_bytes)) break;
-            i += len_bytes;
-            if (i + len > data.size()) break;
-            UL ul = misb::make_st_ul(st_id_, tag);
-            std::vector<uint8_t> value(data.begin() + i, data.begin() + i + len);
-            i += len;
-
-            const KLVEntry* entry = KLVRegistry::instance().find(ul);
-            if (entry) {
-                std::vector<uint8_t> item;
-                item.push_back(tag);
-                auto len_vec = misb::encode_ber_length(len);
-                item.insert(item.end(), len_vec.begin(), len_vec.end());
-                item.insert(item.end(), value.begin(), value.end());
-                auto leaf = std::make_shared<KLVLeaf>(ul, 0.0, true);
-                leaf->decode(item);
-                children_.push_back(leaf);
-            } else {
-                auto bytes = std::make_shared<KLVBytes>(ul, value, true);
-                children_.push_back(bytes);
-            }
+            if (i + 1 > size) break;
+            ul = misb::make_st_ul(st_id_, data[i++]);
+        }
+        size_t len = 0;
+        const size_t len_bytes = misb::read_ber_length(data + i, size - i, len);
+        if (len_bytes == 0) {
+            KLV_METRIC_ADD(ErrorBerLength, 1);
+            break;
+        }
+        i += len_bytes;
+        if (len > size - i) {
+            KLV_METRIC_ADD(ErrorTruncated, 1);
+            break;
+        }
+        const size_t value_offset = i;
+        i += len;
+
+        const KLVCodecRef codec = registry.lookup(ul);
+        if (codec) {
+            KLV_TRACE_SPAN_ARG("leaf_codec", "tag", ul[15]);
+            adopt(std::make_shared<KLVLeaf>(ul, codec.decode(data + value_offset, len), !use_ul_keys_));
+        } else if (owner) {
+            KLV_METRIC_ADD(UnknownTags, 1);
+            adopt(KLVBytes::view(ul, owner->slice(value_offset, len), !use_ul_keys_));
+        } else {
+            KLV_METRIC_ADD(UnknownTags, 1);
+            adopt(std::make_shared<KLVBytes>(
+                ul, std::vector<uint8_t>(data + value_offset, data + value_offset + len), !use_ul_keys_));
         }
     }
 }
@@ -1,18 +1,69 @@
 #pragma once
 #include "klv_node.h"
+#include <atomic>
 #include <memory>
 #include <vector>
 
 class KLVSet : public KLVNode {
 public:
     KLVSet(bool use_ul_keys = true, uint8_t st_id = 0);
+    // Copies share the children of |other| but not its encode cache
+    KLVSet(const KLVSet& other);
+    KLVSet(KLVSet&& other) noexcept;
+    KLVSet& operator=(const KLVSet& other);
+    KLVSet& operator=(KLVSet&& other) noexcept;
+    ~KLVSet() override;
     void add(std::shared_ptr<KLVNode> node);
     std::vector<uint8_t> encode() const override;
+    void encode_into(std::vector<uint8_t>& out) const override;
+    // Large byte items are referenced instead of copied; bypasses the
+    // encode cache
+    void encode_segments(SegmentList& out) const override;
     void decode(const std::vector<uint8_t>& data) override;
+    // Unregistered items reference |data| instead of copying their value
+    void decode(const ByteSlice& data);
     const std::vector<std::shared_ptr<KLVNode>>& children() const { return children_; }
     bool uses_ul_keys() const { return use_ul_keys_; }
+    uint8_t st_id() const { return st_id_; }
+
+    // Renewed whenever the set or a node below it changes, 0 when the
+    // subtree holds an untracked node. Constant time in and below memoizing
+    // sets, whose children notify them; elsewhere a walk combining the
+    // revisions of the subtree.
+    uint64_t revision() const override;
+
+    // Opt-in memoization: the set keeps the encoded bytes of every child and
+    // only re-encodes children whose revision changed since the previous
+    // encode. Children must be modified through set_value()/add()/decode()
+    // for changes to be seen. Encoding a memoizing set is not thread-safe.
+    // Only memoizing sets and the nodes below them record their parents;
+    // other sets pay nothing for the tracking.
+    void set_encode_cache(bool enabled);
+    bool encode_cache() const { return cache_ != nullptr; }
+
+protected:
+    void child_changed(int untracked) override;
+    void linked_changed(bool linked) override;
+
 private:
+    struct Cache;
+
+    // Link the children to the set, or unlink them, when the set starts or
+    // stops being memoizing or held by a memoizing set
+    void set_tracking(bool tracking);
+    void parse(const uint8_t* data, size_t size, const ByteSlice* owner);
+    void adopt(std::shared_ptr<KLVNode> node);
+    void release_children();
+    void take_children(KLVSet& other);
+    void copy_children(const KLVSet& other);
+
     std::vector<std::shared_ptr<KLVNode>> children_;
     bool use_ul_keys_;
     uint8_t st_id_;
+    std::atomic<uint64_t> revision_;
+    std::atomic<bool> tracking_;      // children are linked to the set
+    std::atomic<size_t> untracked_;   // direct children whose revision() is 0,
+                                      // counted while tracking
+    // Allocated while memoizing, so other sets do not carry the buffers
+    std::unique_ptr<Cache> cache_;
 };
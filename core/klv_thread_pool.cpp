@@ -0,0 +1,230 @@
+#include "klv_thread_pool.h"
+
+#include <algorithm>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace {
+
+// Pool and worker index of the calling thread
+struct CurrentWorker {
+    const ThreadPool* pool;
+    int index;
+};
+thread_local CurrentWorker current_worker = {nullptr, -1};
+
+void pin_current_thread(int cpu) {
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#else
+    (void)cpu;
+#endif
+}
+
+} // namespace
+
+ThreadPool::ThreadPool(unsigned threads) : ThreadPool([threads]() {
+    ThreadPoolConfig config;
+    config.threads = threads;
+    return config;
+}()) {}
+
+ThreadPool::ThreadPool(const ThreadPoolConfig& config) : pending_(0), stop_(false) {
+    unsigned threads = config.threads;
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    for (unsigned i = 0; i + 1 < threads; ++i) {
+        workers_.emplace_back(new Worker());
+    }
+    for (size_t i = 0; i < workers_.size(); ++i) {
+        int cpu = -1;
+        if (config.pin_threads) {
+            cpu = config.cpus.empty() ? static_cast<int>(i + 1)
+                                      : config.cpus[i % config.cpus.size()];
+        }
+        const int index = static_cast<int>(i);
+        workers_[i]->thread = std::thread([this, index, cpu]() {
+            if (cpu >= 0) pin_current_thread(cpu);
+            worker_loop(index);
+        });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(idle_mutex_);
+        stop_ = true;
+    }
+    idle_.notify_all();
+    for (auto& worker : workers_) worker->thread.join();
+    // Without workers, tasks submitted but never waited on run here
+    while (run_one()) {
+    }
+}
+
+ThreadPool& ThreadPool::shared() {
+    static ThreadPool pool;
+    return pool;
+}
+
+int ThreadPool::current_index() const {
+    return current_worker.pool == this ? current_worker.index : -1;
+}
+
+void ThreadPool::submit(std::function<void()> task) {
+    push(std::move(task));
+}
+
+void ThreadPool::push(std::function<void()> task) {
+    const int self = current_index();
+    if (self >= 0) {
+        Worker& worker = *workers_[static_cast<size_t>(self)];
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        worker.tasks.push_back(std::move(task));
+    } else {
+        std::lock_guard<std::mutex> lock(inject_mutex_);
+        inject_.push_back(std::move(task));
+    }
+    pending_.fetch_add(1, std::memory_order_release);
+    {
+        // Pairs with the predicate check of idle workers
+        std::lock_guard<std::mutex> lock(idle_mutex_);
+    }
+    idle_.notify_one();
+}
+
+bool ThreadPool::pop(int self, std::function<void()>& task) {
+    if (pending_.load(std::memory_order_acquire) == 0) return false;
+    // Own deque, newest first: the most recently split work is still hot
+    if (self >= 0) {
+        Worker& worker = *workers_[static_cast<size_t>(self)];
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        if (!worker.tasks.empty()) {
+            task = std::move(worker.tasks.back());
+            worker.tasks.pop_back();
+            pending_.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    {
+        std::lock_guard<std::mutex> lock(inject_mutex_);
+        if (!inject_.empty()) {
+            task = std::move(inject_.front());
+            inject_.pop_front();
+            pending_.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    // Steal the oldest (largest) task of another worker
+    const size_t n = workers_.size();
+    const size_t start = self >= 0 ? static_cast<size_t>(self) + 1 : 0;
+    for (size_t k = 0; k < n; ++k) {
+        const size_t victim = (start + k) % n;
+        if (static_cast<int>(victim) == self) continue;
+        Worker& worker = *workers_[victim];
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        if (!worker.tasks.empty()) {
+            task = std::move(worker.tasks.front());
+            worker.tasks.pop_front();
+            pending_.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool ThreadPool::run_one() {
+    std::function<void()> task;
+    if (!pop(current_index(), task)) return false;
+    task();
+    return true;
+}
+
+void ThreadPool::worker_loop(int index) {
+    current_worker.pool = this;
+    current_worker.index = index;
+    std::function<void()> task;
+    while (true) {
+        if (pop(index, task)) {
+            task();
+            task = nullptr;
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(idle_mutex_);
+        idle_.wait(lock, [this]() {
+            return stop_ || pending_.load(std::memory_order_acquire) > 0;
+        });
+        if (stop_ && pending_.load(std::memory_order_acquire) == 0) return;
+    }
+}
+
+void ThreadPool::parallel_for(size_t count, size_t grain,
+                              const std::function<void(size_t, size_t)>& body) {
+    if (count == 0) return;
+    grain = std::max<size_t>(grain, 1);
+    const size_t chunks = (count + grain - 1) / grain;
+    if (workers_.empty() || chunks == 1) {
+        for (size_t c = 0; c < chunks; ++c) {
+            body(c * grain, std::min(count, (c + 1) * grain));
+        }
+        return;
+    }
+    // Halve the chunk range, leaving the upper half for thieves, until a
+    // single chunk is left to run in place
+    TaskGroup group(*this);
+    std::function<void(size_t, size_t)> split = [&](size_t c0, size_t c1) {
+        while (c1 - c0 > 1) {
+            const size_t mid = c0 + (c1 - c0) / 2;
+            group.run([&split, mid, c1]() { split(mid, c1); });
+            c1 = mid;
+        }
+        body(c0 * grain, std::min(count, (c0 + 1) * grain));
+    };
+    group.run([&split, chunks]() { split(0, chunks); });
+    group.wait();
+}
+
+TaskGroup::~TaskGroup() {
+    join();
+}
+
+void TaskGroup::run(std::function<void()> task) {
+    outstanding_.fetch_add(1, std::memory_order_relaxed);
+    pool_.submit([this, task]() {
+        std::exception_ptr error;
+        try {
+            task();
+        } catch (...) {
+            error = std::current_exception();
+        }
+        // Last access to the group: join() takes the lock before returning,
+        // so the group outlives this scope
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (error && !error_) error_ = error;
+        if (outstanding_.fetch_sub(1, std::memory_order_release) == 1) done_.notify_all();
+    });
+}
+
+void TaskGroup::join() {
+    // Queued tasks may belong to the group; once none are left, the rest
+    // are running on other threads
+    while (outstanding_.load(std::memory_order_acquire) > 0 && pool_.run_one()) {
+    }
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_.wait(lock, [this]() { return outstanding_.load(std::memory_order_acquire) == 0; });
+}
+
+void TaskGroup::wait() {
+    join();
+    std::exception_ptr error;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::swap(error, error_);
+    }
+    if (error) std::rethrow_exception(error);
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+struct ThreadPoolConfig {
+    // Parallelism including the thread calling parallel_for()/wait(), so
+    // threads - 1 workers are started. 0 uses std::thread::hardware_concurrency.
+    unsigned threads = 0;
+    // Pin worker i to cpus[i % cpus.size()], or to CPU i + 1 when |cpus| is
+    // empty (the caller keeps CPU 0). Linux only, ignored elsewhere.
+    bool pin_threads = false;
+    std::vector<int> cpus;
+};
+
+// Work-stealing scheduler for the batch encode/decode entry points.
+//
+// Every worker owns a deque: it pushes and pops its own tasks at the back
+// and, when idle, steals from the front of the others' deques. Tasks
+// submitted from outside the pool go to a shared injection queue. Threads
+// waiting on a TaskGroup run queued tasks before blocking, so nested
+// parallel_for calls cannot deadlock.
+class ThreadPool {
+public:
+    explicit ThreadPool(const ThreadPoolConfig& config = ThreadPoolConfig());
+    explicit ThreadPool(unsigned threads);
+    ~ThreadPool();
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Parallelism including the calling thread
+    unsigned concurrency() const { return static_cast<unsigned>(workers_.size()) + 1; }
+
+    // Fire-and-forget task; prefer TaskGroup to wait on results
+    void submit(std::function<void()> task);
+
+    // Call body(begin, end) over [0, count) in chunks of |grain| items
+    // aligned on multiples of |grain| (chunk index = begin / grain) and wait
+    // for all of them. The first exception thrown by |body| is rethrown.
+    void parallel_for(size_t count, size_t grain,
+                      const std::function<void(size_t, size_t)>& body);
+
+    // Run one queued task on the calling thread; false when none was found
+    bool run_one();
+
+    // Process-wide pool sized to the hardware, created on first use
+    static ThreadPool& shared();
+
+private:
+    struct Worker {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+        std::thread thread;
+    };
+
+    void push(std::function<void()> task);
+    bool pop(int self, std::function<void()>& task);
+    void worker_loop(int index);
+    // Index of the calling thread among this pool's workers, -1 otherwise
+    int current_index() const;
+
+    std::vector<std::unique_ptr<Worker>> workers_;
+    std::mutex inject_mutex_;
+    std::deque<std::function<void()>> inject_;
+    std::atomic<size_t> pending_;
+    std::mutex idle_mutex_;
+    std::condition_variable idle_;
+    bool stop_;
+};
+
+// Set of tasks that can be waited on together. wait() runs pending tasks
+// of the pool while there are any, then sleeps until the last task of the
+// group signals it, and rethrows the first exception.
+class TaskGroup {
+public:
+    explicit TaskGroup(ThreadPool& pool) : pool_(pool), outstanding_(0) {}
+    ~TaskGroup();
+    TaskGroup(const TaskGroup&) = delete;
+    TaskGroup& operator=(const TaskGroup&) = delete;
+
+    void run(std::function<void()> task);
+    void wait();
+
+private:
+    // Help, then block until outstanding_ drops to 0
+    void join();
+
+    ThreadPool& pool_;
+    std::atomic<size_t> outstanding_;
+    std::mutex mutex_;
+    std::condition_variable done_;
+    std::exception_ptr error_;
+};
@@ -0,0 +1,208 @@
+#include "klv_trace.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+std::atomic<bool> KLVTrace::enabled_(false);
+
+namespace {
+
+struct TraceEvent {
+    const char* name;
+    const char* arg_name;
+    int64_t arg;
+    uint64_t start_ns;
+    uint64_t duration_ns;
+    uint32_t tid;
+};
+
+// Bumped by start(). Each thread empties its own buffer on its first event
+// of a new session, so start() never writes to a buffer being appended to.
+std::atomic<uint64_t> current_session(0);
+
+// Written by its owning thread only; readers see [0, count) when |session|
+// is the current one
+struct ThreadBuffer {
+    explicit ThreadBuffer(uint32_t id)
+        : events(new TraceEvent[KLVTrace::THREAD_CAPACITY]), count(0), dropped(0),
+          session(0), tid(id) {}
+
+    std::unique_ptr<TraceEvent[]> events;
+    std::atomic<size_t> count;
+    std::atomic<uint64_t> dropped;
+    std::atomic<uint64_t> session;
+    uint32_t tid;
+};
+
+// Events and drops of |buffer| in the current session
+size_t live_count(const ThreadBuffer& buffer) {
+    if (buffer.session.load(std::memory_order_acquire) != current_session.load(std::memory_order_relaxed)) {
+        return 0;
+    }
+    return buffer.count.load(std::memory_order_acquire);
+}
+
+uint64_t live_dropped(const ThreadBuffer& buffer) {
+    if (buffer.session.load(std::memory_order_acquire) != current_session.load(std::memory_order_relaxed)) {
+        return 0;
+    }
+    return buffer.dropped.load(std::memory_order_relaxed);
+}
+
+// Live thread buffers and the events of exited threads
+struct Registry {
+    Registry() : origin_ns(0), next_tid(1), retired_dropped(0) {}
+
+    std::mutex mutex;
+    std::vector<ThreadBuffer*> buffers;
+    std::vector<TraceEvent> retired;
+    uint64_t origin_ns;
+    uint32_t next_tid;
+    uint64_t retired_dropped;
+};
+
+Registry& registry() {
+    // Leaked so that threads exiting during static destruction can retire
+    static Registry* r = new Registry();
+    return *r;
+}
+
+struct ThreadHolder {
+    ThreadHolder() {
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        buffer = new ThreadBuffer(r.next_tid++);
+        r.buffers.push_back(buffer);
+    }
+    ~ThreadHolder() {
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        const size_t n = live_count(*buffer);
+        r.retired.insert(r.retired.end(), buffer->events.get(), buffer->events.get() + n);
+        r.retired_dropped += live_dropped(*buffer);
+        r.buffers.erase(std::find(r.buffers.begin(), r.buffers.end(), buffer));
+        delete buffer;
+    }
+    ThreadBuffer* buffer;
+};
+
+ThreadBuffer& local_buffer() {
+    thread_local ThreadHolder holder;
+    return *holder.buffer;
+}
+
+void append_json_string(std::string& out, const char* text) {
+    out += '"';
+    for (const char* p = text; *p; ++p) {
+        if (*p == '"' || *p == '\\') out += '\\';
+        out += *p;
+    }
+    out += '"';
+}
+
+} // namespace
+
+void KLVTrace::start() {
+    Registry& r = registry();
+    {
+        // Readers hold the lock, so they see either session whole
+        std::lock_guard<std::mutex> lock(r.mutex);
+        current_session.fetch_add(1, std::memory_order_release);
+        r.retired.clear();
+        r.retired_dropped = 0;
+        r.origin_ns = now_ns();
+    }
+    enabled_.store(true, std::memory_order_release);
+}
+
+void KLVTrace::stop() {
+    enabled_.store(false, std::memory_order_release);
+}
+
+void KLVTrace::record(const char* name, const char* arg_name, int64_t arg,
+                      uint64_t start_ns, uint64_t duration_ns) {
+    ThreadBuffer& buffer = local_buffer();
+    const uint64_t session = current_session.load(std::memory_order_acquire);
+    if (buffer.session.load(std::memory_order_relaxed) != session) {
+        // Events of an earlier session; published only with the new id
+        buffer.count.store(0, std::memory_order_relaxed);
+        buffer.dropped.store(0, std::memory_order_relaxed);
+        buffer.session.store(session, std::memory_order_release);
+    }
+    const size_t n = buffer.count.load(std::memory_order_relaxed);
+    if (n == THREAD_CAPACITY) {
+        buffer.dropped.store(buffer.dropped.load(std::memory_order_relaxed) + 1,
+                             std::memory_order_relaxed);
+        return;
+    }
+    buffer.events[n] = TraceEvent{name, arg_name, arg, start_ns, duration_ns, buffer.tid};
+    buffer.count.store(n + 1, std::memory_order_release);
+}
+
+size_t KLVTrace::event_count() {
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    size_t n = r.retired.size();
+    for (const ThreadBuffer* buffer : r.buffers) n += live_count(*buffer);
+    return n;
+}
+
+uint64_t KLVTrace::dropped() {
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    uint64_t n = r.retired_dropped;
+    for (const ThreadBuffer* buffer : r.buffers) n += live_dropped(*buffer);
+    return n;
+}
+
+std::string KLVTrace::to_json() {
+    std::vector<TraceEvent> events;
+    uint64_t origin = 0;
+    {
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        events = r.retired;
+        for (const ThreadBuffer* buffer : r.buffers) {
+            const size_t n = live_count(*buffer);
+            events.insert(events.end(), buffer->events.get(), buffer->events.get() + n);
+        }
+        origin = r.origin_ns;
+    }
+    std::sort(events.begin(), events.end(), [](const TraceEvent& a, const TraceEvent& b) {
+        return a.tid != b.tid ? a.tid < b.tid : a.start_ns < b.start_ns;
+    });
+
+    std::string out = "{\"traceEvents\":[";
+    char number[96];
+    for (size_t i = 0; i < events.size(); ++i) {
+        const TraceEvent& e = events[i];
+        out += i ? ",\n{\"name\":" : "\n{\"name\":";
+        append_json_string(out, e.name);
+        const uint64_t start = e.start_ns > origin ? e.start_ns - origin : 0;
+        std::snprintf(number, sizeof(number),
+                      ",\"cat\":\"klv\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f",
+                      static_cast<unsigned>(e.tid), start / 1000.0, e.duration_ns / 1000.0);
+        out += number;
+        if (e.arg_name) {
+            out += ",\"args\":{";
+            append_json_string(out, e.arg_name);
+            std::snprintf(number, sizeof(number), ":%lld}", static_cast<long long>(e.arg));
+            out += number;
+        }
+        out += '}';
+    }
+    out += "\n],\"displayTimeUnit\":\"ns\"}\n";
+    return out;
+}
+
+bool KLVTrace::write_json(const std::string& path) {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file) return false;
+    const std::string json = to_json();
+    file.write(json.data(), static_cast<std::streamsize>(json.size()));
+    return static_cast<bool>(file);
+}
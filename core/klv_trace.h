@@ -0,0 +1,85 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Scoped trace spans dumped as Chrome trace-event JSON (chrome://tracing,
+// ui.perfetto.dev).
+//
+// Spans are recorded only between KLVTrace::start() and stop(); otherwise a
+// span costs one relaxed load. Each thread appends complete events to its
+// own fixed-size buffer, allocated on its first event, and publishes them
+// with a release store of the count, so recording takes no lock. Events past
+// THREAD_CAPACITY are dropped and counted. Building with KLV_TRACE=0 (CMake
+// option KLV_TRACE=OFF) removes the spans altogether.
+
+#ifndef KLV_TRACE
+#define KLV_TRACE 1
+#endif
+
+class KLVTrace {
+public:
+    static constexpr size_t THREAD_CAPACITY = size_t{1} << 16;
+
+    // Discard previous events and start recording. Safe while other
+    // threads record: each one drops its own previous events on its first
+    // span of the new session.
+    static void start();
+    static void stop();
+    static bool enabled() { return enabled_.load(std::memory_order_relaxed); }
+
+    // Events recorded since start(), exited threads included
+    static size_t event_count();
+    static uint64_t dropped();
+
+    // {"traceEvents": [...]} with one "X" event per span, timestamps in
+    // microseconds since start(). May be called while recording.
+    static std::string to_json();
+    static bool write_json(const std::string& path);
+
+    static void record(const char* name, const char* arg_name, int64_t arg,
+                       uint64_t start_ns, uint64_t duration_ns);
+
+    static uint64_t now_ns() {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+private:
+    static std::atomic<bool> enabled_;
+};
+
+// Records the lifetime of the scope as one span. |name| and |arg_name| must
+// outlive the trace (string literals).
+class KLVTraceSpan {
+public:
+    explicit KLVTraceSpan(const char* name, const char* arg_name = nullptr, int64_t arg = 0)
+        : name_(KLVTrace::enabled() ? name : nullptr), arg_name_(arg_name), arg_(arg),
+          start_(name_ ? KLVTrace::now_ns() : 0) {}
+    ~KLVTraceSpan() {
+        if (name_) KLVTrace::record(name_, arg_name_, arg_, start_, KLVTrace::now_ns() - start_);
+    }
+    KLVTraceSpan(const KLVTraceSpan&) = delete;
+    KLVTraceSpan& operator=(const KLVTraceSpan&) = delete;
+
+private:
+    const char* name_;
+    const char* arg_name_;
+    int64_t arg_;
+    uint64_t start_;
+};
+
+#define KLV_TRACE_CONCAT_(a, b) a##b
+#define KLV_TRACE_CONCAT(a, b) KLV_TRACE_CONCAT_(a, b)
+
+#if KLV_TRACE
+#define KLV_TRACE_SPAN(name) KLVTraceSpan KLV_TRACE_CONCAT(klv_trace_span_, __LINE__)(name)
+#define KLV_TRACE_SPAN_ARG(name, arg_name, arg) \
+    KLVTraceSpan KLV_TRACE_CONCAT(klv_trace_span_, __LINE__)(name, arg_name, static_cast<int64_t>(arg))
+#else
+#define KLV_TRACE_SPAN(name) ((void)0)
+#define KLV_TRACE_SPAN_ARG(name, arg_name, arg) ((void)0)
+#endif
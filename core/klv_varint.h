@@ -0,0 +1,154 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+// Non-allocating encode/decode primitives shared by every standard module:
+// BER lengths, BER-OID integers and big-endian unsigned integers of 1..8
+// bytes. Writers take a destination capacity and return the number of bytes
+// written (0 when it does not fit); readers return the number of bytes
+// consumed (0 on malformed or truncated input).
+
+namespace misb {
+
+namespace detail {
+
+inline unsigned clz64(uint64_t v) {
+    // Caller guarantees v != 0
+#if defined(__GNUC__) || defined(__clang__)
+    return static_cast<unsigned>(__builtin_clzll(v));
+#elif defined(_MSC_VER) && defined(_M_X64)
+    unsigned long index;
+    _BitScanReverse64(&index, v);
+    return 63u - static_cast<unsigned>(index);
+#else
+    unsigned n = 0;
+    while ((v & (uint64_t{1} << 63)) == 0) {
+        v <<= 1;
+        ++n;
+    }
+    return n;
+#endif
+}
+
+inline uint64_t bswap64(uint64_t v) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_bswap64(v);
+#elif defined(_MSC_VER)
+    return _byteswap_uint64(v);
+#else
+    v = ((v & 0x00000000FFFFFFFFull) << 32) | (v >> 32);
+    v = ((v & 0x0000FFFF0000FFFFull) << 16) | ((v & 0xFFFF0000FFFF0000ull) >> 16);
+    v = ((v & 0x00FF00FF00FF00FFull) << 8) | ((v & 0xFF00FF00FF00FF00ull) >> 8);
+    return v;
+#endif
+}
+
+inline uint64_t to_big_endian(uint64_t v) {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    return v;
+#else
+    return bswap64(v);
+#endif
+}
+
+} // namespace detail
+
+// Minimal number of bytes (1..8) holding |v|
+inline size_t uint_byte_width(uint64_t v) {
+    return v == 0 ? 1 : 8 - detail::clz64(v) / 8;
+}
+
+// Big-endian store of the low |width| bytes of |v| (width 1..8)
+inline size_t write_uint_be(uint8_t* dst, size_t cap, uint64_t v, size_t width) {
+    if (width == 0 || width > 8 || cap < width) return 0;
+    const uint64_t be = detail::to_big_endian(v);
+    std::memcpy(dst, reinterpret_cast<const uint8_t*>(&be) + (8 - width), width);
+    return width;
+}
+
+// Big-endian load of |width| bytes (1..8)
+inline size_t read_uint_be(const uint8_t* src, size_t size, size_t width, uint64_t& v) {
+    if (width == 0 || width > 8 || size < width) return 0;
+    uint64_t be = 0;
+    std::memcpy(reinterpret_cast<uint8_t*>(&be) + (8 - width), src, width);
+    v = detail::to_big_endian(be);
+    return width;
+}
+
+// Sign-extend the low |width| bytes of |v|
+inline int64_t sign_extend(uint64_t v, size_t width) {
+    if (width >= 8) return static_cast<int64_t>(v);
+    const uint64_t sign = uint64_t{1} << (width * 8 - 1);
+    return static_cast<int64_t>((v ^ sign) - sign);
+}
+
+// Encoded size of a BER length: short form below 128, long form otherwise
+inline size_t ber_length_size(uint64_t len) {
+    return len < 0x80 ? 1 : 1 + uint_byte_width(len);
+}
+
+inline size_t write_ber_length(uint8_t* dst, size_t cap, uint64_t len) {
+    if (len < 0x80) {
+        if (cap < 1) return 0;
+        dst[0] = static_cast<uint8_t>(len);
+        return 1;
+    }
+    const size_t width = uint_byte_width(len);
+    if (cap < 1 + width) return 0;
+    dst[0] = static_cast<uint8_t>(0x80u | width);
+    return 1 + write_uint_be(dst + 1, cap - 1, len, width);
+}
+
+// Rejects the indefinite form (0x80) and lengths wider than size_t
+inline size_t read_ber_length(const uint8_t* src, size_t size, size_t& len) {
+    if (size == 0) return 0;
+    const uint8_t first = src[0];
+    if ((first & 0x80u) == 0) {
+        len = first;
+        return 1;
+    }
+    const size_t count = first & 0x7Fu;
+    if (count == 0 || count > sizeof(size_t) || size - 1 < count) return 0;
+    uint64_t v = 0;
+    read_uint_be(src + 1, size - 1, count, v);
+    len = static_cast<size_t>(v);
+    return 1 + count;
+}
+
+// BER-OID: 7 bits per byte, most significant group first, high bit set on
+// every byte but the last
+inline size_t ber_oid_size(uint64_t v) {
+    return v == 0 ? 1 : (64 - detail::clz64(v) + 6) / 7;
+}
+
+inline size_t write_ber_oid(uint8_t* dst, size_t cap, uint64_t v) {
+    const size_t n = ber_oid_size(v);
+    if (cap < n) return 0;
+    for (size_t i = n; i-- > 0;) {
+        dst[i] = static_cast<uint8_t>((v & 0x7Fu) | (i + 1 == n ? 0u : 0x80u));
+        v >>= 7;
+    }
+    return n;
+}
+
+// Rejects unterminated values and values overflowing 64 bits
+inline size_t read_ber_oid(const uint8_t* src, size_t size, uint64_t& v) {
+    uint64_t value = 0;
+    const size_t limit = size < 10 ? size : 10;
+    for (size_t i = 0; i < limit; ++i) {
+        if (value >> 57) return 0;
+        value = (value << 7) | static_cast<uint64_t>(src[i] & 0x7Fu);
+        if ((src[i] & 0x80u) == 0) {
+            v = value;
+            return i + 1;
+        }
+    }
+    return 0;
+}
+
+} // namespace misb
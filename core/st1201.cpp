@@ -0,0 +1,134 @@
+#include "st1201.h"
+#include "klv_varint.h"
+
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+namespace misb {
+namespace st1201 {
+
+namespace {
+
+uint64_t special_raw(uint8_t first, size_t length) {
+    return static_cast<uint64_t>(first) << (8 * (length - 1));
+}
+
+} // namespace
+
+Imap imapb(double min, double max, size_t length) {
+    if (!(max > min) || !std::isfinite(max - min)) {
+        throw std::invalid_argument("IMAP range must satisfy min < max");
+    }
+    if (length == 0 || length > 8) {
+        throw std::invalid_argument("IMAP length must be within 1..8");
+    }
+    Imap m;
+    m.min = min;
+    m.max = max;
+    m.length = length;
+    m.b_pow = static_cast<int>(std::ceil(std::log2(max - min)));
+    m.d_pow = static_cast<int>(8 * length) - 1;
+    m.forward = std::ldexp(1.0, m.d_pow - m.b_pow);
+    m.reverse = std::ldexp(1.0, m.b_pow - m.d_pow);
+    m.z_offset = 0.0;
+    if (min < 0.0 && max > 0.0) {
+        m.z_offset = m.forward * min - std::floor(m.forward * min);
+    }
+    const double top = std::floor(m.forward * (max - min) + m.z_offset);
+    const uint64_t limit = uint64_t{1} << m.d_pow;
+    m.max_raw = top >= static_cast<double>(limit) ? limit : static_cast<uint64_t>(top);
+    return m;
+}
+
+Imap imapa(double min, double max, double precision) {
+    if (!(precision > 0.0)) {
+        throw std::invalid_argument("IMAP precision must be positive");
+    }
+    if (!(max > min)) {
+        throw std::invalid_argument("IMAP range must satisfy min < max");
+    }
+    const double b_pow = std::ceil(std::log2(max - min));
+    const double p_pow = std::floor(std::log2(precision));
+    double length = std::ceil((b_pow - p_pow + 1.0) / 8.0);
+    if (length < 1.0) length = 1.0;
+    if (length > 8.0) length = 8.0;
+    return imapb(min, max, static_cast<size_t>(length));
+}
+
+uint64_t to_raw(const Imap& imap, double value) {
+    if (std::isnan(value)) {
+        return special_raw(std::signbit(value) ? NEGATIVE_QUIET_NAN : POSITIVE_QUIET_NAN,
+                           imap.length);
+    }
+    if (std::isinf(value)) {
+        return special_raw(value > 0.0 ? POSITIVE_INFINITY : NEGATIVE_INFINITY, imap.length);
+    }
+    const double clamped = value < imap.min ? imap.min : (value > imap.max ? imap.max : value);
+    const double y = std::floor(imap.forward * (clamped - imap.min) + imap.z_offset);
+    if (y <= 0.0) return 0;
+    const uint64_t raw = static_cast<uint64_t>(y);
+    return raw > imap.max_raw ? imap.max_raw : raw;
+}
+
+double from_raw(const Imap& imap, uint64_t raw) {
+    if (raw > imap.max_raw && (raw >> imap.d_pow) != 0) {
+        switch (static_cast<uint8_t>(raw >> (8 * (imap.length - 1)))) {
+        case POSITIVE_INFINITY:
+            return std::numeric_limits<double>::infinity();
+        case NEGATIVE_INFINITY:
+            return -std::numeric_limits<double>::infinity();
+        default:
+            // NaN flavours, reserved and user defined values
+            return std::numeric_limits<double>::quiet_NaN();
+        }
+    }
+    return imap.reverse * (static_cast<double>(raw) - imap.z_offset) + imap.min;
+}
+
+size_t encode(const Imap& imap, double value, uint8_t* dst, size_t cap) {
+    return write_uint_be(dst, cap, to_raw(imap, value), imap.length);
+}
+
+std::vector<uint8_t> encode(const Imap& imap, double value) {
+    std::vector<uint8_t> bytes(imap.length);
+    encode(imap, value, bytes.data(), bytes.size());
+    return bytes;
+}
+
+double decode(const Imap& imap, const uint8_t* src, size_t size) {
+    if (size == 0 || size > 8) return std::numeric_limits<double>::quiet_NaN();
+    uint64_t raw = 0;
+    read_uint_be(src, size, size, raw);
+    if (size == imap.length) return from_raw(imap, raw);
+    return from_raw(imapb(imap.min, imap.max, size), raw);
+}
+
+double decode(const Imap& imap, const std::vector<uint8_t>& bytes) {
+    return decode(imap, bytes.data(), bytes.size());
+}
+
+size_t encode_array(const Imap& imap, const double* values, size_t count,
+                    uint8_t* dst, size_t cap) {
+    const size_t total = count * imap.length;
+    if (cap < total) return 0;
+    for (size_t i = 0; i < count; ++i) {
+        write_uint_be(dst + i * imap.length, imap.length, to_raw(imap, values[i]), imap.length);
+    }
+    return total;
+}
+
+size_t decode_array(const Imap& imap, const uint8_t* src, size_t size,
+                    double* out, size_t count) {
+    const size_t total = count * imap.length;
+    if (size < total) return 0;
+    for (size_t i = 0; i < count; ++i) {
+        uint64_t raw = 0;
+        read_uint_be(src + i * imap.length, imap.length, imap.length, raw);
+        out[i] = from_raw(imap, raw);
+    }
+    return total;
+}
+
+} // namespace st1201
+} // namespace misb
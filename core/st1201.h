@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace misb {
+namespace st1201 {
+
+// MISB ST 1201 floating point to integer mapping (IMAP).
+//
+// A field is described once by its range and either its length (IMAPB) or
+// its precision (IMAPA). The descriptor keeps the derived constants so the
+// per-value work is a multiply, an add and a floor. Values above the
+// integer range reserved for ordinary numbers carry the special values:
+// +/- infinity and NaN.
+struct Imap {
+    double min;
+    double max;
+    size_t length;     // bytes, 1..8
+    int b_pow;         // ceil(log2(max - min))
+    int d_pow;         // 8 * length - 1
+    double forward;    // sF = 2^(d_pow - b_pow)
+    double reverse;    // sR = 2^(b_pow - d_pow)
+    double z_offset;   // keeps zero exactly representable when min < 0 < max
+    uint64_t max_raw;  // integer encoding |max|
+};
+
+// First byte of the special value encodings
+constexpr uint8_t POSITIVE_INFINITY = 0xC8;
+constexpr uint8_t NEGATIVE_INFINITY = 0xE8;
+constexpr uint8_t POSITIVE_QUIET_NAN = 0xD0;
+constexpr uint8_t NEGATIVE_QUIET_NAN = 0xF0;
+constexpr uint8_t POSITIVE_SIGNAL_NAN = 0xD8;
+constexpr uint8_t NEGATIVE_SIGNAL_NAN = 0xF8;
+
+// IMAPB(min, max, length). Throws std::invalid_argument on an empty range or
+// a length outside 1..8.
+Imap imapb(double min, double max, size_t length);
+
+// IMAPA(min, max, precision): the shortest length resolving |precision|
+Imap imapa(double min, double max, double precision);
+
+// Integer mapping of |value|. Finite values are clamped to [min, max].
+uint64_t to_raw(const Imap& imap, double value);
+
+// Inverse of to_raw for a |length|-byte integer encoded with |imap|
+double from_raw(const Imap& imap, uint64_t raw);
+
+// Scalar encode into |dst|; returns imap.length or 0 when it does not fit
+size_t encode(const Imap& imap, double value, uint8_t* dst, size_t cap);
+std::vector<uint8_t> encode(const Imap& imap, double value);
+
+// Scalar decode. The parameters are derived from |size| as ST 1201
+// requires, so a value sent with a different length than the descriptor's
+// still decodes. NaN when |size| is 0 or above 8.
+double decode(const Imap& imap, const uint8_t* src, size_t size);
+double decode(const Imap& imap, const std::vector<uint8_t>& bytes);
+
+// Array forms: |count| values of imap.length bytes each, packed back to
+// back. Return the number of bytes written or consumed, 0 when the buffer
+// is too small.
+size_t encode_array(const Imap& imap, const double* values, size_t count,
+                    uint8_t* dst, size_t cap);
+size_t decode_array(const Imap& imap, const uint8_t* src, size_t size,
+                    double* out, size_t count);
+
+} // namespace st1201
+} // namespace misb
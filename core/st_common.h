@@ -5,6 +5,7 @@
 #include <type_traits>
 #include <cstddef>
 #include "klv_types.h"
+#include "klv_varint.h"
 
 namespace misb {
 
@@ -42,20 +43,9 @@ inline bool unpack_be(const std::vector<uint8_t>& bytes, T& out) {
 
 // Encode a BER length field.
 inline std::vector<uint8_t> encode_ber_length(size_t length) {
-    if (length < 0x80) {
-        return {static_cast<uint8_t>(length)};
-    }
-    std::vector<uint8_t> bytes;
-    while (length > 0) {
-        bytes.push_back(static_cast<uint8_t>(length & 0xFF));
-        length >>= 8;
-    }
-    std::vector<uint8_t> out;
-    out.push_back(static_cast<uint8_t>(0x80 | bytes.size()));
-    for (auto it = bytes.rbegin(); it != bytes.rend(); ++it) {
-        out.push_back(*it);
-    }
-    return out;
+    uint8_t buf[1 + sizeof(uint64_t)];
+    const size_t n = write_ber_length(buf, sizeof(buf), length);
+    return std::vector<uint8_t>(buf, buf + n);
 }
 
 // Decode a BER length field starting at offset. Returns false on error.
@@ -64,22 +54,51 @@ inline bool decode_ber_length(const std::vector<uint8_t>& data,
                               size_t& length,
                               size_t& len_bytes) {
     if (offset >= data.size()) return false;
-    uint8_t first = data[offset];
-    if ((first & 0x80) == 0) {
-        length = first;
-        len_bytes = 1;
-        return true;
-    }
-    size_t count = first & 0x7F;
-    if (offset + 1 + count > data.size()) return false;
-    length = 0;
-    for (size_t i = 0; i < count; ++i) {
-        length = (length << 8) | data[offset + 1 + i];
-    }
-    len_bytes = 1 + count;
+    const size_t n = read_ber_length(data.data() + offset, data.size() - offset, length);
+    if (n == 0) return false;
+    len_bytes = n;
     return true;
 }
 
+// Pointer-based variant of decode_ber_length for callers working on raw
+// buffers (memory-mapped archives, datagrams).
+inline bool decode_ber_length(const uint8_t* data,
+                              size_t size,
+                              size_t offset,
+                              size_t& length,
+                              size_t& len_bytes) {
+    if (offset >= size) return false;
+    const size_t n = read_ber_length(data + offset, size - offset, length);
+    if (n == 0) return false;
+    len_bytes = n;
+    return true;
+}
+
+// Locate a single-byte tag inside a Tag-Length-Value payload by skipping
+// items with their BER lengths. On success |value_offset| and |value_length|
+// describe the value relative to |data|.
+inline bool find_local_tag(const uint8_t* data,
+                           size_t size,
+                           uint8_t tag,
+                           size_t& value_offset,
+                           size_t& value_length) {
+    size_t i = 0;
+    while (i < size) {
+        const uint8_t key = data[i++];
+        size_t len = 0, len_bytes = 0;
+        if (!decode_ber_length(data, size, i, len, len_bytes)) return false;
+        i += len_bytes;
+        if (len > size - i) return false;
+        if (key == tag) {
+            value_offset = i;
+            value_length = len;
+            return true;
+        }
+        i += len;
+    }
+    return false;
+}
+
 // Compute 16-bit word-sum checksum (used for ST 0601 tag 1)
 inline uint16_t klv_checksum_16(const std::vector<uint8_t>& data) {
     uint16_t sum = 0;
@@ -91,4 +110,15 @@ inline uint16_t klv_checksum_16(const std::vector<uint8_t>& data) {
     return sum;
 }
 
+// Incremental form over a stream split in pieces: |position| is the offset
+// of |data| in the stream and |sum| the checksum of everything before it
+inline uint16_t klv_checksum_16(uint16_t sum, const uint8_t* data, size_t size, size_t position) {
+    for (size_t i = 0; i < size; ++i) {
+        sum = (sum +
+               (static_cast<uint16_t>(data[i]) << (8 * ((position + i + 1) % 2)))) &
+              0xFFFF;
+    }
+    return sum;
+}
+
 } // namespace misb
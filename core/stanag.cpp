@@ -1,11 +1,132 @@
 #include "stanag.h"
+#include "klv_metrics.h"
+#include "klv_trace.h"
 #include "st_common.h"
 #include "st0601.h"
 #include <algorithm>
+#include <cstring>
 #include <memory>
+#include <stdexcept>
 
 namespace stanag {
 
+namespace {
+
+// True when a full packet key starts in [from, size)
+bool key_after(const uint8_t* data, size_t size, size_t from) {
+    const size_t key_len = UAS_DATALINK_LOCAL_SET_UL.size();
+    for (size_t i = from; i + key_len <= size; ++i) {
+        const void* hit = std::memchr(data + i, UAS_DATALINK_LOCAL_SET_UL[0], size - key_len + 1 - i);
+        if (!hit) return false;
+        i = static_cast<size_t>(static_cast<const uint8_t*>(hit) - data);
+        if (std::memcmp(data + i, UAS_DATALINK_LOCAL_SET_UL.data(), key_len) == 0) return true;
+    }
+    return false;
+}
+
+// find_next_packet without instrumentation, so that decoding a packet the
+// caller already framed does not count it twice. Keys followed by a
+// malformed BER length are skipped and counted in |bad_lengths|. A length
+// running past the buffer is a false sync hit or a truncated packet when
+// another key follows, and is skipped too; on the last key it is an
+// incomplete packet the stream has yet to deliver.
+bool locate_packet(const uint8_t* data, size_t size, size_t from, PacketView& out,
+                   size_t& bad_lengths) {
+    const size_t key_len = UAS_DATALINK_LOCAL_SET_UL.size();
+    size_t i = from;
+    while (i + key_len < size) {
+        const void* hit = std::memchr(data + i, UAS_DATALINK_LOCAL_SET_UL[0], size - key_len - i);
+        if (!hit) return false;
+        i = static_cast<size_t>(static_cast<const uint8_t*>(hit) - data);
+        if (std::memcmp(data + i, UAS_DATALINK_LOCAL_SET_UL.data(), key_len) != 0) {
+            ++i;
+            continue;
+        }
+        size_t len = 0, len_bytes = 0;
+        if (!misb::decode_ber_length(data, size, i + key_len, len, len_bytes)) {
+            ++bad_lengths;
+            ++i;
+            continue;
+        }
+        const size_t payload = i + key_len + len_bytes;
+        if (len > size - payload) {
+            if (!key_after(data, size, i + 1)) return false;
+            ++i;
+            continue;
+        }
+        out.offset = i;
+        out.length = key_len + len_bytes + len;
+        out.payload_offset = payload;
+        out.payload_length = len;
+        return true;
+    }
+    return false;
+}
+
+} // namespace
+
+bool find_next_packet(const uint8_t* data, size_t size, size_t from, PacketView& out) {
+    KLV_METRIC_STAGE(Framing);
+    KLV_TRACE_SPAN("stanag::find_next_packet");
+    size_t bad_lengths = 0;
+    const bool found = locate_packet(data, size, from, out, bad_lengths);
+    if (bad_lengths) KLV_METRIC_ADD(ErrorBerLength, bad_lengths);
+    if (found) {
+        KLV_METRIC_ADD(PacketsFramed, 1);
+        KLV_METRIC_ADD(BytesFramed, out.length);
+    }
+    return found;
+}
+
+bool verify_packet_checksum(const uint8_t* packet, size_t length) {
+    // Checksum item: tag 1, length 2, two bytes
+    if (length < UAS_DATALINK_LOCAL_SET_UL.size() + 1 + 4) return false;
+    const uint8_t* crc_item = packet + length - 4;
+    if (crc_item[0] != 0x01 || crc_item[1] != 0x02) return false;
+    const uint16_t expected = static_cast<uint16_t>((crc_item[2] << 8) | crc_item[3]);
+    if (misb::klv_checksum_16(0, packet, length - 2, 0) != expected) {
+        KLV_METRIC_ADD(ErrorChecksum, 1);
+        return false;
+    }
+    return true;
+}
+
+bool decode_stanag4609_packet(const ByteSlice& packet, KLVSet& out) {
+    KLV_TRACE_SPAN("stanag::decode_packet");
+    PacketView view;
+    size_t bad_lengths = 0;
+    if (!locate_packet(packet.data(), packet.size(), 0, view, bad_lengths) || view.offset != 0 ||
+        view.length != packet.size() || view.payload_length < 4) {
+        return false;
+    }
+    if (!verify_packet_checksum(packet.data(), packet.size())) return false;
+    KLVSet decoded(false, misb::st0601::ST_ID);
+    try {
+        decoded.decode(packet.slice(view.payload_offset, view.payload_length - 4));
+    } catch (const std::exception&) {
+        return false;
+    }
+    out = std::move(decoded);
+    return true;
+}
+
+PacketFramer::PacketFramer(size_t max_pending)
+    : max_pending_(max_pending), discarded_(0) {}
+
+size_t PacketFramer::tail_start(const uint8_t* data, size_t size, size_t from) {
+    // find_next_packet stopped either on an incomplete packet or for lack
+    // of a key: keep from the first key, or a possible partial key
+    const size_t key_len = UAS_DATALINK_LOCAL_SET_UL.size();
+    for (size_t i = from; i < size; ++i) {
+        const void* hit = std::memchr(data + i, UAS_DATALINK_LOCAL_SET_UL[0], size - i);
+        if (!hit) return size;
+        i = static_cast<size_t>(static_cast<const uint8_t*>(hit) - data);
+        const size_t n = std::min(key_len, size - i);
+        if (std::memcmp(data + i, UAS_DATALINK_LOCAL_SET_UL.data(), n) == 0) return i;
+    }
+    return size;
+}
+
 KLVSet create_dataset(const std::vector<TagValue>& tags, bool use_ul) {
     uint8_t st_id = 0;
     if (!tags.empty()) st_id = tags[0].ul[12];
@@ -28,7 +149,66 @@ KLVSet create_dataset(const std::vector<TagValue>& tags, bool use_ul) {
     return set;
 }
 
+namespace {
+
+void append_item_header(SegmentList& out, const UL& ul, size_t length) {
+    uint8_t header[10];
+    header[0] = ul[15];
+    const size_t len_size = misb::write_ber_length(header + 1, sizeof(header) - 1, length);
+    out.append(header, 1 + len_size);
+}
+
+} // namespace
+
+SegmentList create_stanag4609_segments(const std::vector<TagValue>& tags) {
+    KLV_TRACE_SPAN("stanag::create_segments");
+    SegmentList payload;
+    for (const auto& t : tags) {
+        switch (t.kind) {
+        case TagValue::Kind::Numeric:
+            KLVLeaf(t.ul, t.value, true).encode_segments(payload);
+            break;
+        case TagValue::Kind::Dataset:
+            if (t.set) {
+                SegmentList nested;
+                t.set->encode_segments(nested);
+                append_item_header(payload, t.ul, nested.size());
+                payload.append(nested);
+            }
+            break;
+        case TagValue::Kind::Bytes:
+            append_item_header(payload, t.ul, t.bytes.size());
+            payload.append(ByteSlice::borrow(t.bytes));
+            break;
+        }
+    }
+
+    SegmentList out;
+    uint8_t header[32];
+    std::copy(UAS_DATALINK_LOCAL_SET_UL.begin(), UAS_DATALINK_LOCAL_SET_UL.end(), header);
+    const size_t header_size = UAS_DATALINK_LOCAL_SET_UL.size() +
+        misb::write_ber_length(header + 16, sizeof(header) - 16, payload.size() + 4);
+    out.append(header, header_size);
+    out.append(payload);
+    out.append(uint8_t{0x01});
+    out.append(uint8_t{0x02});
+
+    // Checksum over every segment so far
+    uint16_t crc = 0;
+    size_t position = 0;
+    for (size_t i = 0; i < out.segment_count(); ++i) {
+        const SegmentList::Segment seg = out.segment(i);
+        crc = misb::klv_checksum_16(crc, seg.data, seg.size, position);
+        position += seg.size;
+    }
+    const uint8_t crc_bytes[2] = {static_cast<uint8_t>(crc >> 8), static_cast<uint8_t>(crc & 0xFF)};
+    out.append(crc_bytes, 2);
+    return out;
+}
+
 std::vector<uint8_t> create_stanag4609_packet(const std::vector<TagValue>& tags) {
+    KLV_METRIC_STAGE(PacketEncode);
+    KLV_TRACE_SPAN("stanag::create_packet");
     // Build payload without checksum
     KLVSet payload_set = create_dataset(tags, false);
     auto payload = payload_set.encode();
@@ -52,9 +232,23 @@ std::vector<uint8_t> create_stanag4609_packet(const std::vector<TagValue>& tags)
     out.push_back(static_cast<uint8_t>((crc >> 8) & 0xFF));
     out.push_back(static_cast<uint8_t>(crc & 0xFF));
 
+    KLV_METRIC_ADD(PacketsEncoded, 1);
+    KLV_METRIC_ADD(BytesEncoded, out.size());
     return out;
 }
 
+std::vector<std::vector<uint8_t>> create_stanag4609_packets(
+    const std::vector<std::vector<TagValue>>& feeds, ThreadPool& pool) {
+    KLV_TRACE_SPAN_ARG("stanag::create_packets", "feeds", feeds.size());
+    std::vector<std::vector<uint8_t>> packets(feeds.size());
+    pool.parallel_for(feeds.size(), 16, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            packets[i] = create_stanag4609_packet(feeds[i]);
+        }
+    });
+    return packets;
+}
+
 CompositeBuilder& CompositeBuilder::add_numeric(const UL& ul, double value) {
     tags_.emplace_back(ul, value);
     return *this;
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "klv.h"
+#include "klv_thread_pool.h"
 #include <cstring>
 #include <memory>
 #include <string>
@@ -59,11 +60,106 @@ private:
     }
 };
 
+// Location of one STANAG 4609 packet inside a larger buffer. Offsets are
+// relative to the start of the buffer; the payload includes the trailing
+// checksum item.
+struct PacketView {
+    size_t offset;
+    size_t length;
+    size_t payload_offset;
+    size_t payload_length;
+};
+
+// Find the next complete packet starting the UL search at |from|. Returns
+// false when no further complete packet exists in the buffer. A key whose
+// length overruns the buffer is skipped when another key follows it.
+bool find_next_packet(const uint8_t* data, size_t size, size_t from, PacketView& out);
+
+// True when |packet| (one complete packet, e.g. from find_next_packet) ends
+// with a checksum item matching its content
+bool verify_packet_checksum(const uint8_t* packet, size_t length);
+
+// Decode the local set of one complete packet into |out| (ST 0601 tags),
+// leaving out the checksum item. Unregistered items reference |packet|.
+// Returns false on a malformed packet or checksum mismatch.
+bool decode_stanag4609_packet(const ByteSlice& packet, KLVSet& out);
+
+// Reassembles STANAG 4609 packets from a byte stream delivered in arbitrary
+// pieces (datagrams, file reads). Bytes before a packet key are skipped; an
+// incomplete packet is kept until the next push. The pending data is capped
+// at |max_pending| bytes, beyond which it is discarded.
+class PacketFramer {
+public:
+    explicit PacketFramer(size_t max_pending = 1 << 20);
+
+    // Calls |on_packet(const uint8_t* packet, size_t length)| for every
+    // complete packet. The pointer is only valid during the call.
+    template <typename Fn>
+    void push(const uint8_t* data, size_t size, Fn on_packet);
+
+    size_t pending() const { return pending_.size(); }
+    uint64_t discarded_bytes() const { return discarded_; }
+    void reset() { pending_.clear(); }
+
+private:
+    // Emit complete packets of [data, data + size); returns the offset of
+    // the unconsumed tail
+    template <typename Fn>
+    size_t drain(const uint8_t* data, size_t size, Fn& on_packet);
+    // Start of the data worth keeping after the last complete packet
+    size_t tail_start(const uint8_t* data, size_t size, size_t from);
+
+    std::vector<uint8_t> pending_;
+    size_t max_pending_;
+    uint64_t discarded_;
+};
+
+template <typename Fn>
+size_t PacketFramer::drain(const uint8_t* data, size_t size, Fn& on_packet) {
+    size_t pos = 0;
+    PacketView view;
+    while (find_next_packet(data, size, pos, view)) {
+        discarded_ += view.offset - pos;
+        on_packet(data + view.offset, view.length);
+        pos = view.offset + view.length;
+    }
+    const size_t keep = tail_start(data, size, pos);
+    discarded_ += keep - pos;
+    return keep;
+}
+
+template <typename Fn>
+void PacketFramer::push(const uint8_t* data, size_t size, Fn on_packet) {
+    if (pending_.empty()) {
+        // Fast path: whole packets straight from the caller's buffer
+        const size_t keep = drain(data, size, on_packet);
+        pending_.assign(data + keep, data + size);
+    } else {
+        pending_.insert(pending_.end(), data, data + size);
+        const size_t keep = drain(pending_.data(), pending_.size(), on_packet);
+        pending_.erase(pending_.begin(), pending_.begin() + static_cast<long>(keep));
+    }
+    if (pending_.size() > max_pending_) {
+        discarded_ += pending_.size();
+        pending_.clear();
+    }
+}
+
 KLVSet create_dataset(const std::vector<TagValue>& tags, bool use_ul = true);
 
 // Assemble a complete STANAG 4609 packet with the outer UAS Datalink UL
 std::vector<uint8_t> create_stanag4609_packet(const std::vector<TagValue>& tags);
 
+// One packet per entry of |feeds|, encoded in parallel on |pool|
+std::vector<std::vector<uint8_t>> create_stanag4609_packets(
+    const std::vector<std::vector<TagValue>>& feeds, ThreadPool& pool);
+
+// Same packet as scatter-gather segments for writev/sendmsg: keys, lengths,
+// numeric values and the checksum live in the list's scratch buffer while
+// byte values of SegmentList::REFERENCE_THRESHOLD bytes or more are
+// referenced in place. |tags| must outlive the returned list.
+SegmentList create_stanag4609_segments(const std::vector<TagValue>& tags);
+
 namespace detail {
 
 inline void append_tag_values(std::vector<TagValue>&) {}
@@ -27,7 +27,7 @@ static std::string get_string(const KLVSet& set, const UL& ul) {
     for (const auto& node : set.children()) {
         if (auto bytes = std::dynamic_pointer_cast<KLVBytes>(node)) {
             if (bytes->ul() == ul) {
-                return std::string(bytes->value().begin(), bytes->value().end());
+                return std::string(bytes->slice().begin(), bytes->slice().end());
             }
         }
     }
@@ -214,7 +214,7 @@ int main() {
     for (const auto& node : vmti_decoded.children()) {
         if (auto bytesNode = std::dynamic_pointer_cast<KLVBytes>(node)) {
             if (bytesNode->ul() == misb::st0903::VMTI_VTARGET_SERIES) {
-                auto decodedPacks = misb::st0903::decode_vtarget_series(bytesNode->value());
+                auto decodedPacks = misb::st0903::decode_vtarget_series(bytesNode->slice());
                 for (const auto& pack : decodedPacks) {
                     const double centroid = get_value(pack.set, misb::st0903::VTARGET_CENTROID);
                     const double row = get_value(pack.set, misb::st0903::VTARGET_CENTROID_ROW);
@@ -231,7 +231,7 @@ int main() {
                               << " algorithm " << alg << '\n';
                 }
             } else if (bytesNode->ul() == misb::st0903::VMTI_ALGORITHM_SERIES) {
-                auto decodedAlgorithms = misb::st0903::decode_algorithm_series(bytesNode->value());
+                auto decodedAlgorithms = misb::st0903::decode_algorithm_series(bytesNode->slice());
                 std::cout << "Algorithms:\n";
                 for (const auto& algSet : decodedAlgorithms) {
                     const double algId = get_value(algSet, misb::st0903::ALGORITHM_ID);
@@ -248,7 +248,7 @@ int main() {
                               << " confidence " << algConf << '\n';
                 }
             } else if (bytesNode->ul() == misb::st0903::VMTI_ONTOLOGY_SERIES) {
-                auto decodedOntologies = misb::st0903::decode_ontology_series(bytesNode->value());
+                auto decodedOntologies = misb::st0903::decode_ontology_series(bytesNode->slice());
                 std::cout << "Ontologies:\n";
                 for (const auto& ontSet : decodedOntologies) {
                     const double ontId = get_value(ontSet, misb::st0903::ONTOLOGY_ID);
@@ -166,7 +166,7 @@ int main() {
                 }
             } else if (auto bytesNode = std::dynamic_pointer_cast<KLVBytes>(node)) {
                 if (bytesNode->ul() == misb::st0601::VMTI_LOCAL_SET) {
-                    vmtiDecoded.decode(bytesNode->value());
+                    vmtiDecoded.decode(bytesNode->slice());
                 }
             }
         }
@@ -181,7 +181,7 @@ int main() {
                 }
             } else if (auto bytesNode = std::dynamic_pointer_cast<KLVBytes>(node)) {
                 if (bytesNode->ul() == misb::st0903::VMTI_VTARGET_SERIES) {
-                    auto decodedPacks = misb::st0903::decode_vtarget_series(bytesNode->value());
+                    auto decodedPacks = misb::st0903::decode_vtarget_series(bytesNode->slice());
                     for (const auto& pack : decodedPacks) {
                         double centroidIndex = find_value(pack.set, misb::st0903::VTARGET_CENTROID);
                         uint64_t centroidPixel = static_cast<uint64_t>(std::llround(centroidIndex));
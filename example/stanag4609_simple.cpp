@@ -25,7 +25,7 @@ static std::string get_string(const KLVSet& set, const UL& ul) {
     for (const auto& node : set.children()) {
         if (auto bytes = std::dynamic_pointer_cast<KLVBytes>(node)) {
             if (bytes->ul() == ul) {
-                return std::string(bytes->value().begin(), bytes->value().end());
+                return std::string(bytes->slice().begin(), bytes->slice().end());
             }
         }
     }
@@ -221,7 +221,7 @@ int main() {
     for (const auto& node : vmti_decoded.children()) {
         if (auto bytesNode = std::dynamic_pointer_cast<KLVBytes>(node)) {
             if (bytesNode->ul() == misb::st0903::VMTI_VTARGET_SERIES) {
-                auto decodedPacks = misb::st0903::decode_vtarget_series(bytesNode->value());
+                auto decodedPacks = misb::st0903::decode_vtarget_series(bytesNode->slice());
                 for (const auto& pack : decodedPacks) {
                     double centroid = get_value(pack.set, misb::st0903::VTARGET_CENTROID);
                     double row = get_value(pack.set, misb::st0903::VTARGET_CENTROID_ROW);
@@ -240,7 +240,7 @@ int main() {
                     log_line(msg.str());
                 }
             } else if (bytesNode->ul() == misb::st0903::VMTI_ALGORITHM_SERIES) {
-                auto decodedAlgorithms = misb::st0903::decode_algorithm_series(bytesNode->value());
+                auto decodedAlgorithms = misb::st0903::decode_algorithm_series(bytesNode->slice());
                 log_line("Algorithms:");
                 for (const auto& algSet : decodedAlgorithms) {
                     double algId = get_value(algSet, misb::st0903::ALGORITHM_ID);
@@ -259,7 +259,7 @@ int main() {
                     log_line(msg.str());
                 }
             } else if (bytesNode->ul() == misb::st0903::VMTI_ONTOLOGY_SERIES) {
-                auto decodedOntologies = misb::st0903::decode_ontology_series(bytesNode->value());
+                auto decodedOntologies = misb::st0903::decode_ontology_series(bytesNode->slice());
                 log_line("Ontologies:");
                 for (const auto& ontSet : decodedOntologies) {
                     double ontId = get_value(ontSet, misb::st0903::ONTOLOGY_ID);
@@ -0,0 +1,138 @@
+#include "klv_udp.h"
+
+#include <arpa/inet.h>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <stdexcept>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <vector>
+
+namespace stanag {
+namespace net {
+
+namespace {
+
+sockaddr_in to_sockaddr(const Endpoint& e) {
+    sockaddr_in addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(e.address);
+    addr.sin_port = htons(e.port);
+    return addr;
+}
+
+std::runtime_error socket_error(const std::string& what) {
+    return std::runtime_error(what + ": " + std::strerror(errno));
+}
+
+} // namespace
+
+Endpoint make_endpoint(const std::string& address, uint16_t port) {
+    in_addr addr;
+    if (::inet_pton(AF_INET, address.c_str(), &addr) != 1) {
+        throw std::invalid_argument("Invalid IPv4 address: " + address);
+    }
+    Endpoint e;
+    e.address = ntohl(addr.s_addr);
+    e.port = port;
+    return e;
+}
+
+std::string to_string(const Endpoint& endpoint) {
+    in_addr addr;
+    addr.s_addr = htonl(endpoint.address);
+    char text[INET_ADDRSTRLEN];
+    ::inet_ntop(AF_INET, &addr, text, sizeof(text));
+    return std::string(text) + ":" + std::to_string(endpoint.port);
+}
+
+int open_udp_socket(const Endpoint& bind,
+                    const std::string& multicast_group,
+                    const std::string& interface_address,
+                    int receive_buffer) {
+    const int fd = ::socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) throw socket_error("socket");
+    const int one = 1;
+    ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    if (receive_buffer > 0) {
+        ::setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &receive_buffer, sizeof(receive_buffer));
+    }
+    const sockaddr_in addr = to_sockaddr(bind);
+    if (::bind(fd, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) != 0) {
+        const auto error = socket_error("bind " + to_string(bind));
+        ::close(fd);
+        throw error;
+    }
+    if (!multicast_group.empty()) {
+        ip_mreq mreq;
+        mreq.imr_multiaddr.s_addr = htonl(make_endpoint(multicast_group, 0).address);
+        mreq.imr_interface.s_addr = interface_address.empty()
+            ? htonl(INADDR_ANY)
+            : htonl(make_endpoint(interface_address, 0).address);
+        if (::setsockopt(fd, IPPROTO_IP, IP_ADD_MEMBERSHIP, &mreq, sizeof(mreq)) != 0) {
+            const auto error = socket_error("join " + multicast_group);
+            ::close(fd);
+            throw error;
+        }
+    }
+    return fd;
+}
+
+uint16_t local_port(int fd) {
+    sockaddr_in addr;
+    socklen_t len = sizeof(addr);
+    if (::getsockname(fd, reinterpret_cast<sockaddr*>(&addr), &len) != 0) return 0;
+    return ntohs(addr.sin_port);
+}
+
+void close_socket(int fd) {
+    if (fd >= 0) ::close(fd);
+}
+
+DatagramSender::DatagramSender()
+    : fd_(::socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0)) {
+    if (fd_ < 0) throw socket_error("socket");
+}
+
+DatagramSender::~DatagramSender() {
+    close_socket(fd_);
+}
+
+void DatagramSender::set_multicast(int ttl, bool loopback) {
+    const unsigned char t = static_cast<unsigned char>(ttl);
+    const unsigned char loop = loopback ? 1 : 0;
+    ::setsockopt(fd_, IPPROTO_IP, IP_MULTICAST_TTL, &t, sizeof(t));
+    ::setsockopt(fd_, IPPROTO_IP, IP_MULTICAST_LOOP, &loop, sizeof(loop));
+}
+
+bool DatagramSender::send_to(const Endpoint& to, const uint8_t* data, size_t size) {
+    const sockaddr_in addr = to_sockaddr(to);
+    ssize_t sent;
+    do {
+        sent = ::sendto(fd_, data, size, 0, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr));
+    } while (sent < 0 && errno == EINTR);
+    return sent == static_cast<ssize_t>(size);
+}
+
+bool DatagramSender::send_to(const Endpoint& to, const SegmentList& segments) {
+    sockaddr_in addr = to_sockaddr(to);
+    std::vector<iovec> iov;
+    fill_iovec(segments, iov);
+    msghdr msg;
+    std::memset(&msg, 0, sizeof(msg));
+    msg.msg_name = &addr;
+    msg.msg_namelen = sizeof(addr);
+    msg.msg_iov = iov.data();
+    msg.msg_iovlen = iov.size();
+    ssize_t sent;
+    do {
+        sent = ::sendmsg(fd_, &msg, 0);
+    } while (sent < 0 && errno == EINTR);
+    return sent == static_cast<ssize_t>(segments.size());
+}
+
+} // namespace net
+} // namespace stanag
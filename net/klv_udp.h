@@ -0,0 +1,63 @@
+#pragma once
+
+#include "klv_buffer.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Linux UDP transport helpers shared by the batched receiver and sender.
+namespace stanag {
+namespace net {
+
+// IPv4 address and port in host byte order
+struct Endpoint {
+    uint32_t address = 0;
+    uint16_t port = 0;
+};
+
+inline bool operator==(const Endpoint& a, const Endpoint& b) {
+    return a.address == b.address && a.port == b.port;
+}
+inline bool operator!=(const Endpoint& a, const Endpoint& b) { return !(a == b); }
+
+// Parse a dotted IPv4 address; throws std::invalid_argument
+Endpoint make_endpoint(const std::string& address, uint16_t port);
+std::string to_string(const Endpoint& endpoint);
+
+// Non-blocking UDP socket bound to |bind|, joining |multicast_group| (on
+// |interface_address|, default any) when not empty. |receive_buffer| sets
+// SO_RCVBUF when positive. Throws std::runtime_error.
+int open_udp_socket(const Endpoint& bind,
+                    const std::string& multicast_group = std::string(),
+                    const std::string& interface_address = std::string(),
+                    int receive_buffer = 0);
+
+// Port actually bound (useful after binding port 0)
+uint16_t local_port(int fd);
+
+void close_socket(int fd);
+
+// Minimal blocking datagram sender for tools and loopback tests
+class DatagramSender {
+public:
+    DatagramSender();
+    ~DatagramSender();
+    DatagramSender(const DatagramSender&) = delete;
+    DatagramSender& operator=(const DatagramSender&) = delete;
+
+    // Multicast TTL and loopback of sent multicast datagrams
+    void set_multicast(int ttl, bool loopback);
+
+    bool send_to(const Endpoint& to, const uint8_t* data, size_t size);
+    // One datagram gathered from |segments| with sendmsg
+    bool send_to(const Endpoint& to, const SegmentList& segments);
+
+    int fd() const { return fd_; }
+
+private:
+    int fd_;
+};
+
+} // namespace net
+} // namespace stanag
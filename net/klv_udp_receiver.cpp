@@ -0,0 +1,270 @@
+#include "klv_udp_receiver.h"
+
+#include <arpa/inet.h>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <netinet/in.h>
+#include <poll.h>
+#include <stdexcept>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace stanag {
+namespace net {
+
+namespace {
+
+uint64_t steady_ns() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+uint64_t feed_key(const Endpoint& source, uint16_t local_port) {
+    return (static_cast<uint64_t>(source.address) << 32) |
+           (static_cast<uint64_t>(source.port) << 16) | local_port;
+}
+
+} // namespace
+
+UdpReceiver::UdpReceiver(const ReceiverConfig& config, Handler handler)
+    : config_(config),
+      handler_(std::move(handler)),
+      wake_fd_(-1),
+      running_(false),
+      batches_(0),
+      datagrams_(0),
+      bytes_(0),
+      packets_(0),
+      decoded_(0),
+      invalid_(0),
+      queue_drops_(0),
+      truncated_(0),
+      feed_drops_(0) {
+    if (config_.ports.empty() || config_.batch_size == 0 || config_.datagram_capacity == 0) {
+        throw std::invalid_argument("UdpReceiver needs ports, a batch size and a datagram capacity");
+    }
+    if (config_.max_feeds == 0) {
+        throw std::invalid_argument("UdpReceiver needs a positive feed limit");
+    }
+    if (config_.decoder_threads == 0) config_.decoder_threads = 1;
+    try {
+        for (uint16_t port : config_.ports) {
+            const int fd = open_udp_socket(make_endpoint(config_.bind_address, port),
+                                           config_.multicast_group,
+                                           config_.interface_address,
+                                           config_.receive_buffer);
+            sockets_.push_back(fd);
+            ports_.push_back(local_port(fd));
+        }
+        wake_fd_ = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (wake_fd_ < 0) throw std::runtime_error("eventfd failed");
+    } catch (...) {
+        for (int fd : sockets_) close_socket(fd);
+        throw;
+    }
+    pool_.resize(config_.batch_size * config_.datagram_capacity);
+    msgs_.resize(config_.batch_size);
+    iov_.resize(config_.batch_size);
+    names_.resize(config_.batch_size);
+}
+
+UdpReceiver::~UdpReceiver() {
+    stop();
+    for (int fd : sockets_) close_socket(fd);
+    close_socket(wake_fd_);
+}
+
+void UdpReceiver::start() {
+    if (running_.exchange(true)) return;
+    workers_.clear();
+    for (unsigned i = 0; i < config_.decoder_threads; ++i) {
+        workers_.emplace_back(new Worker());
+    }
+    for (auto& worker : workers_) {
+        Worker* w = worker.get();
+        w->thread = std::thread([this, w]() { decode_loop(*w); });
+    }
+    receiver_ = std::thread([this]() { receive_loop(); });
+}
+
+void UdpReceiver::stop() {
+    if (!running_.exchange(false)) return;
+    // The receive loop also polls with a timeout, a failed wake-up only
+    // delays the stop
+    const uint64_t one = 1;
+    const ssize_t woken = ::write(wake_fd_, &one, sizeof(one));
+    (void)woken;
+    receiver_.join();
+    uint64_t drained;
+    while (::read(wake_fd_, &drained, sizeof(drained)) > 0) {
+    }
+    for (auto& worker : workers_) {
+        {
+            std::lock_guard<std::mutex> lock(worker->mutex);
+            worker->done = true;
+        }
+        worker->ready.notify_one();
+        worker->thread.join();
+    }
+    workers_.clear();
+}
+
+void UdpReceiver::receive_loop() {
+    std::vector<pollfd> fds(sockets_.size() + 1);
+    for (size_t i = 0; i < sockets_.size(); ++i) {
+        fds[i].fd = sockets_[i];
+        fds[i].events = POLLIN;
+    }
+    fds.back().fd = wake_fd_;
+    fds.back().events = POLLIN;
+
+    while (running_.load(std::memory_order_relaxed)) {
+        const int ready = ::poll(fds.data(), fds.size(), 100);
+        if (ready <= 0) continue;
+        const uint64_t now = steady_ns();
+        for (size_t i = 0; i < sockets_.size(); ++i) {
+            if (fds[i].revents & POLLIN) receive_batches(i, now);
+        }
+    }
+}
+
+void UdpReceiver::receive_batches(size_t socket, uint64_t now_ns) {
+    const size_t batch = config_.batch_size;
+    const size_t capacity = config_.datagram_capacity;
+    std::vector<mmsghdr>& msgs = msgs_;
+    std::vector<iovec>& iov = iov_;
+    std::vector<sockaddr_in>& names = names_;
+
+    while (true) {
+        for (size_t i = 0; i < batch; ++i) {
+            iov[i].iov_base = pool_.data() + i * capacity;
+            iov[i].iov_len = capacity;
+            std::memset(&msgs[i].msg_hdr, 0, sizeof(msgs[i].msg_hdr));
+            msgs[i].msg_hdr.msg_iov = &iov[i];
+            msgs[i].msg_hdr.msg_iovlen = 1;
+            msgs[i].msg_hdr.msg_name = &names[i];
+            msgs[i].msg_hdr.msg_namelen = sizeof(names[i]);
+        }
+        const int received = ::recvmmsg(sockets_[socket], msgs.data(),
+                                        static_cast<unsigned>(batch), MSG_DONTWAIT, nullptr);
+        if (received <= 0) return; // EAGAIN or error: back to poll
+
+        batches_.fetch_add(1, std::memory_order_relaxed);
+        datagrams_.fetch_add(static_cast<uint64_t>(received), std::memory_order_relaxed);
+        std::lock_guard<std::mutex> lock(feeds_mutex_);
+        for (int i = 0; i < received; ++i) {
+            const size_t length = msgs[i].msg_len;
+            bytes_.fetch_add(length, std::memory_order_relaxed);
+            // Framing the kept prefix would desynchronize the feed
+            if (msgs[i].msg_hdr.msg_flags & MSG_TRUNC) {
+                truncated_.fetch_add(1, std::memory_order_relaxed);
+                continue;
+            }
+            Endpoint source;
+            source.address = ntohl(names[i].sin_addr.s_addr);
+            source.port = ntohs(names[i].sin_port);
+            Feed* routed = route(source, ports_[socket]);
+            if (!routed) {
+                feed_drops_.fetch_add(1, std::memory_order_relaxed);
+                continue;
+            }
+            Feed& feed = *routed;
+            ++feed.info.datagrams;
+            const uint8_t* data = pool_.data() + static_cast<size_t>(i) * capacity;
+            feed.framer.push(data, length, [&](const uint8_t* packet, size_t size) {
+                ++feed.info.packets;
+                ReceivedPacket out;
+                out.feed = feed.info.feed;
+                out.source = source;
+                out.local_port = ports_[socket];
+                out.received_ns = now_ns;
+                out.bytes = ByteSlice::copy(packet, size);
+                enqueue(std::move(out));
+            });
+        }
+        if (static_cast<size_t>(received) < batch) return;
+    }
+}
+
+UdpReceiver::Feed* UdpReceiver::route(const Endpoint& source, uint16_t local_port) {
+    const uint64_t key = feed_key(source, local_port);
+    auto it = feed_index_.find(key);
+    if (it != feed_index_.end()) return feeds_[it->second].get();
+    // Every feed keeps a framer buffer, so spoofed sources must not grow
+    // the table without bound
+    if (feeds_.size() >= config_.max_feeds) return nullptr;
+    std::unique_ptr<Feed> feed(new Feed());
+    feed->info.feed = static_cast<uint32_t>(feeds_.size());
+    feed->info.source = source;
+    feed->info.local_port = local_port;
+    feed->info.datagrams = 0;
+    feed->info.packets = 0;
+    feed_index_.emplace(key, feeds_.size());
+    feeds_.push_back(std::move(feed));
+    return feeds_.back().get();
+}
+
+void UdpReceiver::enqueue(ReceivedPacket&& packet) {
+    packets_.fetch_add(1, std::memory_order_relaxed);
+    Worker& worker = *workers_[packet.feed % workers_.size()];
+    {
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        if (worker.queue.size() >= config_.queue_capacity) {
+            queue_drops_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        worker.queue.push_back(std::move(packet));
+    }
+    worker.ready.notify_one();
+}
+
+void UdpReceiver::decode_loop(Worker& worker) {
+    while (true) {
+        ReceivedPacket packet;
+        {
+            std::unique_lock<std::mutex> lock(worker.mutex);
+            worker.ready.wait(lock, [&]() { return worker.done || !worker.queue.empty(); });
+            if (worker.queue.empty()) return;
+            packet = std::move(worker.queue.front());
+            worker.queue.pop_front();
+        }
+        KLVSet decoded;
+        if (!decode_stanag4609_packet(packet.bytes, decoded)) {
+            invalid_.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+        decoded_.fetch_add(1, std::memory_order_relaxed);
+        if (handler_) handler_(packet, decoded);
+    }
+}
+
+ReceiverStats UdpReceiver::stats() const {
+    ReceiverStats s;
+    s.batches = batches_.load();
+    s.datagrams = datagrams_.load();
+    s.bytes = bytes_.load();
+    s.packets = packets_.load();
+    s.decoded = decoded_.load();
+    s.invalid = invalid_.load();
+    s.queue_drops = queue_drops_.load();
+    s.truncated = truncated_.load();
+    s.feed_drops = feed_drops_.load();
+    std::lock_guard<std::mutex> lock(feeds_mutex_);
+    s.discarded_bytes = 0;
+    for (const auto& feed : feeds_) s.discarded_bytes += feed->framer.discarded_bytes();
+    s.feeds = feeds_.size();
+    return s;
+}
+
+std::vector<FeedInfo> UdpReceiver::feeds() const {
+    std::lock_guard<std::mutex> lock(feeds_mutex_);
+    std::vector<FeedInfo> out;
+    out.reserve(feeds_.size());
+    for (const auto& feed : feeds_) out.push_back(feed->info);
+    return out;
+}
+
+} // namespace net
+} // namespace stanag
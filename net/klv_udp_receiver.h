@@ -0,0 +1,150 @@
+#pragma once
+
+#include "klv.h"
+#include "klv_udp.h"
+#include "stanag.h"
+
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace stanag {
+namespace net {
+
+// Complete STANAG 4609 packet received from one feed
+struct ReceivedPacket {
+    uint32_t feed;          // dense id, in order of first datagram
+    Endpoint source;
+    uint16_t local_port;
+    uint64_t received_ns;   // steady clock time of the receiving batch
+    ByteSlice bytes;
+};
+
+struct FeedInfo {
+    uint32_t feed;
+    Endpoint source;
+    uint16_t local_port;
+    uint64_t datagrams;
+    uint64_t packets;
+};
+
+struct ReceiverConfig {
+    std::vector<uint16_t> ports = {0};      // 0 binds an ephemeral port
+    std::string bind_address = "0.0.0.0";
+    std::string multicast_group;            // joined on every port when set
+    std::string interface_address;
+    size_t batch_size = 64;                 // datagrams per recvmmsg call
+    size_t datagram_capacity = 65536;       // bytes per pool slot; larger
+                                            // datagrams are dropped
+    unsigned decoder_threads = 1;
+    size_t queue_capacity = 4096;           // packets per decoder worker
+    int receive_buffer = 4 << 20;           // SO_RCVBUF
+    size_t max_feeds = 1024;                // datagrams from further sources
+                                            // are dropped
+};
+
+struct ReceiverStats {
+    uint64_t batches;
+    uint64_t datagrams;
+    uint64_t bytes;
+    uint64_t packets;           // framed packets handed to the workers
+    uint64_t decoded;           // packets delivered to the handler
+    uint64_t invalid;           // malformed or bad checksum
+    uint64_t queue_drops;       // packets dropped on a full worker queue
+    uint64_t truncated;         // datagrams larger than datagram_capacity
+    uint64_t feed_drops;        // datagrams from sources beyond max_feeds
+    uint64_t discarded_bytes;   // stream bytes outside of any packet
+    size_t feeds;
+};
+
+// Batched UDP / multicast KLV receiver (Linux).
+//
+// One thread waits on every socket and drains ready ones with recvmmsg
+// into a preallocated pool of batch_size slots. Datagrams are routed by
+// (source address, source port, local port) to a per-feed PacketFramer;
+// complete packets go to the decoder worker owning the feed (feed id modulo
+// decoder_threads), so the handler sees each feed's packets in order.
+class UdpReceiver {
+public:
+    // Called on decoder worker threads with the decoded ST 0601 local set
+    using Handler = std::function<void(const ReceivedPacket&, const KLVSet&)>;
+
+    // Opens and binds the sockets; throws std::runtime_error
+    UdpReceiver(const ReceiverConfig& config, Handler handler);
+    ~UdpReceiver();
+    UdpReceiver(const UdpReceiver&) = delete;
+    UdpReceiver& operator=(const UdpReceiver&) = delete;
+
+    void start();
+    // Stop receiving; packets already queued are still delivered
+    void stop();
+
+    // Bound ports, in configuration order
+    const std::vector<uint16_t>& ports() const { return ports_; }
+
+    ReceiverStats stats() const;
+    std::vector<FeedInfo> feeds() const;
+
+private:
+    struct Feed {
+        FeedInfo info;
+        PacketFramer framer;
+    };
+    struct Worker {
+        std::mutex mutex;
+        std::condition_variable ready;
+        std::deque<ReceivedPacket> queue;
+        bool done = false;
+        std::thread thread;
+    };
+
+    void receive_loop();
+    void receive_batches(size_t socket, uint64_t now_ns);
+    // nullptr once max_feeds feeds exist
+    Feed* route(const Endpoint& source, uint16_t local_port);
+    void enqueue(ReceivedPacket&& packet);
+    void decode_loop(Worker& worker);
+
+    ReceiverConfig config_;
+    Handler handler_;
+    std::vector<int> sockets_;
+    std::vector<uint16_t> ports_;
+    int wake_fd_;
+    std::atomic<bool> running_;
+    std::thread receiver_;
+    std::vector<std::unique_ptr<Worker>> workers_;
+
+    // Receive thread state: the datagram pool and recvmmsg descriptors
+    std::vector<uint8_t> pool_;
+    std::vector<mmsghdr> msgs_;
+    std::vector<iovec> iov_;
+    std::vector<sockaddr_in> names_;
+    mutable std::mutex feeds_mutex_;
+    std::vector<std::unique_ptr<Feed>> feeds_;
+    std::unordered_map<uint64_t, size_t> feed_index_;
+
+    std::atomic<uint64_t> batches_;
+    std::atomic<uint64_t> datagrams_;
+    std::atomic<uint64_t> bytes_;
+    std::atomic<uint64_t> packets_;
+    std::atomic<uint64_t> decoded_;
+    std::atomic<uint64_t> invalid_;
+    std::atomic<uint64_t> queue_drops_;
+    std::atomic<uint64_t> truncated_;
+    std::atomic<uint64_t> feed_drops_;
+};
+
+} // namespace net
+} // namespace stanag
@@ -0,0 +1,298 @@
+#include "klv_udp_sender.h"
+#include "stanag.h"
+#include "st_common.h"
+#include "st0601.h"
+
+#include <arpa/inet.h>
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+namespace stanag {
+namespace net {
+
+namespace {
+
+uint64_t steady_ns() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+// UNIX_TIMESTAMP (microseconds) of one complete packet
+bool packet_timestamp(const ByteSlice& packet, uint64_t& micros) {
+    PacketView view;
+    if (!find_next_packet(packet.data(), packet.size(), 0, view)) return false;
+    const uint8_t* payload = packet.data() + view.payload_offset;
+    size_t value_offset = 0, value_len = 0;
+    if (!misb::find_local_tag(payload, view.payload_length, misb::st0601::UNIX_TIMESTAMP[15],
+                              value_offset, value_len) || value_len != 8) {
+        return false;
+    }
+    return misb::read_uint_be(payload + value_offset, value_len, 8, micros) == 8;
+}
+
+} // namespace
+
+PacedSender::PacedSender(const SenderConfig& config)
+    : config_(config),
+      running_(false),
+      cursor_(0),
+      pending_(0),
+      submitted_(0),
+      rejected_(0),
+      batches_(0) {
+    if (config_.batch_size == 0 || config_.tick_ns == 0 || config_.wheel_slots == 0) {
+        throw std::invalid_argument("PacedSender needs a batch size, a tick and wheel slots");
+    }
+    if (config_.multicast_ttl > 0) {
+        socket_.set_multicast(config_.multicast_ttl, config_.multicast_loopback);
+    }
+    wheel_.resize(config_.wheel_slots);
+    cursor_ = steady_ns() / config_.tick_ns;
+    msgs_.resize(config_.batch_size);
+    iov_.resize(config_.batch_size);
+}
+
+PacedSender::~PacedSender() {
+    stop();
+}
+
+uint32_t PacedSender::add_feed(const Endpoint& destination, double rate_hz) {
+    Feed feed = Feed();
+    feed.destination = destination;
+    feed.period_ns = rate_hz > 0.0 ? static_cast<uint64_t>(std::llround(1e9 / rate_hz)) : 0;
+    std::lock_guard<std::mutex> lock(mutex_);
+    feeds_.push_back(feed);
+    return static_cast<uint32_t>(feeds_.size() - 1);
+}
+
+uint64_t PacedSender::schedule(Feed& feed, const ByteSlice& packet, uint64_t now_ns) {
+    uint64_t due = now_ns;
+    if (feed.period_ns != 0) {
+        // Keep the cadence, but do not burst to catch up after a stall
+        if (feed.last_due_ns != 0) due = std::max(feed.last_due_ns + feed.period_ns, now_ns);
+    } else {
+        uint64_t micros = 0;
+        if (packet_timestamp(packet, micros)) {
+            if (!feed.anchored) {
+                feed.anchored = true;
+                feed.anchor_ns = now_ns;
+                feed.anchor_us = micros;
+            }
+            if (micros >= feed.anchor_us) due = feed.anchor_ns + (micros - feed.anchor_us) * 1000;
+        }
+    }
+    // A feed never overtakes itself, even when its timestamps go backwards
+    due = std::max(due, feed.last_due_ns);
+    feed.last_due_ns = due;
+    return due;
+}
+
+bool PacedSender::submit(uint32_t feed, const ByteSlice& packet) {
+    const uint64_t now = steady_ns();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (feed >= feeds_.size()) throw std::out_of_range("Unknown sender feed");
+        if (pending_ >= config_.max_pending) {
+            ++rejected_;
+            return false;
+        }
+        Feed& f = feeds_[feed];
+        Entry entry;
+        entry.due_ns = schedule(f, packet, now);
+        entry.seq = submitted_;
+        entry.feed = feed;
+        std::memset(&entry.to, 0, sizeof(entry.to));
+        entry.to.sin_family = AF_INET;
+        entry.to.sin_addr.s_addr = htonl(f.destination.address);
+        entry.to.sin_port = htons(f.destination.port);
+        entry.bytes = packet;
+        // Already due packets go in the next collected slot
+        const uint64_t tick = std::max(due_tick(entry.due_ns), cursor_ + 1);
+        wheel_[tick % wheel_.size()].push_back(std::move(entry));
+        ++pending_;
+        ++submitted_;
+    }
+    wake_.notify_one();
+    return true;
+}
+
+void PacedSender::start() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (running_) return;
+    running_ = true;
+    thread_ = std::thread([this]() { send_loop(); });
+}
+
+void PacedSender::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!running_) return;
+        running_ = false;
+    }
+    wake_.notify_one();
+    thread_.join();
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& slot : wheel_) slot.clear();
+    pending_ = 0;
+}
+
+uint64_t PacedSender::due_tick(uint64_t due_ns) const {
+    // Rounded up: the slot of tick t is collected at t * tick_ns or later
+    return (due_ns + config_.tick_ns - 1) / config_.tick_ns;
+}
+
+void PacedSender::collect(uint64_t now_tick, std::vector<Entry>& ready) {
+    // Walk the slots passed since the last collect, at most one revolution;
+    // entries of later revolutions stay in place
+    const uint64_t span = std::min<uint64_t>(now_tick - cursor_, wheel_.size());
+    for (uint64_t i = 1; i <= span; ++i) {
+        auto& slot = wheel_[(cursor_ + i) % wheel_.size()];
+        size_t kept = 0;
+        for (size_t j = 0; j < slot.size(); ++j) {
+            if (due_tick(slot[j].due_ns) <= now_tick) {
+                ready.push_back(std::move(slot[j]));
+            } else {
+                if (kept != j) slot[kept] = std::move(slot[j]);
+                ++kept;
+            }
+        }
+        slot.resize(kept);
+    }
+    // Slots are walked from the cursor, not from the earliest tick: after
+    // a stall of more than a revolution, entries of several revolutions
+    // come out in slot order. A feed's due times never decrease, so this
+    // restores its submission order.
+    if (span > 1 && ready.size() > 1) {
+        std::sort(ready.begin(), ready.end(), [](const Entry& a, const Entry& b) {
+            return a.due_ns != b.due_ns ? a.due_ns < b.due_ns : a.seq < b.seq;
+        });
+    }
+    cursor_ = now_tick;
+    pending_ -= ready.size();
+}
+
+void PacedSender::send_loop() {
+    std::vector<Entry> ready;
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (running_) {
+        if (pending_ == 0) {
+            wake_.wait(lock);
+            continue;
+        }
+        const uint64_t now = steady_ns();
+        const uint64_t now_tick = now / config_.tick_ns;
+        if (now_tick <= cursor_) {
+            const auto next = std::chrono::steady_clock::time_point(
+                std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                    std::chrono::nanoseconds((cursor_ + 1) * config_.tick_ns)));
+            wake_.wait_until(lock, next);
+            continue;
+        }
+        collect(now_tick, ready);
+        if (ready.empty()) continue;
+        lock.unlock();
+        send_batch(ready);
+        ready.clear();
+        lock.lock();
+    }
+}
+
+void PacedSender::send_batch(std::vector<Entry>& ready) {
+    size_t sent_total = 0;
+    while (sent_total < ready.size()) {
+        const size_t n = std::min(config_.batch_size, ready.size() - sent_total);
+        for (size_t i = 0; i < n; ++i) {
+            Entry& e = ready[sent_total + i];
+            iov_[i].iov_base = const_cast<uint8_t*>(e.bytes.data());
+            iov_[i].iov_len = e.bytes.size();
+            std::memset(&msgs_[i], 0, sizeof(msgs_[i]));
+            msgs_[i].msg_hdr.msg_name = &e.to;
+            msgs_[i].msg_hdr.msg_namelen = sizeof(e.to);
+            msgs_[i].msg_hdr.msg_iov = &iov_[i];
+            msgs_[i].msg_hdr.msg_iovlen = 1;
+        }
+        const uint64_t now = steady_ns();
+        int sent;
+        do {
+            sent = ::sendmmsg(socket_.fd(), msgs_.data(), static_cast<unsigned>(n), 0);
+        } while (sent < 0 && errno == EINTR);
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++batches_;
+        // On error the first datagram is counted as failed and skipped
+        const size_t done = sent > 0 ? static_cast<size_t>(sent) : 1;
+        for (size_t i = 0; i < done; ++i) {
+            const Entry& e = ready[sent_total + i];
+            Feed& f = feeds_[e.feed];
+            if (sent <= 0) {
+                ++f.errors;
+                continue;
+            }
+            // Signed: an early send must show up in the statistics
+            const double lateness = static_cast<double>(static_cast<int64_t>(now - e.due_ns));
+            if (f.sent == 0) {
+                f.first_sent_ns = now;
+                f.lateness_min = lateness;
+                f.lateness_max = lateness;
+            }
+            f.last_sent_ns = now;
+            ++f.sent;
+            f.lateness_sum += lateness;
+            f.lateness_sq_sum += lateness * lateness;
+            f.lateness_min = std::min(f.lateness_min, lateness);
+            f.lateness_max = std::max(f.lateness_max, lateness);
+        }
+        sent_total += done;
+    }
+}
+
+size_t PacedSender::pending() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return pending_;
+}
+
+SenderStats PacedSender::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    SenderStats s;
+    s.submitted = submitted_;
+    s.rejected = rejected_;
+    s.sent = 0;
+    s.errors = 0;
+    s.batches = batches_;
+    s.pending = pending_;
+    for (size_t i = 0; i < feeds_.size(); ++i) {
+        const Feed& f = feeds_[i];
+        SenderFeedStats fs;
+        fs.feed = static_cast<uint32_t>(i);
+        fs.destination = f.destination;
+        fs.sent = f.sent;
+        fs.errors = f.errors;
+        fs.rate_hz = 0.0;
+        fs.mean_lateness_us = 0.0;
+        fs.min_lateness_us = f.lateness_min / 1e3;
+        fs.max_lateness_us = f.lateness_max / 1e3;
+        fs.jitter_us = 0.0;
+        if (f.sent > 1 && f.last_sent_ns > f.first_sent_ns) {
+            fs.rate_hz = static_cast<double>(f.sent - 1) * 1e9 /
+                         static_cast<double>(f.last_sent_ns - f.first_sent_ns);
+        }
+        if (f.sent > 0) {
+            const double n = static_cast<double>(f.sent);
+            const double mean = f.lateness_sum / n;
+            const double variance = std::max(0.0, f.lateness_sq_sum / n - mean * mean);
+            fs.mean_lateness_us = mean / 1e3;
+            fs.jitter_us = std::sqrt(variance) / 1e3;
+        }
+        s.sent += f.sent;
+        s.errors += f.errors;
+        s.feeds.push_back(fs);
+    }
+    return s;
+}
+
+} // namespace net
+} // namespace stanag
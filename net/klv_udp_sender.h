@@ -0,0 +1,140 @@
+#pragma once
+
+#include "klv_buffer.h"
+#include "klv_udp.h"
+
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace stanag {
+namespace net {
+
+struct SenderConfig {
+    size_t batch_size = 64;             // datagrams per sendmmsg call
+    uint64_t tick_ns = 1000000;         // timer wheel resolution
+    size_t wheel_slots = 1024;          // one revolution = slots x tick
+    size_t max_pending = 65536;         // scheduled packets over all feeds
+    int multicast_ttl = 0;              // set IP_MULTICAST_TTL when positive
+    bool multicast_loopback = true;
+};
+
+// Achieved timing of one feed. Lateness is the send time minus the
+// scheduled time, kept signed; packets leave on the first tick at or after
+// their scheduled time, so it is never negative.
+struct SenderFeedStats {
+    uint32_t feed;
+    Endpoint destination;
+    uint64_t sent;
+    uint64_t errors;
+    double rate_hz;             // over the first to last send
+    double mean_lateness_us;
+    double min_lateness_us;
+    double max_lateness_us;
+    double jitter_us;           // standard deviation of the lateness
+};
+
+struct SenderStats {
+    uint64_t submitted;
+    uint64_t rejected;          // submit() over max_pending
+    uint64_t sent;
+    uint64_t errors;
+    uint64_t batches;           // sendmmsg calls
+    size_t pending;
+    std::vector<SenderFeedStats> feeds;
+};
+
+// Paced, batched UDP sender (Linux).
+//
+// Packets (typically create_stanag4609_packet output) are scheduled per
+// feed, either at the feed's target rate or at the offset of their
+// UNIX_TIMESTAMP from the feed's first packet. Scheduled packets sit in a
+// hashed timer wheel; one thread advances it every tick and sends all due
+// packets, whatever their feed, with as few sendmmsg calls as possible.
+// A feed's packets always leave in submission order.
+class PacedSender {
+public:
+    // Throws std::runtime_error when the socket cannot be created
+    explicit PacedSender(const SenderConfig& config = SenderConfig());
+    ~PacedSender();
+    PacedSender(const PacedSender&) = delete;
+    PacedSender& operator=(const PacedSender&) = delete;
+
+    // |rate_hz| > 0 spaces packets by 1 / rate; 0 paces by UNIX_TIMESTAMP
+    // (packets without one are sent as soon as possible)
+    uint32_t add_feed(const Endpoint& destination, double rate_hz = 0.0);
+
+    // Schedule one datagram; false when max_pending packets are waiting
+    bool submit(uint32_t feed, const ByteSlice& packet);
+    bool submit(uint32_t feed, std::vector<uint8_t>&& packet) {
+        return submit(feed, ByteSlice::adopt(std::move(packet)));
+    }
+
+    void start();
+    // Stop sending; packets still scheduled are discarded
+    void stop();
+
+    size_t pending() const;
+    SenderStats stats() const;
+
+private:
+    struct Entry {
+        uint64_t due_ns;
+        uint64_t seq;           // submission order
+        uint32_t feed;
+        sockaddr_in to;
+        ByteSlice bytes;
+    };
+    struct Feed {
+        Endpoint destination;
+        uint64_t period_ns;     // 0: timestamp pacing
+        bool anchored;
+        uint64_t anchor_ns;     // steady time of the first timestamp
+        uint64_t anchor_us;     // first UNIX_TIMESTAMP
+        uint64_t last_due_ns;
+        // Timing statistics
+        uint64_t sent;
+        uint64_t errors;
+        uint64_t first_sent_ns;
+        uint64_t last_sent_ns;
+        double lateness_sum;
+        double lateness_sq_sum;
+        double lateness_min;
+        double lateness_max;
+    };
+
+    uint64_t schedule(Feed& feed, const ByteSlice& packet, uint64_t now_ns);
+    // First tick starting at or after |due_ns|
+    uint64_t due_tick(uint64_t due_ns) const;
+    void collect(uint64_t now_tick, std::vector<Entry>& ready);
+    void send_loop();
+    void send_batch(std::vector<Entry>& ready);
+
+    SenderConfig config_;
+    DatagramSender socket_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable wake_;
+    bool running_;
+    std::thread thread_;
+    std::vector<Feed> feeds_;
+    std::vector<std::vector<Entry>> wheel_;
+    uint64_t cursor_;           // last collected tick
+    size_t pending_;
+    uint64_t submitted_;
+    uint64_t rejected_;
+    uint64_t batches_;
+
+    // Send thread state: sendmmsg descriptors
+    std::vector<mmsghdr> msgs_;
+    std::vector<iovec> iov_;
+};
+
+} // namespace net
+} // namespace stanag
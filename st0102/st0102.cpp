@@ -1,34 +1,40 @@
 #include "st0102.h"
 
+#include <cstddef>
+#include <cstdint>
+
 namespace misb {
 namespace st0102 {
 
+namespace {
+
+// Classification and classification system: enumerations on one byte
+size_t encode_enum(const void*, double code, uint8_t* dst) {
+    dst[0] = static_cast<uint8_t>(code);
+    return 1;
+}
+
+double decode_enum(const void*, const uint8_t* data, size_t size) {
+    if (size != 1) return 0.0;
+    return static_cast<double>(data[0]);
+}
+
+constexpr KLVCodec CODECS[] = {
+    {0x00, encode_enum, decode_enum, nullptr},  // CLASSIFICATION
+    {0x01, encode_enum, decode_enum, nullptr},  // CLASSIFICATION_SYSTEM
+};
+
+} // namespace
+
+const KLVCodec* builtin_codec(uint8_t tag) {
+    return tag < sizeof(CODECS) / sizeof(CODECS[0]) ? &CODECS[tag] : nullptr;
+}
+
 void register_st0102(KLVRegistry& reg) {
-    // Classification: enumeration -> uint8
-    reg.register_ul(CLASSIFICATION, {
-        [](double code) {
-            return pack_be<uint8_t>(static_cast<uint8_t>(code));
-        },
-        [](const std::vector<uint8_t>& bytes) {
-            uint8_t raw{};
-            if (!unpack_be<uint8_t>(bytes, raw)) return 0.0;
-            return static_cast<double>(raw);
-        }
-    });
-
-    // Classification System: enumeration -> uint8
-    reg.register_ul(CLASSIFICATION_SYSTEM, {
-        [](double code) {
-            return pack_be<uint8_t>(static_cast<uint8_t>(code));
-        },
-        [](const std::vector<uint8_t>& bytes) {
-            uint8_t raw{};
-            if (!unpack_be<uint8_t>(bytes, raw)) return 0.0;
-            return static_cast<double>(raw);
-        }
-    });
+    for (const auto& c : CODECS) {
+        reg.register_codec(make_st_ul(ST_ID, c.tag), c);
+    }
 }
 
 } // namespace st0102
 } // namespace misb
-
@@ -10,7 +10,10 @@ constexpr uint8_t ST_ID = 0x02;
 constexpr UL CLASSIFICATION        = make_st_ul(ST_ID, 0x00);
 constexpr UL CLASSIFICATION_SYSTEM = make_st_ul(ST_ID, 0x01);
 
-// Register encode/decode lambdas for the above ULs
+// Constant codec of the above items, nullptr for other tags
+const KLVCodec* builtin_codec(uint8_t tag);
+
+// Make the ST 0102 codecs visible to KLVRegistry::find as well
 void register_st0102(KLVRegistry& reg);
 
 } // namespace st0102
@@ -2,6 +2,7 @@
 
 #include "klv.h"
 #include "st_common.h"
+#include "st1201.h"
 
 namespace misb {
 namespace st0601 {
@@ -154,11 +155,36 @@ constexpr uint8_t ST_ID = 0x01;
 #define DEFINE_UL(name, id) constexpr UL name = make_st_ul(ST_ID, id);
 ST0601_TAGS(DEFINE_UL)
 #undef DEFINE_UL
+
+// Tag numbers, for compile-time uses such as FixedPacket
+namespace tags {
+#define DEFINE_TAG(name, id) constexpr uint8_t name = id;
+ST0601_TAGS(DEFINE_TAG)
+#undef DEFINE_TAG
+} // namespace tags
 #undef ST0601_TAGS
 
-// Register encode/decode functions for ST 0601 tags
+// Constant codec of a numeric ST 0601 tag, nullptr for other tags.
+// KLVRegistry::lookup uses these without any registration.
+const KLVCodec* builtin_codec(uint8_t tag);
+
+// Make the ST 0601 codecs visible to KLVRegistry::find as well. Decoding
+// and encoding no longer need it.
 void register_st0601(KLVRegistry& reg);
 
+// ST 1201 mapping of the extended heights (tags 103..105), encoded as
+// IMAPB(-900, 40000, 3). Any received length 1..8 decodes.
+const st1201::Imap& imap_extended_height();
+
+// Transmitted integer layout of a numeric ST 0601 tag
+struct RawFormat {
+    uint8_t width;
+    bool is_signed;
+};
+
+// Returns false for tags that are not encoded as a fixed-width integer
+bool raw_format(uint8_t tag, RawFormat& out);
+
 } // namespace st0601
 } // namespace misb
 
@@ -0,0 +1,433 @@
+#include "st0601_archive.h"
+#include "st0601_codec.h"
+#include "st_common.h"
+#include "stanag.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <map>
+#include <stdexcept>
+
+namespace misb {
+namespace st0601 {
+
+namespace {
+
+void put_varint(std::vector<uint8_t>& out, uint64_t v) {
+    while (v >= 0x80u) {
+        out.push_back(static_cast<uint8_t>(v | 0x80u));
+        v >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(v));
+}
+
+uint64_t zigzag(int64_t v) {
+    return (static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63);
+}
+
+int64_t unzigzag(uint64_t v) {
+    return static_cast<int64_t>(v >> 1) ^ -static_cast<int64_t>(v & 1u);
+}
+
+// Bounds-checked cursor over an encoded block
+struct Cursor {
+    const uint8_t* p;
+    const uint8_t* end;
+
+    uint8_t byte() {
+        if (p >= end) throw std::runtime_error("Truncated archive block");
+        return *p++;
+    }
+    uint64_t varint() {
+        uint64_t v = 0;
+        for (unsigned shift = 0; shift < 64; shift += 7) {
+            const uint8_t b = byte();
+            v |= static_cast<uint64_t>(b & 0x7Fu) << shift;
+            if ((b & 0x80u) == 0) return v;
+        }
+        throw std::runtime_error("Malformed varint in archive block");
+    }
+    const uint8_t* take(size_t n) {
+        if (static_cast<size_t>(end - p) < n) throw std::runtime_error("Truncated archive block");
+        const uint8_t* start = p;
+        p += n;
+        return start;
+    }
+};
+
+void store_raw(std::vector<uint8_t>& out, int64_t value, size_t width) {
+    uint8_t buf[8];
+    const size_t n = misb::write_uint_be(buf, sizeof(buf), static_cast<uint64_t>(value), width);
+    out.insert(out.end(), buf, buf + n);
+}
+
+void put_le64(std::vector<uint8_t>& out, uint64_t v) {
+    for (size_t i = 0; i < 8; ++i) {
+        out.push_back(static_cast<uint8_t>((v >> (8 * i)) & 0xFFu));
+    }
+}
+
+uint64_t get_le64(const uint8_t* p) {
+    uint64_t v = 0;
+    for (size_t i = 8; i-- > 0;) {
+        v = (v << 8) | p[i];
+    }
+    return v;
+}
+
+struct ColumnHeader {
+    ColumnStats stats;
+    Cursor data;
+};
+
+struct BlockLayout {
+    std::vector<std::vector<uint8_t>> layouts;
+    std::vector<uint32_t> row_layouts;
+    std::vector<ColumnHeader> columns;
+};
+
+BlockLayout parse_block(const uint8_t* data, size_t size) {
+    Cursor c{data, data + size};
+    BlockLayout b;
+    const uint64_t rows = c.varint();
+    const uint64_t layout_count = c.varint();
+    if (layout_count > size) throw std::runtime_error("Corrupt archive block");
+    b.layouts.resize(static_cast<size_t>(layout_count));
+    for (auto& layout : b.layouts) {
+        const size_t n = static_cast<size_t>(c.varint());
+        const uint8_t* tags = c.take(n);
+        layout.assign(tags, tags + n);
+    }
+    if (rows > size) throw std::runtime_error("Corrupt archive block");
+    b.row_layouts.resize(static_cast<size_t>(rows));
+    for (auto& id : b.row_layouts) {
+        id = static_cast<uint32_t>(c.varint());
+        if (id >= b.layouts.size()) throw std::runtime_error("Corrupt archive layout id");
+    }
+    const uint64_t column_count = c.varint();
+    if (column_count > 256) throw std::runtime_error("Corrupt archive block");
+    for (uint64_t i = 0; i < column_count; ++i) {
+        ColumnHeader col;
+        col.stats.tag = c.byte();
+        col.stats.numeric = c.byte() == 0;
+        col.stats.width = 0;
+        col.stats.is_signed = false;
+        col.stats.min = 0;
+        col.stats.max = 0;
+        if (col.stats.numeric) {
+            col.stats.width = c.byte();
+            col.stats.is_signed = c.byte() != 0;
+            if (col.stats.width == 0 || col.stats.width > 8) {
+                throw std::runtime_error("Corrupt archive column width");
+            }
+            col.stats.min = unzigzag(c.varint());
+            col.stats.max = unzigzag(c.varint());
+        }
+        col.stats.count = static_cast<uint32_t>(c.varint());
+        const size_t data_size = static_cast<size_t>(c.varint());
+        const uint8_t* start = c.take(data_size);
+        col.data = Cursor{start, start + data_size};
+        b.columns.push_back(col);
+    }
+    return b;
+}
+
+} // namespace
+
+ArchiveWriter::ArchiveWriter(const std::string& path, size_t rows_per_block)
+    : out_(path, std::ios::binary | std::ios::trunc),
+      rows_per_block_(rows_per_block ? rows_per_block : 1),
+      position_(0),
+      closed_(false) {
+    if (!out_) throw std::runtime_error("Unable to create archive " + path);
+    out_.write(ARCHIVE_MAGIC, sizeof(ARCHIVE_MAGIC));
+    position_ = sizeof(ARCHIVE_MAGIC);
+}
+
+ArchiveWriter::~ArchiveWriter() {
+    try {
+        close();
+    } catch (...) {
+    }
+}
+
+bool ArchiveWriter::append(const uint8_t* packet, size_t size) {
+    if (closed_) throw std::runtime_error("Archive already closed");
+    stanag::PacketView view;
+    if (!stanag::find_next_packet(packet, size, 0, view) || view.offset != 0 ||
+        view.length != size || view.payload_length < 4) {
+        return false;
+    }
+    const uint8_t* crc = packet + size - 4;
+    if (crc[0] != 0x01 || crc[1] != 0x02) return false;
+    const uint16_t stored = static_cast<uint16_t>((crc[2] << 8) | crc[3]);
+    if (stored != misb::klv_checksum_16(std::vector<uint8_t>(packet, packet + size - 2))) {
+        return false;
+    }
+
+    const uint8_t* payload = packet + view.payload_offset;
+    const size_t payload_len = view.payload_length - 4;
+    Row row;
+    row.first_item = static_cast<uint32_t>(items_.size());
+    row.item_count = 0;
+    const size_t values_size = values_.size();
+    size_t i = 0;
+    while (i < payload_len) {
+        const uint8_t tag = payload[i++];
+        size_t len = 0, len_bytes = 0;
+        if (!misb::decode_ber_length(payload, payload_len, i, len, len_bytes) ||
+            len > payload_len - i - len_bytes) {
+            items_.resize(row.first_item);
+            values_.resize(values_size);
+            return false;
+        }
+        i += len_bytes;
+        Item item;
+        item.tag = tag;
+        item.offset = static_cast<uint32_t>(values_.size());
+        item.length = static_cast<uint32_t>(len);
+        values_.insert(values_.end(), payload + i, payload + i + len);
+        items_.push_back(item);
+        ++row.item_count;
+        i += len;
+    }
+    rows_.push_back(row);
+    if (rows_.size() >= rows_per_block_) flush();
+    return true;
+}
+
+void ArchiveWriter::flush() {
+    if (rows_.empty()) return;
+
+    std::vector<uint8_t> block;
+    put_varint(block, rows_.size());
+
+    // Layout dictionary: packets of a feed usually repeat a handful of layouts
+    std::map<std::vector<uint8_t>, uint32_t> layout_ids;
+    std::vector<const std::vector<uint8_t>*> layouts;
+    std::vector<uint32_t> row_layouts;
+    row_layouts.reserve(rows_.size());
+    std::array<std::vector<uint32_t>, 256> column_items;
+    std::vector<uint8_t> key;
+    for (const auto& row : rows_) {
+        key.clear();
+        for (uint32_t k = 0; k < row.item_count; ++k) {
+            const uint32_t idx = row.first_item + k;
+            key.push_back(items_[idx].tag);
+            column_items[items_[idx].tag].push_back(idx);
+        }
+        auto it = layout_ids.find(key);
+        if (it == layout_ids.end()) {
+            it = layout_ids.insert(std::make_pair(key, static_cast<uint32_t>(layouts.size()))).first;
+            layouts.push_back(&it->first);
+        }
+        row_layouts.push_back(it->second);
+    }
+    put_varint(block, layouts.size());
+    for (const auto* layout : layouts) {
+        put_varint(block, layout->size());
+        block.insert(block.end(), layout->begin(), layout->end());
+    }
+    for (uint32_t id : row_layouts) {
+        put_varint(block, id);
+    }
+
+    size_t column_count = 0;
+    for (const auto& items : column_items) {
+        if (!items.empty()) ++column_count;
+    }
+    put_varint(block, column_count);
+
+    uint64_t min_ts = 0, max_ts = 0;
+    std::vector<uint8_t> data;
+    for (size_t tag = 0; tag < column_items.size(); ++tag) {
+        const auto& items = column_items[tag];
+        if (items.empty()) continue;
+        RawFormat fmt{0, false};
+        bool numeric = raw_format(static_cast<uint8_t>(tag), fmt);
+        const CodecDescriptor* codec = codec_descriptor(static_cast<uint8_t>(tag));
+        for (uint32_t idx : items) {
+            if (items_[idx].length != fmt.width) {
+                numeric = false;
+                break;
+            }
+        }
+        data.clear();
+        block.push_back(static_cast<uint8_t>(tag));
+        if (numeric) {
+            int64_t prev = 0;
+            int64_t lo = 0, hi = 0;
+            for (size_t k = 0; k < items.size(); ++k) {
+                uint64_t raw = 0;
+                read_raw(*codec, values_.data() + items_[items[k]].offset, fmt.width, raw);
+                const int64_t v = static_cast<int64_t>(raw);
+                const uint64_t delta = static_cast<uint64_t>(v) - static_cast<uint64_t>(prev);
+                put_varint(data, zigzag(static_cast<int64_t>(delta)));
+                prev = v;
+                if (k == 0 || v < lo) lo = v;
+                if (k == 0 || v > hi) hi = v;
+            }
+            block.push_back(0);
+            block.push_back(fmt.width);
+            block.push_back(fmt.is_signed ? 1 : 0);
+            put_varint(block, zigzag(lo));
+            put_varint(block, zigzag(hi));
+            if (tag == UNIX_TIMESTAMP[15]) {
+                min_ts = static_cast<uint64_t>(lo);
+                max_ts = static_cast<uint64_t>(hi);
+            }
+        } else {
+            for (uint32_t idx : items) {
+                put_varint(data, items_[idx].length);
+                data.insert(data.end(), values_.begin() + items_[idx].offset,
+                            values_.begin() + items_[idx].offset + items_[idx].length);
+            }
+            block.push_back(1);
+        }
+        put_varint(block, items.size());
+        put_varint(block, data.size());
+        block.insert(block.end(), data.begin(), data.end());
+    }
+
+    out_.write(reinterpret_cast<const char*>(block.data()), static_cast<std::streamsize>(block.size()));
+    if (!out_) throw std::runtime_error("Archive write failed");
+    blocks_.push_back(BlockInfo{position_, block.size(), static_cast<uint32_t>(rows_.size()),
+                                min_ts, max_ts});
+    position_ += block.size();
+    rows_.clear();
+    items_.clear();
+    values_.clear();
+}
+
+void ArchiveWriter::close() {
+    if (closed_) return;
+    flush();
+    std::vector<uint8_t> footer;
+    put_varint(footer, blocks_.size());
+    for (const auto& b : blocks_) {
+        put_varint(footer, b.offset);
+        put_varint(footer, b.size);
+        put_varint(footer, b.rows);
+        put_varint(footer, b.min_timestamp);
+        put_varint(footer, b.max_timestamp);
+    }
+    put_le64(footer, position_);
+    footer.insert(footer.end(), ARCHIVE_MAGIC, ARCHIVE_MAGIC + sizeof(ARCHIVE_MAGIC));
+    out_.write(reinterpret_cast<const char*>(footer.data()), static_cast<std::streamsize>(footer.size()));
+    out_.close();
+    closed_ = true;
+}
+
+ArchiveReader::ArchiveReader(const std::string& path)
+    : file_(path), sorted_(true) {
+    const size_t size = file_.size();
+    const uint8_t* data = file_.data();
+    const size_t magic = sizeof(ARCHIVE_MAGIC);
+    if (size < 2 * magic + 8 || std::memcmp(data, ARCHIVE_MAGIC, magic) != 0 ||
+        std::memcmp(data + size - magic, ARCHIVE_MAGIC, magic) != 0) {
+        throw std::runtime_error("Not a KLV columnar archive: " + path);
+    }
+    const uint64_t footer = get_le64(data + size - magic - 8);
+    if (footer < magic || footer > size - magic - 8) {
+        throw std::runtime_error("Corrupt archive footer");
+    }
+    Cursor c{data + footer, data + size - magic - 8};
+    const uint64_t count = c.varint();
+    for (uint64_t i = 0; i < count; ++i) {
+        BlockInfo b;
+        b.offset = c.varint();
+        b.size = c.varint();
+        b.rows = static_cast<uint32_t>(c.varint());
+        b.min_timestamp = c.varint();
+        b.max_timestamp = c.varint();
+        if (b.offset > footer || b.size > footer - b.offset) {
+            throw std::runtime_error("Corrupt archive block index");
+        }
+        if (!blocks_.empty() && b.max_timestamp < blocks_.back().max_timestamp) sorted_ = false;
+        blocks_.push_back(b);
+    }
+}
+
+std::vector<ColumnStats> ArchiveReader::block_stats(size_t i) const {
+    const BlockInfo& b = blocks_.at(i);
+    BlockLayout layout = parse_block(file_.data() + b.offset, static_cast<size_t>(b.size));
+    std::vector<ColumnStats> stats;
+    stats.reserve(layout.columns.size());
+    for (const auto& col : layout.columns) {
+        stats.push_back(col.stats);
+    }
+    return stats;
+}
+
+std::vector<std::vector<uint8_t>> ArchiveReader::read_block(size_t i) const {
+    const BlockInfo& b = blocks_.at(i);
+    BlockLayout block = parse_block(file_.data() + b.offset, static_cast<size_t>(b.size));
+
+    std::array<int, 256> column_of;
+    column_of.fill(-1);
+    for (size_t c = 0; c < block.columns.size(); ++c) {
+        column_of[block.columns[c].stats.tag] = static_cast<int>(c);
+    }
+    std::vector<int64_t> previous(block.columns.size(), 0);
+
+    std::vector<std::vector<uint8_t>> packets;
+    packets.reserve(block.row_layouts.size());
+    std::vector<uint8_t> payload;
+    for (uint32_t layout_id : block.row_layouts) {
+        payload.clear();
+        for (uint8_t tag : block.layouts[layout_id]) {
+            const int c = column_of[tag];
+            if (c < 0) throw std::runtime_error("Archive layout references a missing column");
+            ColumnHeader& col = block.columns[static_cast<size_t>(c)];
+            payload.push_back(tag);
+            if (col.stats.numeric) {
+                const int64_t v = static_cast<int64_t>(
+                    static_cast<uint64_t>(previous[static_cast<size_t>(c)]) +
+                    static_cast<uint64_t>(unzigzag(col.data.varint())));
+                previous[static_cast<size_t>(c)] = v;
+                auto len = misb::encode_ber_length(col.stats.width);
+                payload.insert(payload.end(), len.begin(), len.end());
+                store_raw(payload, v, col.stats.width);
+            } else {
+                const size_t n = static_cast<size_t>(col.data.varint());
+                const uint8_t* value = col.data.take(n);
+                auto len = misb::encode_ber_length(n);
+                payload.insert(payload.end(), len.begin(), len.end());
+                payload.insert(payload.end(), value, value + n);
+            }
+        }
+
+        std::vector<uint8_t> packet;
+        packet.reserve(payload.size() + 32);
+        packet.insert(packet.end(), stanag::UAS_DATALINK_LOCAL_SET_UL.begin(),
+                      stanag::UAS_DATALINK_LOCAL_SET_UL.end());
+        auto len_bytes = misb::encode_ber_length(payload.size() + 4);
+        packet.insert(packet.end(), len_bytes.begin(), len_bytes.end());
+        packet.insert(packet.end(), payload.begin(), payload.end());
+        packet.push_back(0x01);
+        packet.push_back(0x02);
+        const uint16_t crc = misb::klv_checksum_16(packet);
+        packet.push_back(static_cast<uint8_t>((crc >> 8) & 0xFF));
+        packet.push_back(static_cast<uint8_t>(crc & 0xFF));
+        packets.push_back(std::move(packet));
+    }
+    return packets;
+}
+
+size_t ArchiveReader::find_block(uint64_t timestamp) const {
+    if (!sorted_) {
+        for (size_t i = 0; i < blocks_.size(); ++i) {
+            if (blocks_[i].max_timestamp >= timestamp) return i;
+        }
+        return blocks_.size();
+    }
+    auto it = std::lower_bound(blocks_.begin(), blocks_.end(), timestamp,
+                               [](const BlockInfo& b, uint64_t t) {
+                                   return b.max_timestamp < t;
+                               });
+    return static_cast<size_t>(it - blocks_.begin());
+}
+
+} // namespace st0601
+} // namespace misb
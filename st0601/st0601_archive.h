@@ -0,0 +1,118 @@
+#pragma once
+
+#include "klv_mapped_file.h"
+#include "st0601.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace misb {
+namespace st0601 {
+
+// Block-based columnar archive of ST 0601 packets.
+//
+// Packets are grouped in blocks. Inside a block every tag gets its own
+// column: numeric tags keep the transmitted (quantized) integers, delta and
+// zigzag coded as LEB128 varints, other tags keep their raw value bytes.
+// Each row records which layout (ordered tag list) the packet used, so the
+// original STANAG 4609 packets are rebuilt with the same items, in the same
+// order, with the same value bytes. BER lengths are written back in their
+// minimal form: a source using long-form lengths for short values comes
+// back shorter, with a recomputed checksum.
+//
+// File layout:
+//   "KLVCOL01" | block* | footer | u64 footer offset (LE) | "KLVCOL01"
+constexpr char ARCHIVE_MAGIC[8] = {'K','L','V','C','O','L','0','1'};
+
+// Per-block entry of the archive footer
+struct BlockInfo {
+    uint64_t offset;
+    uint64_t size;
+    uint32_t rows;
+    uint64_t min_timestamp;
+    uint64_t max_timestamp;
+};
+
+// Column statistics stored in every block header
+struct ColumnStats {
+    uint8_t tag;
+    bool numeric;     // raw integer column
+    uint8_t width;
+    bool is_signed;
+    uint32_t count;   // number of values in the block
+    int64_t min;      // raw integer bounds (numeric columns only)
+    int64_t max;
+};
+
+class ArchiveWriter {
+public:
+    explicit ArchiveWriter(const std::string& path, size_t rows_per_block = 4096);
+    ~ArchiveWriter();
+    ArchiveWriter(const ArchiveWriter&) = delete;
+    ArchiveWriter& operator=(const ArchiveWriter&) = delete;
+
+    // Append one STANAG 4609 packet with a valid trailing checksum.
+    // Returns false when the packet cannot be parsed.
+    bool append(const uint8_t* packet, size_t size);
+    bool append(const std::vector<uint8_t>& packet) {
+        return append(packet.data(), packet.size());
+    }
+
+    // Encode buffered rows as a block
+    void flush();
+    // Flush and write the footer. Called by the destructor if needed.
+    void close();
+
+    size_t block_count() const { return blocks_.size(); }
+
+private:
+    struct Item {
+        uint8_t tag;
+        uint32_t offset; // into values_
+        uint32_t length;
+    };
+    struct Row {
+        uint32_t first_item;
+        uint32_t item_count;
+    };
+
+    std::ofstream out_;
+    size_t rows_per_block_;
+    uint64_t position_;
+    bool closed_;
+    std::vector<Row> rows_;
+    std::vector<Item> items_;
+    std::vector<uint8_t> values_;
+    std::vector<BlockInfo> blocks_;
+};
+
+class ArchiveReader {
+public:
+    explicit ArchiveReader(const std::string& path);
+
+    size_t block_count() const { return blocks_.size(); }
+    const BlockInfo& block(size_t i) const { return blocks_.at(i); }
+
+    // Column statistics of block |i| without decoding its values
+    std::vector<ColumnStats> block_stats(size_t i) const;
+
+    // Rebuild the STANAG 4609 packets stored in block |i|
+    std::vector<std::vector<uint8_t>> read_block(size_t i) const;
+
+    // First block that may hold packets at or after |timestamp|;
+    // block_count() when none. Binary search when the block maxima never
+    // decrease, else a linear pass: feeds whose clock jumps back and
+    // blocks without timestamps (min = max = 0) break the order.
+    size_t find_block(uint64_t timestamp) const;
+
+private:
+    MappedFile file_;
+    std::vector<BlockInfo> blocks_;
+    bool sorted_;
+};
+
+} // namespace st0601
+} // namespace misb
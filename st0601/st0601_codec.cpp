@@ -0,0 +1,109 @@
+#include "st0601_codec.h"
+#include "st0601.h"
+
+#include <cstddef>
+#include <limits>
+
+namespace misb {
+namespace st0601 {
+
+namespace {
+
+size_t encode_descriptor(const void* params, double value, uint8_t* dst) {
+    const CodecDescriptor& c = *static_cast<const CodecDescriptor*>(params);
+    if (!c.fixed_width()) return st1201::encode(imap_extended_height(), value, dst, KLVCodec::MAX_SIZE);
+    return misb::write_uint_be(dst, c.width, to_raw(c, value), c.width);
+}
+
+double decode_descriptor(const void* params, const uint8_t* data, size_t size) {
+    const CodecDescriptor& c = *static_cast<const CodecDescriptor*>(params);
+    if (!c.fixed_width()) return st1201::decode(imap_extended_height(), data, size);
+    uint64_t raw = 0;
+    if (!read_raw(c, data, size, raw)) return std::numeric_limits<double>::quiet_NaN();
+    return to_engineering(c, raw);
+}
+
+template <size_t... I>
+struct Indices {};
+
+template <size_t N, size_t... I>
+struct MakeIndices : MakeIndices<N - 1, N - 1, I...> {};
+
+template <size_t... I>
+struct MakeIndices<0, I...> {
+    typedef Indices<I...> type;
+};
+
+// Position of |tag| in CODECS, CODEC_COUNT when absent
+constexpr size_t codec_slot(size_t tag, size_t i = 0) {
+    return i == CODEC_COUNT || CODECS[i].tag == tag ? i : codec_slot(tag, i + 1);
+}
+
+// One KLVCodec per CODECS entry and a dense tag -> entry index, both
+// computed during compilation
+template <typename Entries, typename Tags>
+struct Tables;
+
+template <size_t... E, size_t... T>
+struct Tables<Indices<E...>, Indices<T...>> {
+    static constexpr KLVCodec codecs[CODEC_COUNT] = {
+        {CODECS[E].tag, encode_descriptor, decode_descriptor, &CODECS[E]}...
+    };
+    static constexpr uint8_t slots[256] = {static_cast<uint8_t>(codec_slot(T))...};
+};
+
+template <size_t... E, size_t... T>
+constexpr KLVCodec Tables<Indices<E...>, Indices<T...>>::codecs[CODEC_COUNT];
+template <size_t... E, size_t... T>
+constexpr uint8_t Tables<Indices<E...>, Indices<T...>>::slots[256];
+
+typedef Tables<MakeIndices<CODEC_COUNT>::type, MakeIndices<256>::type> Builtin;
+
+static_assert(CODEC_COUNT < 256, "slot index is a byte");
+
+} // namespace
+
+const CodecDescriptor* codec_descriptor(uint8_t tag) {
+    const size_t slot = Builtin::slots[tag];
+    return slot < CODEC_COUNT ? &CODECS[slot] : nullptr;
+}
+
+const KLVCodec* builtin_codec(uint8_t tag) {
+    const size_t slot = Builtin::slots[tag];
+    return slot < CODEC_COUNT ? &Builtin::codecs[slot] : nullptr;
+}
+
+double RawItem::value() const {
+    if (!codec) return std::numeric_limits<double>::quiet_NaN();
+    if (codec->kind == CodecKind::Imap) {
+        return st1201::decode(imap_extended_height(), std::vector<uint8_t>(data, data + length));
+    }
+    return to_engineering(*codec, raw);
+}
+
+bool decode_raw(const uint8_t* payload, size_t size, std::vector<RawItem>& out) {
+    out.clear();
+    size_t i = 0;
+    while (i < size) {
+        const uint8_t tag = payload[i++];
+        size_t len = 0, len_bytes = 0;
+        if (!misb::decode_ber_length(payload, size, i, len, len_bytes)) return false;
+        i += len_bytes;
+        if (len > size - i) return false;
+        RawItem item;
+        item.tag = tag;
+        item.codec = codec_descriptor(tag);
+        item.raw = 0;
+        item.data = payload + i;
+        item.length = len;
+        if (item.codec && item.codec->fixed_width() && !read_raw(*item.codec, item.data, len, item.raw)) {
+            item.codec = nullptr;
+        }
+        out.push_back(item);
+        i += len;
+    }
+    return true;
+}
+
+} // namespace st0601
+} // namespace misb
@@ -0,0 +1,281 @@
+#pragma once
+
+#include "klv_varint.h"
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace misb {
+namespace st0601 {
+
+// How a numeric ST 0601 tag maps its transmitted integer to engineering units
+enum class CodecKind : uint8_t {
+    Unsigned,   // unsigned integer taken as is
+    Signed,     // two's complement integer taken as is
+    Linear,     // unsigned integer spread over [lo, hi]
+    Symmetric,  // signed integer spread over [-hi, hi]; the most negative
+                // value is the "out of range" sentinel
+    Imap        // ST 1201 IMAPB(-900, 40000, 3), variable length
+};
+
+struct CodecDescriptor {
+    uint8_t tag;
+    uint8_t width;   // transmitted bytes, 0 for variable length
+    CodecKind kind;
+    double lo;
+    double hi;
+
+    constexpr bool is_signed() const {
+        return kind == CodecKind::Signed || kind == CodecKind::Symmetric;
+    }
+    constexpr bool fixed_width() const { return width != 0; }
+};
+
+// Numeric ST 0601 tags and their codecs. The built-in registry codecs
+// (builtin_codec) are generated from this table.
+constexpr CodecDescriptor CODECS[] = {
+    {2, 8, CodecKind::Unsigned, 0.0, 0.0},
+    {5, 2, CodecKind::Linear, 0.0, 360.0},
+    {6, 2, CodecKind::Symmetric, -20.0, 20.0},
+    {7, 2, CodecKind::Symmetric, -50.0, 50.0},
+    {8, 1, CodecKind::Unsigned, 0.0, 0.0},
+    {9, 1, CodecKind::Unsigned, 0.0, 0.0},
+    {64, 2, CodecKind::Linear, 0.0, 360.0},
+    {112, 2, CodecKind::Linear, 0.0, 360.0},
+    {50, 2, CodecKind::Symmetric, -20.0, 20.0},
+    {51, 2, CodecKind::Symmetric, -180.0, 180.0},
+    {52, 2, CodecKind::Symmetric, -20.0, 20.0},
+
+    {13, 4, CodecKind::Symmetric, -90.0, 90.0},
+    {14, 4, CodecKind::Symmetric, -180.0, 180.0},
+    {15, 2, CodecKind::Linear, -900.0, 19000.0},
+    {16, 2, CodecKind::Linear, 0.0, 180.0},
+    {17, 2, CodecKind::Linear, 0.0, 180.0},
+    {18, 4, CodecKind::Linear, 0.0, 360.0},
+    {19, 4, CodecKind::Symmetric, -180.0, 180.0},
+    {20, 4, CodecKind::Linear, 0.0, 360.0},
+    {75, 2, CodecKind::Linear, -900.0, 19000.0},
+    {79, 2, CodecKind::Symmetric, -327.0, 327.0},
+    {80, 2, CodecKind::Symmetric, -327.0, 327.0},
+
+    {21, 4, CodecKind::Linear, 0.0, 5000000.0},
+    {22, 2, CodecKind::Linear, 0.0, 10000.0},
+    {40, 4, CodecKind::Symmetric, -90.0, 90.0},
+    {41, 4, CodecKind::Symmetric, -180.0, 180.0},
+    {42, 2, CodecKind::Linear, -900.0, 19000.0},
+    {43, 1, CodecKind::Linear, 0.0, 510.0},
+    {44, 1, CodecKind::Linear, 0.0, 510.0},
+    {45, 2, CodecKind::Linear, 0.0, 4095.0},
+    {46, 2, CodecKind::Linear, 0.0, 4095.0},
+
+    {23, 4, CodecKind::Symmetric, -90.0, 90.0},
+    {24, 4, CodecKind::Symmetric, -180.0, 180.0},
+    {25, 2, CodecKind::Linear, -900.0, 19000.0},
+    {26, 2, CodecKind::Symmetric, -0.15, 0.15},
+    {27, 2, CodecKind::Symmetric, -0.15, 0.15},
+    {28, 2, CodecKind::Symmetric, -0.15, 0.15},
+    {29, 2, CodecKind::Symmetric, -0.15, 0.15},
+    {30, 2, CodecKind::Symmetric, -0.15, 0.15},
+    {31, 2, CodecKind::Symmetric, -0.15, 0.15},
+    {32, 2, CodecKind::Symmetric, -0.15, 0.15},
+    {33, 2, CodecKind::Symmetric, -0.15, 0.15},
+    {82, 4, CodecKind::Symmetric, -90.0, 90.0},
+    {83, 4, CodecKind::Symmetric, -180.0, 180.0},
+    {84, 4, CodecKind::Symmetric, -90.0, 90.0},
+    {85, 4, CodecKind::Symmetric, -180.0, 180.0},
+    {86, 4, CodecKind::Symmetric, -90.0, 90.0},
+    {87, 4, CodecKind::Symmetric, -180.0, 180.0},
+    {88, 4, CodecKind::Symmetric, -90.0, 90.0},
+    {89, 4, CodecKind::Symmetric, -180.0, 180.0},
+
+    {34, 1, CodecKind::Unsigned, 0.0, 0.0},
+    {35, 2, CodecKind::Linear, 0.0, 360.0},
+    {36, 1, CodecKind::Linear, 0.0, 100.0},
+    {37, 2, CodecKind::Linear, 0.0, 5000.0},
+    {38, 2, CodecKind::Linear, -900.0, 19000.0},
+    {39, 1, CodecKind::Signed, 0.0, 0.0},
+    {47, 2, CodecKind::Unsigned, 0.0, 0.0},
+    {49, 2, CodecKind::Linear, 0.0, 5000.0},
+    {53, 2, CodecKind::Linear, 0.0, 5000.0},
+    {54, 2, CodecKind::Linear, -900.0, 19000.0},
+    {55, 1, CodecKind::Linear, 0.0, 100.0},
+
+    {56, 1, CodecKind::Unsigned, 0.0, 0.0},
+    {57, 4, CodecKind::Linear, 0.0, 5000000.0},
+    {58, 2, CodecKind::Linear, 0.0, 10000.0},
+    {60, 2, CodecKind::Unsigned, 0.0, 0.0},
+    {61, 1, CodecKind::Unsigned, 0.0, 0.0},
+    {62, 2, CodecKind::Unsigned, 0.0, 0.0},
+    {63, 1, CodecKind::Unsigned, 0.0, 0.0},
+    {65, 1, CodecKind::Unsigned, 0.0, 0.0},
+    {67, 4, CodecKind::Symmetric, -90.0, 90.0},
+    {68, 4, CodecKind::Symmetric, -180.0, 180.0},
+    {69, 2, CodecKind::Linear, -900.0, 19000.0},
+    {71, 2, CodecKind::Linear, 0.0, 360.0},
+    {72, 8, CodecKind::Unsigned, 0.0, 0.0},
+    {76, 2, CodecKind::Linear, -900.0, 19000.0},
+    {78, 2, CodecKind::Linear, -900.0, 19000.0},
+
+    {90, 4, CodecKind::Symmetric, -90.0, 90.0},
+    {91, 4, CodecKind::Symmetric, -90.0, 90.0},
+    {92, 4, CodecKind::Symmetric, -90.0, 90.0},
+    {93, 4, CodecKind::Symmetric, -90.0, 90.0},
+
+    {94, 2, CodecKind::Unsigned, 0.0, 0.0},
+    {95, 2, CodecKind::Unsigned, 0.0, 0.0},
+    {96, 2, CodecKind::Unsigned, 0.0, 0.0},
+    {97, 2, CodecKind::Unsigned, 0.0, 0.0},
+    {98, 2, CodecKind::Unsigned, 0.0, 0.0},
+    {99, 2, CodecKind::Unsigned, 0.0, 0.0},
+    {100, 2, CodecKind::Unsigned, 0.0, 0.0},
+    {101, 2, CodecKind::Unsigned, 0.0, 0.0},
+    {102, 2, CodecKind::Unsigned, 0.0, 0.0},
+    {103, 0, CodecKind::Imap, -900.0, 40000.0},
+    {104, 0, CodecKind::Imap, -900.0, 40000.0},
+    {105, 0, CodecKind::Imap, -900.0, 40000.0},
+    {107, 2, CodecKind::Unsigned, 0.0, 0.0},
+    {108, 2, CodecKind::Unsigned, 0.0, 0.0},
+    {109, 2, CodecKind::Unsigned, 0.0, 0.0},
+    {110, 2, CodecKind::Unsigned, 0.0, 0.0},
+    {111, 2, CodecKind::Unsigned, 0.0, 0.0},
+    {113, 2, CodecKind::Unsigned, 0.0, 0.0},
+    {114, 2, CodecKind::Unsigned, 0.0, 0.0},
+    {115, 2, CodecKind::Unsigned, 0.0, 0.0},
+    {116, 2, CodecKind::Unsigned, 0.0, 0.0},
+    {117, 2, CodecKind::Unsigned, 0.0, 0.0},
+    {118, 2, CodecKind::Unsigned, 0.0, 0.0},
+    {119, 2, CodecKind::Unsigned, 0.0, 0.0},
+    {120, 2, CodecKind::Unsigned, 0.0, 0.0},
+    {121, 2, CodecKind::Unsigned, 0.0, 0.0},
+    {122, 2, CodecKind::Unsigned, 0.0, 0.0},
+    {123, 2, CodecKind::Unsigned, 0.0, 0.0},
+    {124, 2, CodecKind::Unsigned, 0.0, 0.0},
+    {125, 2, CodecKind::Unsigned, 0.0, 0.0},
+    {126, 2, CodecKind::Unsigned, 0.0, 0.0},
+    {127, 2, CodecKind::Unsigned, 0.0, 0.0},
+    {128, 2, CodecKind::Unsigned, 0.0, 0.0},
+    {129, 2, CodecKind::Unsigned, 0.0, 0.0},
+    {130, 2, CodecKind::Unsigned, 0.0, 0.0},
+    {131, 2, CodecKind::Unsigned, 0.0, 0.0},
+    {132, 2, CodecKind::Unsigned, 0.0, 0.0},
+    {133, 2, CodecKind::Unsigned, 0.0, 0.0},
+    {134, 2, CodecKind::Unsigned, 0.0, 0.0},
+    {135, 2, CodecKind::Unsigned, 0.0, 0.0},
+    {136, 2, CodecKind::Unsigned, 0.0, 0.0},
+    {137, 2, CodecKind::Unsigned, 0.0, 0.0},
+    {138, 2, CodecKind::Unsigned, 0.0, 0.0},
+    {139, 2, CodecKind::Unsigned, 0.0, 0.0},
+    {140, 2, CodecKind::Unsigned, 0.0, 0.0},
+    {141, 2, CodecKind::Unsigned, 0.0, 0.0},
+    {142, 2, CodecKind::Unsigned, 0.0, 0.0},
+
+    {81, 2, CodecKind::Unsigned, 0.0, 0.0},
+    {77, 1, CodecKind::Unsigned, 0.0, 0.0},
+};
+
+constexpr size_t CODEC_COUNT = sizeof(CODECS) / sizeof(CODECS[0]);
+
+// Compile-time lookup; nullptr for tags without a numeric codec
+constexpr const CodecDescriptor* find_codec(uint8_t tag, size_t i = 0) {
+    return i == CODEC_COUNT ? nullptr : (CODECS[i].tag == tag ? &CODECS[i] : find_codec(tag, i + 1));
+}
+
+// Run-time lookup through a dense table built during compilation
+const CodecDescriptor* codec_descriptor(uint8_t tag);
+
+// Largest transmitted integer of a fixed-width codec: 2^(8w)-1, or
+// 2^(8w-1)-1 when signed
+constexpr uint64_t raw_max(const CodecDescriptor& c) {
+    return c.width >= 8 ? (c.is_signed() ? uint64_t{0x7FFFFFFFFFFFFFFF} : ~uint64_t{0})
+                        : (uint64_t{1} << (c.width * 8 - (c.is_signed() ? 1 : 0))) - 1;
+}
+
+// Transmitted integer of a fixed-width codec to engineering units. Signed
+// values are passed sign-extended.
+inline double to_engineering(const CodecDescriptor& c, uint64_t raw) {
+    const double top = static_cast<double>(raw_max(c));
+    switch (c.kind) {
+    case CodecKind::Unsigned:
+        return static_cast<double>(raw);
+    case CodecKind::Signed:
+        return static_cast<double>(static_cast<int64_t>(raw));
+    case CodecKind::Linear:
+        return c.lo + static_cast<double>(raw) * ((c.hi - c.lo) / top);
+    case CodecKind::Symmetric: {
+        const int64_t v = static_cast<int64_t>(raw);
+        if (v == -static_cast<int64_t>(raw_max(c)) - 1) return std::numeric_limits<double>::quiet_NaN();
+        return static_cast<double>(v) * (c.hi / top);
+    }
+    default:
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+}
+
+// Engineering units to the transmitted integer of a fixed-width codec,
+// clamping like the registered encoders; signed results are sign-extended
+inline uint64_t to_raw(const CodecDescriptor& c, double v) {
+    const double top = static_cast<double>(raw_max(c));
+    switch (c.kind) {
+    case CodecKind::Unsigned:
+        if (!(v > 0.0)) return 0;
+        return v >= top ? raw_max(c) : static_cast<uint64_t>(v);
+    case CodecKind::Signed: {
+        const double lo = -top - 1.0;
+        return static_cast<uint64_t>(static_cast<int64_t>(v < lo ? lo : (v > top ? top : v)));
+    }
+    case CodecKind::Linear: {
+        const double clamped = v < c.lo ? c.lo : (v > c.hi ? c.hi : v);
+        return static_cast<uint64_t>(std::llround((clamped - c.lo) * (top / (c.hi - c.lo))));
+    }
+    case CodecKind::Symmetric: {
+        if (std::isnan(v)) return static_cast<uint64_t>(-static_cast<int64_t>(raw_max(c)) - 1);
+        const double clamped = v < -c.hi ? -c.hi : (v > c.hi ? c.hi : v);
+        return static_cast<uint64_t>(std::llround(clamped * (top / c.hi)));
+    }
+    default:
+        return 0;
+    }
+}
+
+// Numeric item of a local set read without conversion. |raw| holds the
+// transmitted integer (sign-extended for signed codecs); value() converts
+// on demand.
+struct RawItem {
+    uint8_t tag;
+    const CodecDescriptor* codec;  // nullptr: no numeric codec or length
+                                   // not matching the codec width
+    uint64_t raw;
+    const uint8_t* data;           // value bytes, inside the decoded payload
+    size_t length;
+
+    bool numeric() const { return codec && codec->fixed_width(); }
+    int64_t as_signed() const { return static_cast<int64_t>(raw); }
+    uint64_t as_unsigned() const { return raw; }
+    // Symmetric codec "out of range" marker (0x8000, 0x80000000)
+    bool is_sentinel() const {
+        return codec && codec->kind == CodecKind::Symmetric &&
+               as_signed() == -static_cast<int64_t>(raw_max(*codec)) - 1;
+    }
+    // Engineering units; ST 1201 tags decode from |data|, NaN otherwise
+    double value() const;
+};
+
+// Read the transmitted integer of one fixed-width item; false when |size|
+// does not match the codec width
+inline bool read_raw(const CodecDescriptor& c, const uint8_t* data, size_t size, uint64_t& raw) {
+    if (!c.fixed_width() || size != c.width) return false;
+    misb::read_uint_be(data, size, c.width, raw);
+    if (c.is_signed()) raw = static_cast<uint64_t>(misb::sign_extend(raw, c.width));
+    return true;
+}
+
+// Split a local set payload (Tag-Length-Value items) into raw items without
+// any codec call or allocation beyond |out|, which is cleared first. Items
+// past a malformed length are dropped; returns false in that case.
+bool decode_raw(const uint8_t* payload, size_t size, std::vector<RawItem>& out);
+
+} // namespace st0601
+} // namespace misb
@@ -0,0 +1,147 @@
+#pragma once
+
+#include "klv_varint.h"
+#include "st0601.h"
+#include "st0601_codec.h"
+#include "st_common.h"
+#include "stanag.h"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+namespace misb {
+namespace st0601 {
+
+namespace detail {
+
+constexpr size_t fixed_uint_width(size_t n) {
+    return n == 0 ? 0 : 1 + fixed_uint_width(n >> 8);
+}
+
+constexpr size_t fixed_ber_size(size_t n) {
+    return n < 0x80 ? 1 : 1 + fixed_uint_width(n);
+}
+
+constexpr bool fixed_codec(uint8_t tag) {
+    return find_codec(tag) != nullptr && find_codec(tag)->fixed_width();
+}
+
+// Tag byte, one-byte length and value
+constexpr size_t fixed_item_size(uint8_t tag) {
+    return 2 + find_codec(tag)->width;
+}
+
+// 64-bit unsigned tags (timestamps) are passed as integers to stay exact
+template <uint8_t Tag>
+struct FixedValue {
+    typedef typename std::conditional<fixed_codec(Tag) &&
+                                          find_codec(Tag)->kind == CodecKind::Unsigned &&
+                                          find_codec(Tag)->width == 8,
+                                      uint64_t, double>::type type;
+};
+
+inline uint64_t fixed_raw(const CodecDescriptor& codec, double value) {
+    return to_raw(codec, value);
+}
+
+inline uint64_t fixed_raw(const CodecDescriptor&, uint64_t value) {
+    return value;
+}
+
+template <uint8_t... Tags>
+struct FixedItems;
+
+template <>
+struct FixedItems<> {
+    static constexpr size_t size = 0;
+    static constexpr size_t offset(size_t) { return 0; }
+    static void write(uint8_t*) {}
+};
+
+template <uint8_t Tag, uint8_t... Rest>
+struct FixedItems<Tag, Rest...> {
+    static_assert(fixed_codec(Tag), "FixedPacket tags need a fixed-width ST 0601 codec");
+
+    static constexpr size_t size = fixed_item_size(Tag) + FixedItems<Rest...>::size;
+
+    // Offset of item |i| from the start of the payload
+    static constexpr size_t offset(size_t i) {
+        return i == 0 ? 0 : fixed_item_size(Tag) + FixedItems<Rest...>::offset(i - 1);
+    }
+
+    template <typename... Values>
+    static void write(uint8_t* p, typename FixedValue<Tag>::type value, Values... rest) {
+        constexpr const CodecDescriptor* codec = find_codec(Tag);
+        p[0] = Tag;
+        p[1] = codec->width;
+        misb::write_uint_be(p + 2, codec->width, fixed_raw(*codec, value), codec->width);
+        FixedItems<Rest...>::write(p + 2 + codec->width, rest...);
+    }
+};
+
+} // namespace detail
+
+// STANAG 4609 packet of a tag list fixed at compile time. Sizes, offsets and
+// codecs come from the codec table during compilation, so encode() writes
+// straight into a std::array: no registry lookup, no virtual call and no
+// allocation. Values are in engineering units, in the order of |Tags|
+// (uint64_t microseconds for UNIX_TIMESTAMP and other 64-bit counters).
+// The bytes equal those of create_stanag4609_packet for the same tags.
+//
+//   using Telemetry = FixedPacket<tags::UNIX_TIMESTAMP, tags::SENSOR_LATITUDE,
+//                                 tags::SENSOR_LONGITUDE>;
+//   Telemetry::Buffer packet = Telemetry::encode(now_us, 45.0, -75.0);
+template <uint8_t... Tags>
+class FixedPacket {
+    typedef detail::FixedItems<Tags...> Items;
+
+public:
+    static constexpr size_t ITEM_COUNT = sizeof...(Tags);
+    // Items plus the checksum item
+    static constexpr size_t PAYLOAD_SIZE = Items::size + 4;
+    static constexpr size_t HEADER_SIZE =
+        sizeof(stanag::UAS_DATALINK_LOCAL_SET_UL) + detail::fixed_ber_size(PAYLOAD_SIZE);
+    static constexpr size_t SIZE = HEADER_SIZE + PAYLOAD_SIZE;
+
+    typedef std::array<uint8_t, SIZE> Buffer;
+
+    // Position of the value bytes of item |i| inside the packet
+    static constexpr size_t value_offset(size_t i) {
+        return HEADER_SIZE + Items::offset(i) + 2;
+    }
+
+    static void encode_into(Buffer& out, typename detail::FixedValue<Tags>::type... values) {
+        std::copy(stanag::UAS_DATALINK_LOCAL_SET_UL.begin(), stanag::UAS_DATALINK_LOCAL_SET_UL.end(),
+                  out.begin());
+        misb::write_ber_length(out.data() + sizeof(stanag::UAS_DATALINK_LOCAL_SET_UL),
+                               HEADER_SIZE - sizeof(stanag::UAS_DATALINK_LOCAL_SET_UL), PAYLOAD_SIZE);
+        Items::write(out.data() + HEADER_SIZE, values...);
+        uint8_t* crc = out.data() + SIZE - 4;
+        crc[0] = 0x01;
+        crc[1] = 0x02;
+        const uint16_t sum = misb::klv_checksum_16(0, out.data(), SIZE - 2, 0);
+        crc[2] = static_cast<uint8_t>(sum >> 8);
+        crc[3] = static_cast<uint8_t>(sum & 0xFF);
+    }
+
+    static Buffer encode(typename detail::FixedValue<Tags>::type... values) {
+        Buffer out;
+        encode_into(out, values...);
+        return out;
+    }
+};
+
+template <uint8_t... Tags>
+constexpr size_t FixedPacket<Tags...>::ITEM_COUNT;
+template <uint8_t... Tags>
+constexpr size_t FixedPacket<Tags...>::PAYLOAD_SIZE;
+template <uint8_t... Tags>
+constexpr size_t FixedPacket<Tags...>::HEADER_SIZE;
+template <uint8_t... Tags>
+constexpr size_t FixedPacket<Tags...>::SIZE;
+
+} // namespace st0601
+} // namespace misb
@@ -0,0 +1,160 @@
+#include "st0601_history.h"
+
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+namespace misb {
+namespace st0601 {
+
+AngleWrap angle_wrap(uint8_t tag) {
+    switch (tag) {
+    case 5:   // platform heading
+    case 18:  // sensor relative azimuth
+    case 20:  // sensor relative roll
+    case 35:  // wind direction
+    case 64:  // platform magnetic heading
+    case 71:  // alternate platform heading
+    case 112: // platform course angle
+        return AngleWrap::Unsigned360;
+    case 14:  // sensor longitude
+    case 19:  // sensor relative elevation
+    case 24:  // frame center longitude
+    case 41:  // target longitude
+    case 68:  // alternate platform longitude
+    case 83:  // corner longitudes, full range
+    case 85:
+    case 87:
+    case 89:
+        return AngleWrap::Signed180;
+    default:
+        return AngleWrap::None;
+    }
+}
+
+FeedHistory::FeedHistory(size_t capacity, const std::vector<uint8_t>& tags)
+    : tags_(tags),
+      columns_(FeedState::SLOT_COUNT, -1),
+      wraps_(tags.size(), AngleWrap::None),
+      times_(capacity, 0),
+      values_(capacity * tags.size(), 0.0),
+      scratch_(tags.size(), 0.0),
+      capacity_(capacity),
+      head_(0),
+      size_(0) {
+    if (capacity == 0) {
+        throw std::invalid_argument("FeedHistory capacity must be positive");
+    }
+    for (size_t i = 0; i < tags_.size(); ++i) {
+        if (columns_[tags_[i]] != -1) {
+            throw std::invalid_argument("Duplicate tag in FeedHistory");
+        }
+        columns_[tags_[i]] = static_cast<int>(i);
+        wraps_[i] = angle_wrap(tags_[i]);
+    }
+}
+
+bool FeedHistory::push(uint64_t timestamp, const double* values) {
+    size_t row;
+    if (size_ > 0 && timestamp <= newest()) {
+        if (timestamp < newest()) return false;
+        row = physical(size_ - 1);
+    } else if (size_ < capacity_) {
+        row = physical(size_);
+        ++size_;
+    } else {
+        // Full: overwrite the oldest sample
+        row = head_;
+        head_ = (head_ + 1) % capacity_;
+    }
+    times_[row] = timestamp;
+    for (size_t c = 0; c < tags_.size(); ++c) {
+        values_[c * capacity_ + row] = values[c];
+    }
+    return true;
+}
+
+bool FeedHistory::push(const FeedState& state) {
+    for (size_t c = 0; c < tags_.size(); ++c) {
+        scratch_[c] = state.value(tags_[c]);
+    }
+    return push(state.timestamp(), scratch_.data());
+}
+
+uint64_t FeedHistory::oldest() const {
+    return size_ ? time_at(0) : 0;
+}
+
+uint64_t FeedHistory::newest() const {
+    return size_ ? time_at(size_ - 1) : 0;
+}
+
+size_t FeedHistory::floor_index(uint64_t timestamp) const {
+    if (size_ == 0 || timestamp < time_at(0)) return size_;
+    size_t lo = 0;
+    size_t hi = size_;
+    while (hi - lo > 1) {
+        const size_t mid = lo + (hi - lo) / 2;
+        if (time_at(mid) <= timestamp) {
+            lo = mid;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+double FeedHistory::interpolate(size_t col, size_t lo, size_t hi, double f) const {
+    const double* column = values_.data() + col * capacity_;
+    const double a = column[physical(lo)];
+    if (lo == hi || f == 0.0) return a;
+    const double b = column[physical(hi)];
+    const AngleWrap wrap = wraps_[col];
+    if (wrap == AngleWrap::None) return a + (b - a) * f;
+    double delta = std::fmod(b - a, 360.0);
+    if (delta > 180.0) delta -= 360.0;
+    else if (delta < -180.0) delta += 360.0;
+    // Normalize on [0, 360), shifted by half a turn for signed angles
+    const double shift = wrap == AngleWrap::Signed180 ? 180.0 : 0.0;
+    double v = std::fmod(a + delta * f + shift, 360.0);
+    if (v < 0.0) v += 360.0;
+    return v - shift;
+}
+
+bool FeedHistory::sample_at(uint64_t timestamp, double* out) const {
+    const size_t lo = floor_index(timestamp);
+    if (lo == size_) return false;
+    size_t hi = lo;
+    double f = 0.0;
+    const uint64_t t0 = time_at(lo);
+    if (t0 != timestamp) {
+        if (lo + 1 >= size_) return false;
+        hi = lo + 1;
+        const uint64_t t1 = time_at(hi);
+        f = static_cast<double>(timestamp - t0) / static_cast<double>(t1 - t0);
+    }
+    for (size_t c = 0; c < tags_.size(); ++c) {
+        out[c] = interpolate(c, lo, hi, f);
+    }
+    return true;
+}
+
+double FeedHistory::value_at(uint64_t timestamp, uint8_t tag) const {
+    const int col = columns_[tag];
+    const size_t lo = floor_index(timestamp);
+    if (col < 0 || lo == size_) return std::numeric_limits<double>::quiet_NaN();
+    const uint64_t t0 = time_at(lo);
+    if (t0 == timestamp) return interpolate(static_cast<size_t>(col), lo, lo, 0.0);
+    if (lo + 1 >= size_) return std::numeric_limits<double>::quiet_NaN();
+    const uint64_t t1 = time_at(lo + 1);
+    const double f = static_cast<double>(timestamp - t0) / static_cast<double>(t1 - t0);
+    return interpolate(static_cast<size_t>(col), lo, lo + 1, f);
+}
+
+void FeedHistory::clear() {
+    head_ = 0;
+    size_ = 0;
+}
+
+} // namespace st0601
+} // namespace misb
@@ -0,0 +1,78 @@
+#pragma once
+
+#include "st0601.h"
+#include "st0601_state.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace misb {
+namespace st0601 {
+
+// How a tag wraps around the circle when interpolated
+enum class AngleWrap : uint8_t {
+    None,
+    Unsigned360, // 0..360 degrees: headings, azimuths, wind direction
+    Signed180    // -180..180 degrees: longitudes, relative elevation
+};
+
+// Wrap class of an ST 0601 tag. Wrapping angles are interpolated the short
+// way around and normalized into [0, 360) or [-180, 180).
+AngleWrap angle_wrap(uint8_t tag);
+
+// Bounded per-feed history of decoded ST 0601 samples keyed by
+// UNIX_TIMESTAMP. Samples are stored column by column in a ring buffer so a
+// query at an arbitrary time (e.g. a video frame PTS) is a binary search
+// followed by an interpolation of the tracked tags.
+class FeedHistory {
+public:
+    FeedHistory(size_t capacity, const std::vector<uint8_t>& tags);
+
+    // Append a sample holding one value per tracked tag, in the order given
+    // at construction. Timestamps must be non-decreasing; a sample with the
+    // newest timestamp replaces it. Returns false for out-of-order samples.
+    bool push(uint64_t timestamp, const double* values);
+
+    // Append the tracked tags of a carry-forward state at its timestamp
+    bool push(const FeedState& state);
+
+    // Interpolate every tracked tag at |timestamp|. Returns false when the
+    // time lies outside the buffered range.
+    bool sample_at(uint64_t timestamp, double* out) const;
+
+    // Interpolate a single tag. NaN when untracked or out of range.
+    double value_at(uint64_t timestamp, uint8_t tag) const;
+
+    // Column index of a tracked tag, or -1
+    int column(uint8_t tag) const { return columns_[tag]; }
+
+    const std::vector<uint8_t>& tags() const { return tags_; }
+    size_t size() const { return size_; }
+    size_t capacity() const { return capacity_; }
+    bool empty() const { return size_ == 0; }
+    uint64_t oldest() const;
+    uint64_t newest() const;
+
+    void clear();
+
+private:
+    size_t physical(size_t logical) const { return (head_ + logical) % capacity_; }
+    uint64_t time_at(size_t logical) const { return times_[physical(logical)]; }
+    // Index of the last sample at or before |timestamp|; size_ when none
+    size_t floor_index(uint64_t timestamp) const;
+    double interpolate(size_t col, size_t lo, size_t hi, double f) const;
+
+    std::vector<uint8_t> tags_;
+    std::vector<int> columns_;
+    std::vector<AngleWrap> wraps_;
+    std::vector<uint64_t> times_;
+    std::vector<double> values_; // column-major, capacity_ rows per column
+    std::vector<double> scratch_;
+    size_t capacity_;
+    size_t head_;
+    size_t size_;
+};
+
+} // namespace st0601
+} // namespace misb
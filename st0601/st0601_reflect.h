@@ -0,0 +1,242 @@
+#pragma once
+
+#include "klv_varint.h"
+#include "st0601.h"
+#include "st0601_codec.h"
+#include "st1201.h"
+#include "st_common.h"
+#include "stanag.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+/*
+ * Binding of plain structs to ST 0601 tags, in the style of ST0601_TAGS:
+ *
+ *   struct Telemetry {
+ *       uint64_t time;
+ *       double lat, lon;
+ *       std::string platform;
+ *   };
+ *   #define TELEMETRY_FIELDS(X) \
+ *       X(time, UNIX_TIMESTAMP) \
+ *       X(lat, SENSOR_LATITUDE) \
+ *       X(lon, SENSOR_LONGITUDE) \
+ *       X(platform, PLATFORM_DESIGNATION)
+ *   KLV_ST0601_STRUCT(Telemetry, TELEMETRY_FIELDS)
+ *
+ *   std::vector<uint8_t> packet = misb::st0601::encode_struct(t);
+ *   misb::st0601::decode_struct_packet(packet.data(), packet.size(), t);
+ *
+ * KLV_ST0601_STRUCT goes in the namespace of the struct. It generates one
+ * writer walking the fields in FIELDS order and one switch over the tag
+ * byte for reading, so both paths go straight between the members and
+ * the bytes: no TagValue, no KLVSet and no registry lookup. Codecs come from
+ * the CODECS table at compile time; a member type that does not suit its
+ * tag (a string on a numeric tag, a double on a text tag) fails to compile.
+ *
+ * Arithmetic members hold engineering units, except that integer members
+ * of 64-bit integer tags (UNIX_TIMESTAMP...) carry the exact count.
+ * std::string and std::vector<uint8_t> members hold the value bytes of
+ * text and nested local set tags.
+ */
+
+namespace misb {
+namespace st0601 {
+
+namespace detail {
+
+template <typename M>
+inline uint64_t struct_raw(const CodecDescriptor& c, M value, std::true_type) {
+    const bool exact = c.width == 8 && (c.kind == CodecKind::Unsigned || c.kind == CodecKind::Signed);
+    return exact ? static_cast<uint64_t>(value) : to_raw(c, static_cast<double>(value));
+}
+
+template <typename M>
+inline uint64_t struct_raw(const CodecDescriptor& c, M value, std::false_type) {
+    return to_raw(c, static_cast<double>(value));
+}
+
+template <typename M>
+inline M struct_value(const CodecDescriptor& c, uint64_t raw, std::true_type) {
+    const bool exact = c.kind == CodecKind::Unsigned || c.kind == CodecKind::Signed;
+    return exact ? static_cast<M>(raw) : static_cast<M>(to_engineering(c, raw));
+}
+
+template <typename M>
+inline M struct_value(const CodecDescriptor& c, uint64_t raw, std::false_type) {
+    return static_cast<M>(to_engineering(c, raw));
+}
+
+// Appends the local set items of one struct
+class StructWriter {
+public:
+    explicit StructWriter(std::vector<uint8_t>& out) : out_(out) {}
+
+    template <uint8_t Tag, typename M>
+    typename std::enable_if<std::is_arithmetic<M>::value>::type field(M value) {
+        static_assert(find_codec(Tag) != nullptr, "arithmetic member bound to a non-numeric ST 0601 tag");
+        constexpr const CodecDescriptor* codec = find_codec(Tag);
+        if (!codec->fixed_width()) {
+            const st1201::Imap& imap = imap_extended_height();
+            uint8_t* p = grow(2 + imap.length);
+            p[0] = Tag;
+            p[1] = static_cast<uint8_t>(imap.length);
+            st1201::encode(imap, static_cast<double>(value), p + 2, imap.length);
+            return;
+        }
+        uint8_t* p = grow(2 + codec->width);
+        p[0] = Tag;
+        p[1] = codec->width;
+        misb::write_uint_be(p + 2, codec->width,
+                            struct_raw(*codec, value, std::is_integral<M>()), codec->width);
+    }
+
+    template <uint8_t Tag>
+    void field(const std::string& value) {
+        static_assert(find_codec(Tag) == nullptr, "string member bound to a numeric ST 0601 tag");
+        bytes(Tag, reinterpret_cast<const uint8_t*>(value.data()), value.size());
+    }
+
+    template <uint8_t Tag>
+    void field(const std::vector<uint8_t>& value) {
+        static_assert(find_codec(Tag) == nullptr, "byte member bound to a numeric ST 0601 tag");
+        bytes(Tag, value.data(), value.size());
+    }
+
+private:
+    uint8_t* grow(size_t n) {
+        const size_t at = out_.size();
+        out_.resize(at + n);
+        return out_.data() + at;
+    }
+
+    void bytes(uint8_t tag, const uint8_t* data, size_t size) {
+        const size_t len_bytes = misb::ber_length_size(size);
+        uint8_t* p = grow(1 + len_bytes + size);
+        p[0] = tag;
+        misb::write_ber_length(p + 1, len_bytes, size);
+        std::copy(data, data + size, p + 1 + len_bytes);
+    }
+
+    std::vector<uint8_t>& out_;
+};
+
+// Stores one item into its member. Values whose length does not match the
+// codec leave the member untouched.
+template <uint8_t Tag, typename M>
+inline typename std::enable_if<std::is_arithmetic<M>::value>::type
+read_field(M& member, const uint8_t* data, size_t size) {
+    static_assert(find_codec(Tag) != nullptr, "arithmetic member bound to a non-numeric ST 0601 tag");
+    constexpr const CodecDescriptor* codec = find_codec(Tag);
+    if (!codec->fixed_width()) {
+        if (size > 0 && size <= 8) member = static_cast<M>(st1201::decode(imap_extended_height(), data, size));
+        return;
+    }
+    uint64_t raw = 0;
+    if (read_raw(*codec, data, size, raw)) member = struct_value<M>(*codec, raw, std::is_integral<M>());
+}
+
+template <uint8_t Tag>
+inline void read_field(std::string& member, const uint8_t* data, size_t size) {
+    member.assign(reinterpret_cast<const char*>(data), size);
+}
+
+template <uint8_t Tag>
+inline void read_field(std::vector<uint8_t>& member, const uint8_t* data, size_t size) {
+    member.assign(data, data + size);
+}
+
+} // namespace detail
+
+#define KLV_ST0601_WRITE_FIELD(member, TAG) \
+    w.field< ::misb::st0601::tags::TAG>(s.member);
+
+#define KLV_ST0601_READ_FIELD(member, TAG) \
+    case ::misb::st0601::tags::TAG: \
+        ::misb::st0601::detail::read_field< ::misb::st0601::tags::TAG>(s.member, data, size); \
+        break;
+
+// Generates the writer and reader of |Type| from FIELDS(X), X(member, TAG)
+// naming the tags of ST0601_TAGS. A tag bound twice fails to compile.
+#define KLV_ST0601_STRUCT(Type, FIELDS) \
+    inline void klv_st0601_write(const Type& s, ::misb::st0601::detail::StructWriter& w) { \
+        FIELDS(KLV_ST0601_WRITE_FIELD) \
+    } \
+    inline void klv_st0601_read(Type& s, uint8_t tag, const uint8_t* data, size_t size) { \
+        switch (tag) { \
+        FIELDS(KLV_ST0601_READ_FIELD) \
+        default: \
+            break; \
+        } \
+    }
+
+// Append the local set items of |s|, without packet header or checksum
+template <typename T>
+void encode_struct_items(const T& s, std::vector<uint8_t>& out) {
+    detail::StructWriter w(out);
+    klv_st0601_write(s, w);
+}
+
+// Append one STANAG 4609 packet holding the bound members of |s|. The bytes
+// equal those of create_stanag4609_packet for the same tags in member order.
+template <typename T>
+void encode_struct_into(const T& s, std::vector<uint8_t>& out) {
+    const size_t start = out.size();
+    out.insert(out.end(), stanag::UAS_DATALINK_LOCAL_SET_UL.begin(), stanag::UAS_DATALINK_LOCAL_SET_UL.end());
+    const size_t len_at = out.size();
+    encode_struct_items(s, out);
+    const size_t payload = out.size() - len_at + 4;
+    const size_t len_bytes = misb::ber_length_size(payload);
+    out.insert(out.begin() + len_at, len_bytes, 0);
+    misb::write_ber_length(out.data() + len_at, len_bytes, payload);
+    out.push_back(0x01);
+    out.push_back(0x02);
+    const uint16_t crc = misb::klv_checksum_16(0, out.data() + start, out.size() - start, 0);
+    out.push_back(static_cast<uint8_t>(crc >> 8));
+    out.push_back(static_cast<uint8_t>(crc & 0xFF));
+}
+
+template <typename T>
+std::vector<uint8_t> encode_struct(const T& s) {
+    std::vector<uint8_t> out;
+    encode_struct_into(s, out);
+    return out;
+}
+
+// Store the items of a local set payload into the bound members of |s|.
+// Members whose tag is absent keep their value; unbound tags are skipped.
+// Returns false, after storing the items before it, on a malformed length.
+template <typename T>
+bool decode_struct(const uint8_t* payload, size_t size, T& s) {
+    size_t i = 0;
+    while (i < size) {
+        const uint8_t tag = payload[i++];
+        size_t len = 0, len_bytes = 0;
+        if (!misb::decode_ber_length(payload, size, i, len, len_bytes)) return false;
+        i += len_bytes;
+        if (len > size - i) return false;
+        klv_st0601_read(s, tag, payload + i, len);
+        i += len;
+    }
+    return true;
+}
+
+// Decode one complete packet; false when it is not framed as a STANAG 4609
+// packet or its checksum does not match
+template <typename T>
+bool decode_struct_packet(const uint8_t* packet, size_t size, T& s) {
+    stanag::PacketView view;
+    if (!stanag::find_next_packet(packet, size, 0, view) || view.offset != 0 ||
+        !stanag::verify_packet_checksum(packet, view.length)) {
+        return false;
+    }
+    return decode_struct(packet + view.payload_offset, view.payload_length, s);
+}
+
+} // namespace st0601
+} // namespace misb
@@ -0,0 +1,182 @@
+#include "st0601_scan.h"
+#include "st0601_codec.h"
+#include "st_common.h"
+
+#include <algorithm>
+#include <bitset>
+#include <limits>
+#include <stdexcept>
+
+namespace misb {
+namespace st0601 {
+
+namespace {
+
+int64_t quantize(const UL& ul, uint8_t tag, double value) {
+    const KLVCodecRef codec = KLVRegistry::instance().lookup(ul);
+    if (!codec) throw std::runtime_error("Unknown UL in scan predicate");
+    const auto bytes = codec.encode(value);
+    uint64_t raw = 0;
+    if (!read_raw(*codec_descriptor(tag), bytes.data(), bytes.size(), raw)) {
+        throw std::runtime_error("Unexpected codec width in scan predicate");
+    }
+    return static_cast<int64_t>(raw);
+}
+
+} // namespace
+
+ScanQuery::ScanQuery() {
+    slot_.fill(-1);
+}
+
+ScanQuery& ScanQuery::where_raw(uint8_t tag, int64_t lo, int64_t hi) {
+    RawFormat f;
+    if (!raw_format(tag, f)) throw std::invalid_argument("Tag is not a numeric ST 0601 item");
+    if (slot_[tag] >= 0) {
+        RangePredicate& p = predicates_[static_cast<size_t>(slot_[tag])];
+        p.lo = std::max(p.lo, lo);
+        p.hi = std::min(p.hi, hi);
+        return *this;
+    }
+    slot_[tag] = static_cast<int>(predicates_.size());
+    predicates_.push_back(RangePredicate{tag, f, lo, hi});
+    return *this;
+}
+
+ScanQuery& ScanQuery::where(const UL& ul, double lo, double hi) {
+    const uint8_t tag = ul[15];
+    if (ul != make_st_ul(ST_ID, tag)) throw std::invalid_argument("Not an ST 0601 UL");
+    RawFormat f;
+    if (!raw_format(tag, f)) throw std::invalid_argument("Tag is not a numeric ST 0601 item");
+    int64_t qlo = quantize(ul, tag, std::min(lo, hi));
+    int64_t qhi = quantize(ul, tag, std::max(lo, hi));
+    if (qlo > qhi) std::swap(qlo, qhi);
+    return where_raw(tag, qlo, qhi);
+}
+
+ScanQuery& ScanQuery::time_range(uint64_t t0, uint64_t t1) {
+    const uint64_t top = static_cast<uint64_t>(std::numeric_limits<int64_t>::max());
+    return where_raw(UNIX_TIMESTAMP[15], static_cast<int64_t>(std::min(t0, top)),
+                     static_cast<int64_t>(std::min(t1, top)));
+}
+
+ScanQuery& ScanQuery::frame_center_within(double lat0, double lat1, double lon0, double lon1) {
+    if (lon0 > lon1) throw std::invalid_argument("Longitude box crosses the antimeridian");
+    where(FRAME_CENTER_LATITUDE, lat0, lat1);
+    return where(FRAME_CENTER_LONGITUDE, lon0, lon1);
+}
+
+bool ScanQuery::matches(const uint8_t* payload, size_t size) const {
+    // A tag repeated in the payload must pass every time but only counts once
+    const size_t wanted = predicates_.size();
+    std::bitset<256> seen;
+    size_t satisfied = 0;
+    size_t i = 0;
+    while (i < size && satisfied < wanted) {
+        const uint8_t tag = payload[i++];
+        size_t len = 0, len_bytes = 0;
+        if (!misb::decode_ber_length(payload, size, i, len, len_bytes)) return false;
+        i += len_bytes;
+        if (len > size - i) return false;
+        const int slot = slot_[tag];
+        if (slot >= 0) {
+            const RangePredicate& p = predicates_[static_cast<size_t>(slot)];
+            uint64_t raw = 0;
+            if (!read_raw(*codec_descriptor(p.tag), payload + i, len, raw)) return false;
+            const int64_t v = static_cast<int64_t>(raw);
+            if (v < p.lo || v > p.hi) return false;
+            if (!seen[static_cast<size_t>(slot)]) {
+                seen.set(static_cast<size_t>(slot));
+                ++satisfied;
+            }
+        }
+        i += len;
+    }
+    return satisfied == wanted;
+}
+
+std::vector<stanag::PacketView> scan(const uint8_t* data,
+                                     size_t size,
+                                     const ScanQuery& query,
+                                     unsigned threads) {
+    if (threads > 1) return scan(data, size, query, ThreadPool::shared());
+    std::vector<stanag::PacketView> result;
+    stanag::PacketView view;
+    size_t from = 0;
+    while (stanag::find_next_packet(data, size, from, view)) {
+        if (query.matches(data + view.payload_offset, view.payload_length)) {
+            result.push_back(view);
+        }
+        from = view.offset + view.length;
+    }
+    return result;
+}
+
+std::vector<stanag::PacketView> scan(const uint8_t* data,
+                                     size_t size,
+                                     const ScanQuery& query,
+                                     ThreadPool& pool) {
+    // Framing only hops over BER lengths, so it stays sequential
+    std::vector<stanag::PacketView> packets;
+    stanag::PacketView view;
+    size_t from = 0;
+    while (stanag::find_next_packet(data, size, from, view)) {
+        packets.push_back(view);
+        from = view.offset + view.length;
+    }
+
+    // A few chunks per thread so that stealing can even out the load
+    const size_t grain = std::max<size_t>(256, packets.size() / (8 * pool.concurrency()) + 1);
+    std::vector<std::vector<stanag::PacketView>> partial((packets.size() + grain - 1) / grain);
+    pool.parallel_for(packets.size(), grain, [&](size_t begin, size_t end) {
+        auto& out = partial[begin / grain];
+        for (size_t i = begin; i < end; ++i) {
+            const auto& p = packets[i];
+            if (query.matches(data + p.payload_offset, p.payload_length)) {
+                out.push_back(p);
+            }
+        }
+    });
+    std::vector<stanag::PacketView> result;
+    for (const auto& part : partial) {
+        result.insert(result.end(), part.begin(), part.end());
+    }
+    return result;
+}
+
+namespace {
+
+KLVSet decode_match(const uint8_t* data, const stanag::PacketView& m) {
+    const size_t len = m.payload_length >= 4 ? m.payload_length - 4 : m.payload_length;
+    std::vector<uint8_t> payload(data + m.payload_offset, data + m.payload_offset + len);
+    KLVSet set(false, ST_ID);
+    set.decode(payload);
+    return set;
+}
+
+} // namespace
+
+std::vector<KLVSet> decode_matches(const uint8_t* data,
+                                   const std::vector<stanag::PacketView>& matches) {
+    std::vector<KLVSet> sets;
+    sets.reserve(matches.size());
+    for (const auto& m : matches) {
+        sets.push_back(decode_match(data, m));
+    }
+    return sets;
+}
+
+std::vector<KLVSet> decode_matches(const uint8_t* data,
+                                   const std::vector<stanag::PacketView>& matches,
+                                   ThreadPool& pool) {
+    std::vector<KLVSet> sets(matches.size(), KLVSet(false, ST_ID));
+    pool.parallel_for(matches.size(), 64, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            sets[i] = decode_match(data, matches[i]);
+        }
+    });
+    return sets;
+}
+
+} // namespace st0601
+} // namespace misb
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "klv.h"
+#include "klv_thread_pool.h"
+#include "st0601.h"
+#include "stanag.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace misb {
+namespace st0601 {
+
+// Inclusive bounds on the transmitted integer of one tag
+struct RangePredicate {
+    uint8_t tag;
+    RawFormat format;
+    int64_t lo;
+    int64_t hi;
+};
+
+// Conjunction of range predicates evaluated directly on raw packet bytes.
+// Engineering-unit bounds are quantized once with the registered codec, so
+// matching a packet only compares integers; a packet lacking a constrained
+// tag does not match.
+class ScanQuery {
+public:
+    ScanQuery();
+
+    ScanQuery& where(const UL& ul, double lo, double hi);
+    ScanQuery& where_raw(uint8_t tag, int64_t lo, int64_t hi);
+    // Timestamps at or above 2^63 are out of reach: |t1| is clamped to
+    // INT64_MAX, so time_range(t0, UINT64_MAX) is open-ended
+    ScanQuery& time_range(uint64_t t0, uint64_t t1);
+    // Box in degrees. A box crossing the antimeridian (lon0 > lon1) is not
+    // a single range and throws std::invalid_argument; scan each side with
+    // its own query.
+    ScanQuery& frame_center_within(double lat0, double lat1, double lon0, double lon1);
+
+    // Evaluate the predicates on a local set payload (Tag-Length-Value items)
+    bool matches(const uint8_t* payload, size_t size) const;
+
+    const std::vector<RangePredicate>& predicates() const { return predicates_; }
+
+private:
+    std::vector<RangePredicate> predicates_;
+    std::array<int, 256> slot_;
+};
+
+// Frame every packet of a raw archive and keep those matching |query|.
+// With |threads| > 1 the predicate evaluation runs on ThreadPool::shared();
+// results stay in archive order.
+std::vector<stanag::PacketView> scan(const uint8_t* data,
+                                     size_t size,
+                                     const ScanQuery& query,
+                                     unsigned threads = 1);
+std::vector<stanag::PacketView> scan(const uint8_t* data,
+                                     size_t size,
+                                     const ScanQuery& query,
+                                     ThreadPool& pool);
+
+// Fully decode the matching packets (checksum item excluded)
+std::vector<KLVSet> decode_matches(const uint8_t* data,
+                                   const std::vector<stanag::PacketView>& matches);
+std::vector<KLVSet> decode_matches(const uint8_t* data,
+                                   const std::vector<stanag::PacketView>& matches,
+                                   ThreadPool& pool);
+
+} // namespace st0601
+} // namespace misb
@@ -0,0 +1,103 @@
+#include "st0601_state.h"
+
+#include <cmath>
+#include <limits>
+#include <memory>
+
+namespace misb {
+namespace st0601 {
+
+bool FeedState::tag_of(const UL& ul, uint8_t& tag) {
+    if (ul != make_st_ul(ST_ID, ul[15])) return false;
+    tag = ul[15];
+    return true;
+}
+
+FeedState::Slot::Slot()
+    : value(std::numeric_limits<double>::quiet_NaN()),
+      bytes(),
+      updated_at(0),
+      updates(0),
+      present(false),
+      is_bytes(false) {}
+
+FeedState::FeedState()
+    : slots_(), timestamp_(0), packets_(0), known_(0) {}
+
+size_t FeedState::apply(const KLVSet& set) {
+    // Locate the packet timestamp first so every slot gets the same stamp
+    const auto& children = set.children();
+    for (const auto& node : children) {
+        auto leaf = std::dynamic_pointer_cast<KLVLeaf>(node);
+        if (leaf && leaf->ul() == UNIX_TIMESTAMP) {
+            const double ts = leaf->value();
+            if (std::isfinite(ts) && ts >= 0.0) {
+                timestamp_ = static_cast<uint64_t>(ts);
+            }
+            break;
+        }
+    }
+
+    size_t updated = 0;
+    for (const auto& node : children) {
+        uint8_t tag = 0;
+        Slot* slot = nullptr;
+        if (auto leaf = std::dynamic_pointer_cast<KLVLeaf>(node)) {
+            if (!tag_of(leaf->ul(), tag)) continue;
+            slot = &slots_[tag];
+            slot->value = leaf->value();
+            slot->bytes.clear();
+            slot->is_bytes = false;
+        } else if (auto raw = std::dynamic_pointer_cast<KLVBytes>(node)) {
+            if (!tag_of(raw->ul(), tag)) continue;
+            slot = &slots_[tag];
+            slot->value = std::numeric_limits<double>::quiet_NaN();
+            slot->bytes = raw->value();
+            slot->is_bytes = true;
+        } else {
+            continue;
+        }
+        if (!slot->present) {
+            slot->present = true;
+            ++known_;
+        }
+        slot->updated_at = timestamp_;
+        ++slot->updates;
+        ++updated;
+    }
+    ++packets_;
+    return updated;
+}
+
+double FeedState::value(uint8_t tag) const {
+    const Slot& slot = slots_[tag];
+    if (!slot.present || slot.is_bytes) return std::numeric_limits<double>::quiet_NaN();
+    return slot.value;
+}
+
+KLVSet FeedState::snapshot() const {
+    KLVSet set(false, ST_ID);
+    for (size_t tag = 0; tag < SLOT_COUNT; ++tag) {
+        const Slot& slot = slots_[tag];
+        if (!slot.present) continue;
+        const UL ul = make_st_ul(ST_ID, static_cast<uint8_t>(tag));
+        if (slot.is_bytes) {
+            set.add(std::make_shared<KLVBytes>(ul, slot.bytes, true));
+        } else {
+            set.add(std::make_shared<KLVLeaf>(ul, slot.value, true));
+        }
+    }
+    return set;
+}
+
+void FeedState::reset() {
+    for (auto& slot : slots_) {
+        slot = Slot();
+    }
+    timestamp_ = 0;
+    packets_ = 0;
+    known_ = 0;
+}
+
+} // namespace st0601
+} // namespace misb
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "klv.h"
+#include "st0601.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace misb {
+namespace st0601 {
+
+// Carry-forward view of a single ST 0601 feed. Each decoded packet is merged
+// as a sparse update into a fixed table holding one slot per tag, so reading
+// the latest known value of any tag is a direct index.
+class FeedState {
+public:
+    static constexpr size_t SLOT_COUNT = 256;
+
+    struct Slot {
+        double value;
+        std::vector<uint8_t> bytes;
+        uint64_t updated_at; // UNIX_TIMESTAMP (tag 2) of the last update
+        uint32_t updates;
+        bool present;
+        bool is_bytes;
+
+        Slot();
+    };
+
+    FeedState();
+
+    // Merge every ST 0601 item of a decoded local set. Only the tags present
+    // in the set are touched. Returns the number of slots updated.
+    size_t apply(const KLVSet& set);
+
+    bool has(uint8_t tag) const { return slots_[tag].present; }
+    double value(uint8_t tag) const;
+    const std::vector<uint8_t>& bytes(uint8_t tag) const { return slots_[tag].bytes; }
+    uint64_t updated_at(uint8_t tag) const { return slots_[tag].updated_at; }
+    const Slot& slot(uint8_t tag) const { return slots_[tag]; }
+
+    // Timestamp of the most recent packet and number of packets merged
+    uint64_t timestamp() const { return timestamp_; }
+    uint64_t packet_count() const { return packets_; }
+    size_t known_count() const { return known_; }
+
+    // Rebuild a complete tag-based local set from the current state
+    KLVSet snapshot() const;
+
+    void reset();
+
+private:
+    // Returns true and the tag number when |ul| is a synthetic ST 0601 UL
+    static bool tag_of(const UL& ul, uint8_t& tag);
+
+    std::array<Slot, SLOT_COUNT> slots_;
+    uint64_t timestamp_;
+    uint64_t packets_;
+    size_t known_;
+};
+
+} // namespace st0601
+} // namespace misb
@@ -0,0 +1,189 @@
+#include "st0601_stats.h"
+#include "st0601_codec.h"
+#include "st_common.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace misb {
+namespace st0601 {
+
+namespace {
+
+// Largest transmitted integer of |f|, capped at INT64_MAX for unsigned
+// 64-bit values; read_raw returns those at or above 2^63 as negative
+int64_t raw_limit(const RawFormat& f) {
+    const unsigned bits = f.width * 8u - (f.is_signed ? 1u : 0u);
+    return bits >= 63 ? std::numeric_limits<int64_t>::max()
+                      : static_cast<int64_t>((uint64_t{1} << bits) - 1);
+}
+
+} // namespace
+
+FeedStats::Tag::Tag()
+    : updates(0),
+      values(0),
+      sentinels(0),
+      saturated(0),
+      malformed(0),
+      raw_min(std::numeric_limits<int64_t>::max()),
+      raw_max(std::numeric_limits<int64_t>::min()),
+      raw_sum(0.0),
+      first_time(0),
+      last_time(0),
+      timed_updates(0) {}
+
+FeedStats::FeedStats() : packets_(0) {
+    for (size_t tag = 0; tag < TAG_COUNT; ++tag) {
+        numeric_[tag] = raw_format(static_cast<uint8_t>(tag), formats_[tag]);
+        if (!numeric_[tag]) formats_[tag] = RawFormat{0, false};
+    }
+}
+
+void FeedStats::apply(const uint8_t* payload, size_t size) {
+    std::array<uint8_t, TAG_COUNT> seen;
+    size_t seen_count = 0;
+    uint64_t timestamp = 0;
+    bool timed = false;
+
+    size_t i = 0;
+    while (i < size) {
+        const uint8_t t = payload[i++];
+        size_t len = 0, len_bytes = 0;
+        if (!misb::decode_ber_length(payload, size, i, len, len_bytes)) break;
+        i += len_bytes;
+        if (len > size - i) break;
+        const uint8_t* value = payload + i;
+        i += len;
+        if (t == 1) continue; // checksum
+
+        Tag& s = tags_[t];
+        ++s.updates;
+        if (seen_count < seen.size()) seen[seen_count++] = t;
+        if (!numeric_[t]) continue;
+        const RawFormat& f = formats_[t];
+        uint64_t bits = 0;
+        if (!read_raw(*codec_descriptor(t), value, len, bits)) {
+            ++s.malformed;
+            continue;
+        }
+        const int64_t raw = static_cast<int64_t>(bits);
+        if (t == UNIX_TIMESTAMP[15]) {
+            timestamp = static_cast<uint64_t>(raw);
+            timed = true;
+        }
+        const int64_t limit = raw_limit(f);
+        // Signed codecs of two bytes or more reserve the most negative value
+        // and clamp to its opposite; the one-byte signed codec clamps to -128
+        const bool sentinel_range = f.is_signed && f.width >= 2;
+        if (sentinel_range && raw == -limit - 1) {
+            ++s.sentinels;
+            continue;
+        }
+        const int64_t floor = sentinel_range ? -limit : -limit - 1;
+        if (raw == limit || (f.is_signed && raw == floor)) ++s.saturated;
+        ++s.values;
+        s.raw_min = std::min(s.raw_min, raw);
+        s.raw_max = std::max(s.raw_max, raw);
+        s.raw_sum += static_cast<double>(raw);
+    }
+
+    if (timed) {
+        for (size_t k = 0; k < seen_count; ++k) {
+            Tag& s = tags_[seen[k]];
+            if (s.timed_updates == 0 || timestamp < s.first_time) s.first_time = timestamp;
+            s.last_time = std::max(s.last_time, timestamp);
+            ++s.timed_updates;
+        }
+    }
+    ++packets_;
+}
+
+void FeedStats::apply(const uint8_t* data, const stanag::PacketView& view) {
+    apply(data + view.payload_offset, view.payload_length);
+}
+
+bool FeedStats::apply_packet(const uint8_t* packet, size_t length) {
+    const size_t key_len = stanag::UAS_DATALINK_LOCAL_SET_UL.size();
+    if (length < key_len ||
+        !std::equal(stanag::UAS_DATALINK_LOCAL_SET_UL.begin(), stanag::UAS_DATALINK_LOCAL_SET_UL.end(), packet)) {
+        return false;
+    }
+    size_t len = 0, len_bytes = 0;
+    if (!misb::decode_ber_length(packet, length, key_len, len, len_bytes)) return false;
+    if (len > length - key_len - len_bytes) return false;
+    apply(packet + key_len + len_bytes, len);
+    return true;
+}
+
+void FeedStats::merge(const FeedStats& other) {
+    for (size_t t = 0; t < TAG_COUNT; ++t) {
+        Tag& a = tags_[t];
+        const Tag& b = other.tags_[t];
+        if (b.updates == 0) continue;
+        a.updates += b.updates;
+        a.values += b.values;
+        a.sentinels += b.sentinels;
+        a.saturated += b.saturated;
+        a.malformed += b.malformed;
+        a.raw_min = std::min(a.raw_min, b.raw_min);
+        a.raw_max = std::max(a.raw_max, b.raw_max);
+        a.raw_sum += b.raw_sum;
+        if (b.timed_updates) {
+            if (a.timed_updates == 0 || b.first_time < a.first_time) a.first_time = b.first_time;
+            a.last_time = std::max(a.last_time, b.last_time);
+            a.timed_updates += b.timed_updates;
+        }
+    }
+    packets_ += other.packets_;
+}
+
+void FeedStats::reset() {
+    tags_.fill(Tag());
+    packets_ = 0;
+}
+
+TagSummary FeedStats::summary(uint8_t tag) const {
+    const Tag& s = tags_[tag];
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    TagSummary out;
+    out.tag = tag;
+    out.updates = s.updates;
+    out.presence = packets_ ? static_cast<double>(s.updates) / packets_ : 0.0;
+    out.values = s.values;
+    out.min = out.max = out.mean = nan;
+    out.sentinels = s.sentinels;
+    out.saturated = s.saturated;
+    out.malformed = s.malformed;
+    out.update_hz = 0.0;
+    if (s.timed_updates > 1 && s.last_time > s.first_time) {
+        out.update_hz = (s.timed_updates - 1) * 1e6 / static_cast<double>(s.last_time - s.first_time);
+    }
+
+    const CodecDescriptor* codec = codec_descriptor(tag);
+    if (!numeric_[tag] || !codec || s.values == 0) return out;
+    // Every fixed-width ST 0601 codec is affine in the transmitted integer
+    const double lo = to_engineering(*codec, static_cast<uint64_t>(s.raw_min));
+    const double hi = to_engineering(*codec, static_cast<uint64_t>(s.raw_max));
+    out.min = std::min(lo, hi);
+    out.max = std::max(lo, hi);
+    if (s.raw_min == s.raw_max) {
+        out.mean = lo;
+    } else {
+        const double mean_raw = s.raw_sum / s.values;
+        out.mean = lo + (hi - lo) * (mean_raw - s.raw_min) / static_cast<double>(s.raw_max - s.raw_min);
+    }
+    return out;
+}
+
+std::vector<TagSummary> FeedStats::summaries() const {
+    std::vector<TagSummary> out;
+    for (size_t t = 0; t < TAG_COUNT; ++t) {
+        if (tags_[t].updates) out.push_back(summary(static_cast<uint8_t>(t)));
+    }
+    return out;
+}
+
+} // namespace st0601
+} // namespace misb
@@ -0,0 +1,91 @@
+#pragma once
+
+#include "klv.h"
+#include "st0601.h"
+#include "stanag.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace misb {
+namespace st0601 {
+
+// Data-quality view of one tag, in engineering units
+struct TagSummary {
+    uint8_t tag;
+    uint64_t updates;       // packets carrying the tag
+    double presence;        // updates / packets
+    uint64_t values;        // numeric values accumulated below
+    double min;
+    double max;
+    double mean;
+    uint64_t sentinels;     // 0x8000 / 0x80000000 "out of range" markers
+    uint64_t saturated;     // values pinned at the clamp limit of the codec
+    uint64_t malformed;     // items whose length does not match the codec
+    double update_hz;       // from UNIX_TIMESTAMP, 0 when unknown
+};
+
+// Streaming per-tag statistics of an ST 0601 feed, accumulated on raw packet
+// bytes: numeric tags are summed as transmitted integers and only turned
+// into engineering units by summary(), so apply() does no allocation and no
+// codec call. One collector per thread, combined with merge().
+//
+// A value counts as saturated when its integer sits at the top of the
+// transmitted range, or at either end for signed codecs: that is where the
+// encoders clamp out-of-range input. Clamps at the lower end of unsigned
+// codecs cannot be told from genuine minima and are not counted.
+class FeedStats {
+public:
+    static constexpr size_t TAG_COUNT = 256;
+
+    // Raw accumulators of one tag
+    struct Tag {
+        uint64_t updates;
+        uint64_t values;
+        uint64_t sentinels;
+        uint64_t saturated;
+        uint64_t malformed;
+        int64_t raw_min;
+        int64_t raw_max;
+        double raw_sum;
+        uint64_t first_time;    // UNIX_TIMESTAMP of the first and last update
+        uint64_t last_time;
+        uint64_t timed_updates; // updates in packets carrying a timestamp
+
+        Tag();
+    };
+
+    FeedStats();
+
+    // Account one local set payload (Tag-Length-Value items, checksum item
+    // optional). Items past a malformed BER length are ignored.
+    void apply(const uint8_t* payload, size_t size);
+    // Account the packet located by |view| in |data|
+    void apply(const uint8_t* data, const stanag::PacketView& view);
+    // Account one complete packet (e.g. DecodedPacket::bytes); false when
+    // it does not start with a well-formed key and length
+    bool apply_packet(const uint8_t* packet, size_t length);
+
+    void merge(const FeedStats& other);
+    void reset();
+
+    uint64_t packet_count() const { return packets_; }
+    const Tag& tag(uint8_t tag) const { return tags_[tag]; }
+
+    // Engineering-unit view of |tag|. Numeric fields stay NaN when no value
+    // was accumulated or the tag has no fixed-width codec.
+    TagSummary summary(uint8_t tag) const;
+    // Summaries of every tag seen, in tag order
+    std::vector<TagSummary> summaries() const;
+
+private:
+    std::array<Tag, TAG_COUNT> tags_;
+    std::array<RawFormat, TAG_COUNT> formats_;
+    std::array<bool, TAG_COUNT> numeric_;
+    uint64_t packets_;
+};
+
+} // namespace st0601
+} // namespace misb
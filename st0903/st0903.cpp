@@ -1,4 +1,6 @@
 #include "st0903.h"
+#include "klv_metrics.h"
+#include "klv_trace.h"
 
 #include <algorithm>
 #include <cmath>
@@ -17,401 +19,202 @@ inline double clamp(double v, double lo, double hi) {
     return v < lo ? lo : (v > hi ? hi : v);
 }
 
-inline std::vector<uint8_t> encode_uint(double value, size_t width) {
-    if (width == 0 || width > 8) {
-        return {};
+enum class ValueKind : uint8_t {
+    Uint,          // fixed-width unsigned integer
+    UintVariable,  // unsigned integer on its minimal width, up to |width|
+    Percent,       // one byte of percent; inputs up to 1 are fractions
+    Imap           // ST 1201 mapping
+};
+
+struct ValueCodec {
+    ValueKind kind;
+    uint8_t width;
+    const st1201::Imap& (*imap)();
+};
+
+size_t encode_value(const void* params, double value, uint8_t* dst) {
+    const ValueCodec& c = *static_cast<const ValueCodec*>(params);
+    switch (c.kind) {
+    case ValueKind::Uint:
+    case ValueKind::UintVariable: {
+        const uint64_t max_value = c.width == 8 ? std::numeric_limits<uint64_t>::max()
+                                                : ((uint64_t{1} << (c.width * 8)) - 1);
+        const double clamped = clamp(value, 0.0, static_cast<double>(max_value));
+        const uint64_t raw = static_cast<uint64_t>(std::llround(clamped));
+        const size_t width = c.kind == ValueKind::Uint ? c.width : uint_byte_width(raw);
+        return write_uint_be(dst, width, raw, width);
     }
-    const uint64_t max_value = width == 8 ? std::numeric_limits<uint64_t>::max()
-                                          : ((uint64_t{1} << (width * 8)) - 1);
-    const double clamped = clamp(value, 0.0, static_cast<double>(max_value));
-    const uint64_t raw = static_cast<uint64_t>(std::llround(clamped));
-    std::vector<uint8_t> bytes(width, 0u);
-    for (size_t i = 0; i < width; ++i) {
-        bytes[width - 1 - i] = static_cast<uint8_t>((raw >> (i * 8)) & 0xFFu);
+    case ValueKind::Percent: {
+        const double scaled = value <= 1.0 ? value * 100.0 : value;
+        dst[0] = static_cast<uint8_t>(std::lround(clamp(scaled, 0.0, 100.0)));
+        return 1;
     }
-    return bytes;
-}
-
-inline double decode_uint(const std::vector<uint8_t>& bytes, size_t width) {
-    if (bytes.size() != width || width == 0 || width > 8) {
-        return std::numeric_limits<double>::quiet_NaN();
-    }
-    uint64_t raw = 0;
-    for (uint8_t b : bytes) {
-        raw = (raw << 8) | b;
-    }
-    return static_cast<double>(raw);
-}
-
-inline std::vector<uint8_t> encode_uint_variable(double value, size_t max_width) {
-    if (max_width == 0 || max_width > 8) {
-        return {};
-    }
-    const uint64_t max_value = max_width == 8 ? std::numeric_limits<uint64_t>::max()
-                                              : ((uint64_t{1} << (max_width * 8)) - 1);
-    const double clamped = clamp(value, 0.0, static_cast<double>(max_value));
-    uint64_t raw = static_cast<uint64_t>(std::llround(clamped));
-    size_t width = 1;
-    while (width < max_width && (raw >> (width * 8)) != 0) {
-        ++width;
+    case ValueKind::Imap:
+        return st1201::encode(c.imap(), value, dst, KLVCodec::MAX_SIZE);
     }
-    std::vector<uint8_t> bytes(width, 0u);
-    for (size_t i = 0; i < width; ++i) {
-        bytes[width - 1 - i] = static_cast<uint8_t>((raw >> (i * 8)) & 0xFFu);
-    }
-    return bytes;
+    return 0;
 }
 
-inline double decode_uint_variable(const std::vector<uint8_t>& bytes, size_t max_width) {
-    if (bytes.empty() || bytes.size() > max_width || max_width == 0 || max_width > 8) {
-        return std::numeric_limits<double>::quiet_NaN();
-    }
+double decode_value(const void* params, const uint8_t* data, size_t size) {
+    const ValueCodec& c = *static_cast<const ValueCodec*>(params);
     uint64_t raw = 0;
-    for (uint8_t b : bytes) {
-        raw = (raw << 8) | b;
+    switch (c.kind) {
+    case ValueKind::Uint:
+        if (size != c.width || !read_uint_be(data, size, c.width, raw)) break;
+        return static_cast<double>(raw);
+    case ValueKind::UintVariable:
+        if (size > c.width || !read_uint_be(data, size, size, raw)) break;
+        return static_cast<double>(raw);
+    case ValueKind::Percent:
+        if (size != 1) break;
+        return static_cast<double>(data[0]) / 100.0;
+    case ValueKind::Imap:
+        return st1201::decode(c.imap(), data, size);
     }
-    return static_cast<double>(raw);
-}
-
-inline std::vector<uint8_t> encode_probability(double value) {
-    const double clamped = clamp(value, 0.0, 1.0);
-    const uint8_t raw = static_cast<uint8_t>(std::lround(clamped * 255.0));
-    return { raw };
-}
-
-inline double decode_probability(const std::vector<uint8_t>& bytes) {
-    if (bytes.size() != 1) {
-        return std::numeric_limits<double>::quiet_NaN();
-    }
-    return static_cast<double>(bytes[0]) / 255.0;
-}
+    return std::numeric_limits<double>::quiet_NaN();
+}
+
+constexpr ValueCodec U1{ValueKind::Uint, 1, nullptr};
+constexpr ValueCodec U2{ValueKind::Uint, 2, nullptr};
+constexpr ValueCodec U3{ValueKind::Uint, 3, nullptr};
+constexpr ValueCodec U4{ValueKind::Uint, 4, nullptr};
+constexpr ValueCodec U8{ValueKind::Uint, 8, nullptr};
+constexpr ValueCodec V2{ValueKind::UintVariable, 2, nullptr};
+constexpr ValueCodec V3{ValueKind::UintVariable, 3, nullptr};
+constexpr ValueCodec V4{ValueKind::UintVariable, 4, nullptr};
+constexpr ValueCodec V6{ValueKind::UintVariable, 6, nullptr};
+constexpr ValueCodec PERCENT{ValueKind::Percent, 1, nullptr};
+constexpr ValueCodec FOV{ValueKind::Imap, 0, imap_fov};
+constexpr ValueCodec OFFSET{ValueKind::Imap, 0, imap_location_offset};
+constexpr ValueCodec HAE{ValueKind::Imap, 0, imap_hae};
+
+#define VALUE_CODEC(tag, params) {tag, encode_value, decode_value, &params}
+
+constexpr KLVCodec LOCAL_CODECS[] = {
+    VALUE_CODEC(1, U2),     // VMTI_CHECKSUM
+    VALUE_CODEC(2, U8),     // VMTI_PRECISION_TIMESTAMP
+    VALUE_CODEC(4, U2),     // VMTI_LS_VERSION
+    VALUE_CODEC(5, U2),     // VMTI_TOTAL_TARGETS_DETECTED
+    VALUE_CODEC(6, U2),     // VMTI_NUM_TARGETS_REPORTED
+    VALUE_CODEC(7, U4),     // VMTI_FRAME_NUMBER
+    VALUE_CODEC(8, U2),     // VMTI_FRAME_WIDTH
+    VALUE_CODEC(9, U2),     // VMTI_FRAME_HEIGHT
+    VALUE_CODEC(11, FOV),   // VMTI_HORIZONTAL_FOV
+    VALUE_CODEC(12, FOV),   // VMTI_VERTICAL_FOV
+};
+
+constexpr KLVCodec VTARGET_CODECS[] = {
+    VALUE_CODEC(1, V6),       // VTARGET_CENTROID
+    VALUE_CODEC(2, V6),       // VTARGET_BBOX_TOP_LEFT_PIXEL
+    VALUE_CODEC(3, V6),       // VTARGET_BBOX_BOTTOM_RIGHT_PIXEL
+    VALUE_CODEC(4, U1),       // VTARGET_PRIORITY
+    VALUE_CODEC(5, PERCENT),  // VTARGET_CONFIDENCE_LEVEL
+    VALUE_CODEC(6, V2),       // VTARGET_HISTORY
+    VALUE_CODEC(7, PERCENT),  // VTARGET_PERCENT_TARGET_PIXELS
+    VALUE_CODEC(8, U3),       // VTARGET_COLOR
+    VALUE_CODEC(9, V3),       // VTARGET_INTENSITY
+    VALUE_CODEC(10, OFFSET),  // VTARGET_LOCATION_OFFSET_LAT
+    VALUE_CODEC(11, OFFSET),  // VTARGET_LOCATION_OFFSET_LON
+    VALUE_CODEC(12, HAE),     // VTARGET_LOCATION_HAE
+    VALUE_CODEC(13, OFFSET),  // VTARGET_BBOX_TOP_LEFT_LAT_OFFSET
+    VALUE_CODEC(14, OFFSET),  // VTARGET_BBOX_TOP_LEFT_LON_OFFSET
+    VALUE_CODEC(15, OFFSET),  // VTARGET_BBOX_BOTTOM_RIGHT_LAT_OFFSET
+    VALUE_CODEC(16, OFFSET),  // VTARGET_BBOX_BOTTOM_RIGHT_LON_OFFSET
+    VALUE_CODEC(19, V4),      // VTARGET_CENTROID_ROW
+    VALUE_CODEC(20, V4),      // VTARGET_CENTROID_COLUMN
+    VALUE_CODEC(22, V3),      // VTARGET_ALGORITHM_ID
+    VALUE_CODEC(23, U1),      // VTARGET_DETECTION_STATUS
+};
+
+constexpr KLVCodec ALGORITHM_CODECS[] = {
+    VALUE_CODEC(1, U2),       // ALGORITHM_ID
+    VALUE_CODEC(4, U1),       // ALGORITHM_CLASS
+    VALUE_CODEC(5, PERCENT),  // ALGORITHM_CONFIDENCE
+};
+
+constexpr KLVCodec ONTOLOGY_CODECS[] = {
+    VALUE_CODEC(1, U2),       // ONTOLOGY_ID
+    VALUE_CODEC(3, PERCENT),  // ONTOLOGY_CONFIDENCE
+};
+
+#undef VALUE_CODEC
+
+struct CodecTable {
+    uint8_t st_id;
+    const KLVCodec* begin;
+    const KLVCodec* end;
+};
+
+constexpr CodecTable TABLES[] = {
+    {ST_ID, LOCAL_CODECS, LOCAL_CODECS + sizeof(LOCAL_CODECS) / sizeof(LOCAL_CODECS[0])},
+    {VTARGET_ST_ID, VTARGET_CODECS, VTARGET_CODECS + sizeof(VTARGET_CODECS) / sizeof(VTARGET_CODECS[0])},
+    {ALGORITHM_ST_ID, ALGORITHM_CODECS, ALGORITHM_CODECS + sizeof(ALGORITHM_CODECS) / sizeof(ALGORITHM_CODECS[0])},
+    {ONTOLOGY_ST_ID, ONTOLOGY_CODECS, ONTOLOGY_CODECS + sizeof(ONTOLOGY_CODECS) / sizeof(ONTOLOGY_CODECS[0])},
+};
 
-inline std::vector<uint8_t> encode_percentage(double value) {
-    double scaled = value;
-    if (scaled <= 1.0) {
-        scaled *= 100.0;
-    }
-    const double clamped = clamp(scaled, 0.0, 100.0);
-    const uint8_t raw = static_cast<uint8_t>(std::lround(clamped));
-    return { raw };
-}
-
-inline double decode_percentage(const std::vector<uint8_t>& bytes) {
-    if (bytes.size() != 1) {
-        return std::numeric_limits<double>::quiet_NaN();
-    }
-    return static_cast<double>(bytes[0]) / 100.0;
-}
-
-inline std::vector<uint8_t> encode_imap(double value,
-                                        double min,
-                                        double max,
-                                        size_t width) {
-    if (width == 0 || width > 8) {
-        return {};
-    }
-    const double lo = std::min(min, max);
-    const double hi = std::max(min, max);
-    const double span = hi - lo;
-    if (span <= 0.0) {
-        return std::vector<uint8_t>(width, 0u);
-    }
-    const double clamped = clamp(value, lo, hi);
-    const uint64_t max_value = width == 8 ? std::numeric_limits<uint64_t>::max()
-                                          : ((uint64_t{1} << (width * 8)) - 1);
-    const double norm = (clamped - lo) / span;
-    uint64_t raw = static_cast<uint64_t>(std::llround(norm * max_value));
-    if (raw > max_value) {
-        raw = max_value;
-    }
-    std::vector<uint8_t> bytes(width, 0u);
-    for (size_t i = 0; i < width; ++i) {
-        bytes[width - 1 - i] = static_cast<uint8_t>((raw >> (i * 8)) & 0xFFu);
-    }
-    return bytes;
-}
-
-inline double decode_imap(const std::vector<uint8_t>& bytes,
-                          double min,
-                          double max) {
-    if (bytes.empty() || bytes.size() > 8) {
-        return std::numeric_limits<double>::quiet_NaN();
-    }
-    const double lo = std::min(min, max);
-    const double hi = std::max(min, max);
-    const double span = hi - lo;
-    if (span <= 0.0) {
-        return std::numeric_limits<double>::quiet_NaN();
-    }
-    uint64_t raw = 0;
-    for (uint8_t b : bytes) {
-        raw = (raw << 8) | b;
-    }
-    const uint64_t max_value = bytes.size() == 8 ? std::numeric_limits<uint64_t>::max()
-                                                 : ((uint64_t{1} << (bytes.size() * 8)) - 1);
-    return lo + (static_cast<double>(raw) * (span / static_cast<double>(max_value)));
-}
-
-inline std::vector<uint8_t> encode_color(double value) {
-    return encode_uint(value, 3);
-}
-
-inline double decode_color(const std::vector<uint8_t>& bytes) {
-    return decode_uint(bytes, 3);
-}
+} // namespace detail
 
-inline std::vector<uint8_t> encode_probability_percent(double value) {
-    return encode_percentage(value);
-}
+namespace {
 
-inline double decode_probability_percent(const std::vector<uint8_t>& bytes) {
-    return decode_percentage(bytes);
+std::vector<uint8_t> encode_ber_oid(uint64_t value) {
+    uint8_t buf[10];
+    const size_t n = write_ber_oid(buf, sizeof(buf), value);
+    return std::vector<uint8_t>(buf, buf + n);
 }
 
-inline std::vector<uint8_t> encode_status(double value) {
-    return encode_uint(value, 1);
-}
+} // namespace
 
-inline double decode_status(const std::vector<uint8_t>& bytes) {
-    return decode_uint(bytes, 1);
+const st1201::Imap& imap_fov() {
+    static const st1201::Imap imap = st1201::imapb(0.0, 180.0, 2);
+    return imap;
 }
 
-inline std::vector<uint8_t> encode_uint_width(double value, size_t width) {
-    return encode_uint(value, width);
+const st1201::Imap& imap_location_offset() {
+    static const st1201::Imap imap = st1201::imapb(-19.2, 19.2, 3);
+    return imap;
 }
 
-inline double decode_uint_width(const std::vector<uint8_t>& bytes, size_t width) {
-    return decode_uint(bytes, width);
+const st1201::Imap& imap_hae() {
+    static const st1201::Imap imap = st1201::imapb(-900.0, 19000.0, 2);
+    return imap;
 }
 
-} // namespace detail
-
-namespace {
-
-std::vector<uint8_t> encode_ber_oid(uint64_t value) {
-    std::vector<uint8_t> tmp;
-    do {
-        tmp.push_back(static_cast<uint8_t>(value & 0x7Fu));
-        value >>= 7;
-    } while (value > 0);
-
-    std::vector<uint8_t> result;
-    result.reserve(tmp.size());
-    for (size_t i = tmp.size(); i-- > 0;) {
-        uint8_t byte = tmp[i];
-        if (i != 0) {
-            byte |= 0x80u;
+const KLVCodec* builtin_codec(uint8_t st_id, uint8_t tag) {
+    for (const auto& table : detail::TABLES) {
+        if (table.st_id != st_id) continue;
+        for (const KLVCodec* c = table.begin; c != table.end; ++c) {
+            if (c->tag == tag) return c;
         }
-        result.push_back(byte);
+        break;
     }
-    return result;
+    return nullptr;
 }
 
-std::pair<uint64_t, size_t> decode_ber_oid(const std::vector<uint8_t>& bytes,
-                                           size_t offset,
-                                           size_t max_length) {
-    if (offset >= bytes.size()) {
-        throw std::runtime_error("BER OID offset out of range");
-    }
-    uint64_t value = 0;
-    size_t consumed = 0;
-    while (consumed < max_length) {
-        const uint8_t byte = bytes[offset + consumed];
-        value = (value << 7) | static_cast<uint64_t>(byte & 0x7Fu);
-        ++consumed;
-        if ((byte & 0x80u) == 0) {
-            return { value, consumed };
-        }
-        if (consumed + offset >= bytes.size() && (byte & 0x80u)) {
-            break;
+void register_st0903(KLVRegistry& reg) {
+    for (const auto& table : detail::TABLES) {
+        for (const KLVCodec* c = table.begin; c != table.end; ++c) {
+            reg.register_codec(make_st_ul(table.st_id, c->tag), *c);
         }
     }
-    throw std::runtime_error("BER OID did not terminate before end of buffer");
 }
 
-} // namespace
-
-void register_st0903(KLVRegistry& reg) {
-    using namespace detail;
-
-    reg.register_ul(VMTI_CHECKSUM, {
-        [](double v) { return encode_uint_width(v, 2); },
-        [](const std::vector<uint8_t>& bytes) { return decode_uint_width(bytes, 2); }
-    });
-
-    reg.register_ul(VMTI_PRECISION_TIMESTAMP, {
-        [](double v) { return encode_uint_width(v, 8); },
-        [](const std::vector<uint8_t>& bytes) { return decode_uint_width(bytes, 8); }
-    });
-
-    reg.register_ul(VMTI_LS_VERSION, {
-        [](double v) { return encode_uint_width(v, 2); },
-        [](const std::vector<uint8_t>& bytes) { return decode_uint_width(bytes, 2); }
-    });
-
-    reg.register_ul(VMTI_TOTAL_TARGETS_DETECTED, {
-        [](double v) { return encode_uint_width(v, 2); },
-        [](const std::vector<uint8_t>& bytes) { return decode_uint_width(bytes, 2); }
-    });
-
-    reg.register_ul(VMTI_NUM_TARGETS_REPORTED, {
-        [](double v) { return encode_uint_width(v, 2); },
-        [](const std::vector<uint8_t>& bytes) { return decode_uint_width(bytes, 2); }
-    });
-
-    reg.register_ul(VMTI_FRAME_NUMBER, {
-        [](double v) { return encode_uint_width(v, 4); },
-        [](const std::vector<uint8_t>& bytes) { return decode_uint_width(bytes, 4); }
-    });
-
-    reg.register_ul(VMTI_FRAME_WIDTH, {
-        [](double v) { return encode_uint_width(v, 2); },
-        [](const std::vector<uint8_t>& bytes) { return decode_uint_width(bytes, 2); }
-    });
-
-    reg.register_ul(VMTI_FRAME_HEIGHT, {
-        [](double v) { return encode_uint_width(v, 2); },
-        [](const std::vector<uint8_t>& bytes) { return decode_uint_width(bytes, 2); }
-    });
-
-    reg.register_ul(VMTI_HORIZONTAL_FOV, {
-        [](double v) { return encode_imap(v, 0.0, 180.0, 2); },
-        [](const std::vector<uint8_t>& bytes) { return decode_imap(bytes, 0.0, 180.0); }
-    });
-
-    reg.register_ul(VMTI_VERTICAL_FOV, {
-        [](double v) { return encode_imap(v, 0.0, 180.0, 2); },
-        [](const std::vector<uint8_t>& bytes) { return decode_imap(bytes, 0.0, 180.0); }
-    });
-
-    reg.register_ul(VTARGET_CENTROID, {
-        [](double v) { return encode_uint_variable(v, 6); },
-        [](const std::vector<uint8_t>& bytes) { return decode_uint_variable(bytes, 6); }
-    });
-
-    reg.register_ul(VTARGET_BBOX_TOP_LEFT_PIXEL, {
-        [](double v) { return encode_uint_variable(v, 6); },
-        [](const std::vector<uint8_t>& bytes) { return decode_uint_variable(bytes, 6); }
-    });
-
-    reg.register_ul(VTARGET_BBOX_BOTTOM_RIGHT_PIXEL, {
-        [](double v) { return encode_uint_variable(v, 6); },
-        [](const std::vector<uint8_t>& bytes) { return decode_uint_variable(bytes, 6); }
-    });
-
-    reg.register_ul(VTARGET_PRIORITY, {
-        [](double v) { return encode_uint_width(v, 1); },
-        [](const std::vector<uint8_t>& bytes) { return decode_uint_width(bytes, 1); }
-    });
-
-    reg.register_ul(VTARGET_CONFIDENCE_LEVEL, {
-        [](double v) { return encode_probability_percent(v); },
-        [](const std::vector<uint8_t>& bytes) { return decode_probability_percent(bytes); }
-    });
-
-    reg.register_ul(VTARGET_HISTORY, {
-        [](double v) { return encode_uint_variable(v, 2); },
-        [](const std::vector<uint8_t>& bytes) { return decode_uint_variable(bytes, 2); }
-    });
-
-    reg.register_ul(VTARGET_PERCENT_TARGET_PIXELS, {
-        [](double v) { return encode_probability_percent(v); },
-        [](const std::vector<uint8_t>& bytes) { return decode_probability_percent(bytes); }
-    });
-
-    reg.register_ul(VTARGET_COLOR, {
-        [](double v) { return encode_color(v); },
-        [](const std::vector<uint8_t>& bytes) { return decode_color(bytes); }
-    });
-
-    reg.register_ul(VTARGET_INTENSITY, {
-        [](double v) { return encode_uint_variable(v, 3); },
-        [](const std::vector<uint8_t>& bytes) { return decode_uint_variable(bytes, 3); }
-    });
-
-    reg.register_ul(VTARGET_LOCATION_OFFSET_LAT, {
-        [](double v) { return encode_imap(v, -19.2, 19.2, 3); },
-        [](const std::vector<uint8_t>& bytes) { return decode_imap(bytes, -19.2, 19.2); }
-    });
-
-    reg.register_ul(VTARGET_LOCATION_OFFSET_LON, {
-        [](double v) { return encode_imap(v, -19.2, 19.2, 3); },
-        [](const std::vector<uint8_t>& bytes) { return decode_imap(bytes, -19.2, 19.2); }
-    });
-
-    reg.register_ul(VTARGET_LOCATION_HAE, {
-        [](double v) { return encode_imap(v, -900.0, 19000.0, 2); },
-        [](const std::vector<uint8_t>& bytes) { return decode_imap(bytes, -900.0, 19000.0); }
-    });
-
-    reg.register_ul(VTARGET_BBOX_TOP_LEFT_LAT_OFFSET, {
-        [](double v) { return encode_imap(v, -19.2, 19.2, 3); },
-        [](const std::vector<uint8_t>& bytes) { return decode_imap(bytes, -19.2, 19.2); }
-    });
-
-    reg.register_ul(VTARGET_BBOX_TOP_LEFT_LON_OFFSET, {
-        [](double v) { return encode_imap(v, -19.2, 19.2, 3); },
-        [](const std::vector<uint8_t>& bytes) { return decode_imap(bytes, -19.2, 19.2); }
-    });
-
-    reg.register_ul(VTARGET_BBOX_BOTTOM_RIGHT_LAT_OFFSET, {
-        [](double v) { return encode_imap(v, -19.2, 19.2, 3); },
-        [](const std::vector<uint8_t>& bytes) { return decode_imap(bytes, -19.2, 19.2); }
-    });
-
-    reg.register_ul(VTARGET_BBOX_BOTTOM_RIGHT_LON_OFFSET, {
-        [](double v) { return encode_imap(v, -19.2, 19.2, 3); },
-        [](const std::vector<uint8_t>& bytes) { return decode_imap(bytes, -19.2, 19.2); }
-    });
-
-    reg.register_ul(VTARGET_CENTROID_ROW, {
-        [](double v) { return encode_uint_variable(v, 4); },
-        [](const std::vector<uint8_t>& bytes) { return decode_uint_variable(bytes, 4); }
-    });
-
-    reg.register_ul(VTARGET_CENTROID_COLUMN, {
-        [](double v) { return encode_uint_variable(v, 4); },
-        [](const std::vector<uint8_t>& bytes) { return decode_uint_variable(bytes, 4); }
-    });
-
-    reg.register_ul(VTARGET_ALGORITHM_ID, {
-        [](double v) { return encode_uint_variable(v, 3); },
-        [](const std::vector<uint8_t>& bytes) { return decode_uint_variable(bytes, 3); }
-    });
-
-    reg.register_ul(VTARGET_DETECTION_STATUS, {
-        [](double v) { return encode_status(v); },
-        [](const std::vector<uint8_t>& bytes) { return decode_status(bytes); }
-    });
-
-    reg.register_ul(ALGORITHM_ID, {
-        [](double v) { return encode_uint_width(v, 2); },
-        [](const std::vector<uint8_t>& bytes) { return decode_uint_width(bytes, 2); }
-    });
-
-    reg.register_ul(ALGORITHM_CLASS, {
-        [](double v) { return encode_uint_width(v, 1); },
-        [](const std::vector<uint8_t>& bytes) { return decode_uint_width(bytes, 1); }
-    });
-
-    reg.register_ul(ALGORITHM_CONFIDENCE, {
-        [](double v) { return encode_probability_percent(v); },
-        [](const std::vector<uint8_t>& bytes) { return decode_probability_percent(bytes); }
-    });
-
-    reg.register_ul(ONTOLOGY_ID, {
-        [](double v) { return encode_uint_width(v, 2); },
-        [](const std::vector<uint8_t>& bytes) { return decode_uint_width(bytes, 2); }
-    });
+namespace {
 
-    reg.register_ul(ONTOLOGY_CONFIDENCE, {
-        [](double v) { return encode_probability_percent(v); },
-        [](const std::vector<uint8_t>& bytes) { return decode_probability_percent(bytes); }
-    });
+// Times and traces one series decode, counting the ones that are rejected
+template <typename Fn>
+auto decode_series_stage(const char* name, uint8_t st_id, Fn fn) -> decltype(fn()) {
+    KLV_METRIC_STAGE(SeriesDecode);
+    KLV_TRACE_SPAN_ARG(name, "st_id", st_id);
+    (void)name;
+    (void)st_id;
+    try {
+        return fn();
+    } catch (...) {
+        KLV_METRIC_ADD(ErrorSeries, 1);
+        throw;
+    }
 }
 
-namespace {
-
 std::vector<uint8_t> encode_local_set_series(const std::vector<KLVSet>& sets) {
     std::vector<uint8_t> output;
     for (const auto& set : sets) {
@@ -426,34 +229,30 @@ std::vector<uint8_t> encode_local_set_series(const std::vector<KLVSet>& sets) {
     return output;
 }
 
-std::vector<KLVSet> decode_local_set_series(const std::vector<uint8_t>& bytes,
-                                            uint8_t st_id) {
-    std::vector<KLVSet> sets;
-    size_t offset = 0;
-    while (offset < bytes.size()) {
-        size_t len = 0;
-        size_t len_bytes = 0;
-        if (!misb::decode_ber_length(bytes, offset, len, len_bytes)) {
-            throw std::runtime_error("Invalid BER length inside series");
-        }
-        offset += len_bytes;
-        if (offset + len > bytes.size()) {
-            throw std::runtime_error("Truncated local set inside series");
-        }
-        std::vector<uint8_t> payload(bytes.begin() + static_cast<long>(offset),
-                                     bytes.begin() + static_cast<long>(offset + len));
-        if (payload.empty()) {
-            throw std::runtime_error("Series element must not be empty");
+std::vector<KLVSet> decode_local_set_series(const ByteSlice& bytes, uint8_t st_id) {
+    return decode_series_stage("st0903::decode_local_set_series", st_id, [&]() {
+        std::vector<KLVSet> sets;
+        size_t offset = 0;
+        while (offset < bytes.size()) {
+            size_t len = 0;
+            const size_t len_bytes = misb::read_ber_length(bytes.data() + offset, bytes.size() - offset, len);
+            if (len_bytes == 0) {
+                throw std::runtime_error("Invalid BER length inside series");
+            }
+            offset += len_bytes;
+            if (len > bytes.size() - offset) {
+                throw std::runtime_error("Truncated local set inside series");
+            }
+            if (len == 0) {
+                throw std::runtime_error("Series element must not be empty");
+            }
+            KLVSet set(false, st_id);
+            set.decode(bytes.slice(offset, len));
+            sets.push_back(std::move(set));
+            offset += len;
         }
-        KLVSet set(false, st_id);
-        set.decode(payload);
-        sets.push_back(std::move(set));
-        offset += len;
-    }
-    if (offset != bytes.size()) {
-        throw std::runtime_error("Excess data while decoding series");
-    }
-    return sets;
+        return sets;
+    });
 }
 
 } // namespace
@@ -501,50 +300,88 @@ std::vector<uint8_t> encode_vtarget_series(std::initializer_list<VTargetPack> pa
 }
 
 std::vector<VTargetPack> decode_vtarget_series(const std::vector<uint8_t>& bytes) {
-    std::vector<VTargetPack> packs;
+    return decode_vtarget_series(ByteSlice::copy(bytes));
+}
+
+namespace {
+
+// One pack of a vTarget series: id and the byte range of its local set
+struct PackRange {
+    uint64_t target_id;
+    size_t offset;
+    size_t size;
+};
+
+// Walk the pack lengths and ids; the local sets are decoded separately
+std::vector<PackRange> frame_vtarget_series(const ByteSlice& bytes) {
+    KLV_TRACE_SPAN("st0903::frame_vtarget_series");
+    std::vector<PackRange> ranges;
     std::set<uint64_t> seen_ids;
     size_t offset = 0;
     while (offset < bytes.size()) {
         size_t pack_len = 0;
-        size_t len_bytes = 0;
-        if (!misb::decode_ber_length(bytes, offset, pack_len, len_bytes)) {
+        const size_t len_bytes = misb::read_ber_length(bytes.data() + offset, bytes.size() - offset, pack_len);
+        if (len_bytes == 0) {
             throw std::runtime_error("Invalid BER length inside vTarget series");
         }
         offset += len_bytes;
-        if (offset + pack_len > bytes.size()) {
+        if (pack_len > bytes.size() - offset) {
             throw std::runtime_error("Truncated vTarget pack");
         }
-        std::vector<uint8_t> pack_data(bytes.begin() + static_cast<long>(offset),
-                                       bytes.begin() + static_cast<long>(offset + pack_len));
-        if (pack_data.empty()) {
+        if (pack_len == 0) {
             throw std::runtime_error("Empty vTarget pack");
         }
-        auto oid_info = decode_ber_oid(pack_data, 0, pack_data.size());
-        uint64_t target_id = oid_info.first;
-        size_t oid_len = oid_info.second;
-        if (oid_len >= pack_data.size()) {
+        uint64_t target_id = 0;
+        const size_t oid_len = misb::read_ber_oid(bytes.data() + offset, pack_len, target_id);
+        if (oid_len == 0) {
+            throw std::runtime_error("BER OID did not terminate before end of buffer");
+        }
+        if (oid_len >= pack_len) {
             throw std::runtime_error("VTarget pack missing payload items");
         }
         if (!seen_ids.insert(target_id).second) {
             throw std::runtime_error("Duplicate targetId encountered while decoding vTarget series");
         }
-        std::vector<uint8_t> local_bytes(pack_data.begin() + static_cast<long>(oid_len),
-                                         pack_data.end());
-        KLVSet local(false, VTARGET_ST_ID);
-        local.decode(local_bytes);
-        if (local.encode().empty()) {
-            throw std::runtime_error("VTarget pack contained no TLVs");
-        }
-        VTargetPack pack;
-        pack.target_id = target_id;
-        pack.set = std::move(local);
-        packs.push_back(std::move(pack));
+        ranges.push_back(PackRange{target_id, offset + oid_len, pack_len - oid_len});
         offset += pack_len;
     }
-    if (offset != bytes.size()) {
-        throw std::runtime_error("Excess bytes while decoding vTarget series");
+    return ranges;
+}
+
+void decode_vtarget_pack(const ByteSlice& bytes, const PackRange& range, VTargetPack& pack) {
+    KLVSet local(false, VTARGET_ST_ID);
+    local.decode(bytes.slice(range.offset, range.size));
+    if (local.children().empty()) {
+        throw std::runtime_error("VTarget pack contained no TLVs");
     }
-    return packs;
+    pack.target_id = range.target_id;
+    pack.set = std::move(local);
+}
+
+} // namespace
+
+std::vector<VTargetPack> decode_vtarget_series(const ByteSlice& bytes) {
+    return decode_series_stage("st0903::decode_vtarget_series", VTARGET_ST_ID, [&]() {
+        const auto ranges = frame_vtarget_series(bytes);
+        std::vector<VTargetPack> packs(ranges.size());
+        for (size_t i = 0; i < ranges.size(); ++i) {
+            decode_vtarget_pack(bytes, ranges[i], packs[i]);
+        }
+        return packs;
+    });
+}
+
+std::vector<VTargetPack> decode_vtarget_series(const ByteSlice& bytes, ThreadPool& pool) {
+    return decode_series_stage("st0903::decode_vtarget_series", VTARGET_ST_ID, [&]() {
+        const auto ranges = frame_vtarget_series(bytes);
+        std::vector<VTargetPack> packs(ranges.size());
+        pool.parallel_for(ranges.size(), 128, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                decode_vtarget_pack(bytes, ranges[i], packs[i]);
+            }
+        });
+        return packs;
+    });
 }
 
 std::vector<uint8_t> encode_algorithm_series(const std::vector<KLVSet>& sets) {
@@ -556,6 +393,10 @@ std::vector<uint8_t> encode_algorithm_series(std::initializer_list<KLVSet> sets)
 }
 
 std::vector<KLVSet> decode_algorithm_series(const std::vector<uint8_t>& bytes) {
+    return decode_local_set_series(ByteSlice::copy(bytes), ALGORITHM_ST_ID);
+}
+
+std::vector<KLVSet> decode_algorithm_series(const ByteSlice& bytes) {
     return decode_local_set_series(bytes, ALGORITHM_ST_ID);
 }
 
@@ -568,6 +409,10 @@ std::vector<uint8_t> encode_ontology_series(std::initializer_list<KLVSet> sets)
 }
 
 std::vector<KLVSet> decode_ontology_series(const std::vector<uint8_t>& bytes) {
+    return decode_local_set_series(ByteSlice::copy(bytes), ONTOLOGY_ST_ID);
+}
+
+std::vector<KLVSet> decode_ontology_series(const ByteSlice& bytes) {
     return decode_local_set_series(bytes, ONTOLOGY_ST_ID);
 }
 
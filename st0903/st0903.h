@@ -1,7 +1,9 @@
 #pragma once
 
 #include "klv.h"
+#include "klv_thread_pool.h"
 #include "st_common.h"
+#include "st1201.h"
 
 #include <cstdint>
 #include <initializer_list>
@@ -103,9 +105,22 @@ struct VTargetPack {
     KLVSet set;
 };
 
-// Register encode/decode lambdas for the above ULs
+// Constant codec of a numeric item of the VMTI local set or of one of its
+// packs (|st_id| among the four above), nullptr for other items.
+// KLVRegistry::lookup uses these without any registration.
+const KLVCodec* builtin_codec(uint8_t st_id, uint8_t tag);
+
+// Make the ST 0903 codecs visible to KLVRegistry::find as well. Decoding
+// and encoding no longer need it.
 void register_st0903(KLVRegistry& reg);
 
+// ST 1201 mappings of the floating point items: fields of view
+// IMAPB(0, 180, 2), location offsets IMAPB(-19.2, 19.2, 3) and height
+// IMAPB(-900, 19000, 2)
+const st1201::Imap& imap_fov();
+const st1201::Imap& imap_location_offset();
+const st1201::Imap& imap_hae();
+
 // Helper to build a tag-based local set for a given ST0903 sub-set
 KLVSet make_local_set(uint8_t st_id,
                       std::initializer_list<std::shared_ptr<KLVNode>> nodes);
@@ -114,16 +129,22 @@ KLVSet make_local_set(uint8_t st_id,
 std::vector<uint8_t> encode_vtarget_series(const std::vector<VTargetPack>& packs);
 std::vector<uint8_t> encode_vtarget_series(std::initializer_list<VTargetPack> packs);
 std::vector<VTargetPack> decode_vtarget_series(const std::vector<uint8_t>& bytes);
+// Zero-copy form: unregistered items (VChip, VMask, ...) reference |bytes|
+std::vector<VTargetPack> decode_vtarget_series(const ByteSlice& bytes);
+// Packs are framed sequentially, then their local sets decoded on |pool|
+std::vector<VTargetPack> decode_vtarget_series(const ByteSlice& bytes, ThreadPool& pool);
 
 // Helpers for algorithmSeries (tag 102)
 std::vector<uint8_t> encode_algorithm_series(const std::vector<KLVSet>& sets);
 std::vector<uint8_t> encode_algorithm_series(std::initializer_list<KLVSet> sets);
 std::vector<KLVSet> decode_algorithm_series(const std::vector<uint8_t>& bytes);
+std::vector<KLVSet> decode_algorithm_series(const ByteSlice& bytes);
 
 // Helpers for ontologySeries (tag 103)
 std::vector<uint8_t> encode_ontology_series(const std::vector<KLVSet>& sets);
 std::vector<uint8_t> encode_ontology_series(std::initializer_list<KLVSet> sets);
 std::vector<KLVSet> decode_ontology_series(const std::vector<uint8_t>& bytes);
+std::vector<KLVSet> decode_ontology_series(const ByteSlice& bytes);
 
 } // namespace st0903
 } // namespace misb
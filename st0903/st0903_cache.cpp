@@ -0,0 +1,230 @@
+#include "st0903_cache.h"
+#include "klv_bytes.h"
+#include "klv_leaf.h"
+
+#include <cstring>
+#include <stdexcept>
+
+namespace misb {
+namespace st0903 {
+
+namespace {
+
+uint64_t mix(uint64_t h, uint64_t k) {
+    k *= 0x87C37B91114253D5ull;
+    k = (k << 31) | (k >> 33);
+    h ^= k * 0x4CF5AD432745937Full;
+    return ((h << 27) | (h >> 37)) * 5 + 0x52DCE729;
+}
+
+// 8 bytes per step; only used as a lookup key, hits are verified
+uint64_t hash_bytes(const uint8_t* p, size_t n) {
+    uint64_t h = 0x9E3779B97F4A7C15ull ^ n;
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        uint64_t k;
+        std::memcpy(&k, p + i, 8);
+        h = mix(h, k);
+    }
+    if (i < n) {
+        uint64_t tail = 0;
+        std::memcpy(&tail, p + i, n - i);
+        h = mix(h, tail);
+    }
+    h ^= h >> 33;
+    h *= 0xFF51AFD7ED558CCDull;
+    return h ^ (h >> 33);
+}
+
+void append(std::vector<uint8_t>& out, const void* p, size_t n) {
+    const uint8_t* b = static_cast<const uint8_t*>(p);
+    out.insert(out.end(), b, b + n);
+}
+
+void append_size(std::vector<uint8_t>& out, uint64_t n) {
+    append(out, &n, sizeof(n));
+}
+
+// Flat description of everything KLVNode::encode() depends on
+void append_signature(std::vector<uint8_t>& out, const KLVNode& node) {
+    if (const auto* leaf = dynamic_cast<const KLVLeaf*>(&node)) {
+        const double value = leaf->value();
+        out.push_back(leaf->uses_tag() ? 'l' : 'L');
+        append(out, leaf->ul().data(), leaf->ul().size());
+        append(out, &value, sizeof(value));
+    } else if (const auto* bytes = dynamic_cast<const KLVBytes*>(&node)) {
+        out.push_back(bytes->uses_tag() ? 'b' : 'B');
+        append(out, bytes->ul().data(), bytes->ul().size());
+        append_size(out, bytes->slice().size());
+        append(out, bytes->slice().data(), bytes->slice().size());
+    } else if (const auto* set = dynamic_cast<const KLVSet*>(&node)) {
+        out.push_back('S');
+        append_size(out, set->children().size());
+        for (const auto& child : set->children()) {
+            append_signature(out, *child);
+        }
+    } else {
+        // Unknown node type: its encoding is its signature
+        const auto encoded = node.encode();
+        out.push_back('N');
+        append_size(out, encoded.size());
+        append(out, encoded.data(), encoded.size());
+    }
+}
+
+} // namespace
+
+SeriesCache::SeriesCache(uint8_t st_id, size_t capacity)
+    : st_id_(st_id), capacity_(capacity), clock_(0), hits_(0), misses_(0) {
+    if (st_id != ALGORITHM_ST_ID && st_id != ONTOLOGY_ST_ID) {
+        throw std::invalid_argument("SeriesCache supports algorithm and ontology series only");
+    }
+    if (capacity == 0) {
+        throw std::invalid_argument("SeriesCache capacity must be positive");
+    }
+}
+
+template <typename Entry>
+Entry* SeriesCache::find(std::vector<Entry>& entries, const Index& index, uint64_t hash) {
+    auto it = index.find(hash);
+    return it == index.end() ? nullptr : &entries[it->second];
+}
+
+template <typename Entry>
+Entry& SeriesCache::slot(std::vector<Entry>& entries, Index& index, uint64_t hash) {
+    // A colliding or concurrently inserted hash takes over the existing entry
+    auto it = index.find(hash);
+    if (it != index.end()) return entries[it->second];
+    size_t pos = entries.size();
+    if (pos < capacity_) {
+        entries.emplace_back();
+    } else {
+        pos = 0;
+        for (size_t i = 1; i < entries.size(); ++i) {
+            if (entries[i].last_use < entries[pos].last_use) pos = i;
+        }
+        index.erase(entries[pos].hash);
+    }
+    index[hash] = pos;
+    return entries[pos];
+}
+
+std::shared_ptr<const SeriesCache::Sets> SeriesCache::decode(const std::vector<uint8_t>& bytes) {
+    const uint64_t hash = hash_bytes(bytes.data(), bytes.size());
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        DecodeEntry* entry = find(decoded_, decoded_index_, hash);
+        if (entry && entry->bytes == bytes) {
+            entry->last_use = ++clock_;
+            ++hits_;
+            return entry->sets;
+        }
+    }
+
+    // Decode outside the lock; a concurrent miss on the same payload only
+    // costs a duplicate decode
+    std::shared_ptr<const Sets> sets = std::make_shared<const Sets>(
+        st_id_ == ALGORITHM_ST_ID ? decode_algorithm_series(bytes)
+                                  : decode_ontology_series(bytes));
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++misses_;
+    DecodeEntry& entry = slot(decoded_, decoded_index_, hash);
+    entry.hash = hash;
+    entry.last_use = ++clock_;
+    entry.bytes = bytes;
+    entry.sets = sets;
+    return sets;
+}
+
+std::shared_ptr<const std::vector<uint8_t>> SeriesCache::encode(const Sets& sets) {
+    // Signature buffer reused across calls of the same thread
+    static thread_local std::vector<uint8_t> signature;
+    signature.clear();
+    append_size(signature, sets.size());
+    for (const auto& set : sets) {
+        append_signature(signature, set);
+    }
+    const uint64_t hash = hash_bytes(signature.data(), signature.size());
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        EncodeEntry* entry = find(encoded_, encoded_index_, hash);
+        if (entry && entry->signature == signature) {
+            entry->last_use = ++clock_;
+            ++hits_;
+            return entry->bytes;
+        }
+    }
+
+    // Same as decode: a concurrent miss only costs a duplicate encode
+    auto bytes = std::make_shared<const std::vector<uint8_t>>(
+        st_id_ == ALGORITHM_ST_ID ? encode_algorithm_series(sets)
+                                  : encode_ontology_series(sets));
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++misses_;
+    EncodeEntry& entry = slot(encoded_, encoded_index_, hash);
+    entry.hash = hash;
+    entry.last_use = ++clock_;
+    entry.signature = signature;
+    entry.bytes = bytes;
+    return bytes;
+}
+
+size_t SeriesCache::hits() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return hits_;
+}
+
+size_t SeriesCache::misses() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return misses_;
+}
+
+size_t SeriesCache::size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return decoded_.size() + encoded_.size();
+}
+
+void SeriesCache::clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    decoded_.clear();
+    encoded_.clear();
+    decoded_index_.clear();
+    encoded_index_.clear();
+    hits_ = 0;
+    misses_ = 0;
+}
+
+namespace {
+
+SeriesCache& algorithm_cache() {
+    static SeriesCache cache(ALGORITHM_ST_ID);
+    return cache;
+}
+
+SeriesCache& ontology_cache() {
+    static SeriesCache cache(ONTOLOGY_ST_ID);
+    return cache;
+}
+
+} // namespace
+
+std::shared_ptr<const std::vector<KLVSet>> decode_algorithm_series_cached(const std::vector<uint8_t>& bytes) {
+    return algorithm_cache().decode(bytes);
+}
+
+std::shared_ptr<const std::vector<uint8_t>> encode_algorithm_series_cached(const std::vector<KLVSet>& sets) {
+    return algorithm_cache().encode(sets);
+}
+
+std::shared_ptr<const std::vector<KLVSet>> decode_ontology_series_cached(const std::vector<uint8_t>& bytes) {
+    return ontology_cache().decode(bytes);
+}
+
+std::shared_ptr<const std::vector<uint8_t>> encode_ontology_series_cached(const std::vector<KLVSet>& sets) {
+    return ontology_cache().encode(sets);
+}
+
+} // namespace st0903
+} // namespace misb
@@ -0,0 +1,92 @@
+#pragma once
+
+#include "st0903.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace misb {
+namespace st0903 {
+
+// Cross-frame cache for the algorithm (tag 102) and ontology (tag 103)
+// series, which producers usually repeat unchanged in every VMTI frame.
+//
+// Decoding: payloads are keyed by a 64-bit content hash and compared byte
+// for byte on a hit; identical payloads share one decoded series.
+// Encoding: input sets are reduced to a flat signature (ULs, values and key
+// forms of every node, no per-node allocation) and a matching signature
+// returns the bytes encoded for a previous frame.
+//
+// Returned series are shared between callers and must not be modified.
+// The const only covers the vector and the sets: their children are
+// shared, non-const nodes, so calling set_value() or decode() on a child,
+// or set_encode_cache() on a set, changes the cached series for every
+// caller. Read values out, or build new sets to change them.
+// The least recently used entry is evicted once |capacity| is reached.
+// All members are thread-safe; signatures are built and misses decoded or
+// encoded outside the lock, so callers only serialize on the lookup.
+class SeriesCache {
+public:
+    using Sets = std::vector<KLVSet>;
+
+    // |st_id| selects the decoded set type: ALGORITHM_ST_ID or ONTOLOGY_ST_ID
+    explicit SeriesCache(uint8_t st_id, size_t capacity = 16);
+
+    // Throws std::runtime_error on malformed payloads, like the uncached
+    // decode functions
+    std::shared_ptr<const Sets> decode(const std::vector<uint8_t>& bytes);
+    std::shared_ptr<const std::vector<uint8_t>> encode(const Sets& sets);
+
+    size_t hits() const;
+    size_t misses() const;
+    size_t size() const;
+    void clear();
+
+private:
+    struct DecodeEntry {
+        uint64_t hash;
+        uint64_t last_use;
+        std::vector<uint8_t> bytes;
+        std::shared_ptr<const Sets> sets;
+    };
+    struct EncodeEntry {
+        uint64_t hash;
+        uint64_t last_use;
+        std::vector<uint8_t> signature;
+        std::shared_ptr<const std::vector<uint8_t>> bytes;
+    };
+
+    using Index = std::unordered_map<uint64_t, size_t>;
+
+    // Entry stored under |hash|, nullptr when none
+    template <typename Entry>
+    static Entry* find(std::vector<Entry>& entries, const Index& index, uint64_t hash);
+    // Entry to overwrite for |hash|: the one already under it, a new one,
+    // or the least recently used one
+    template <typename Entry>
+    Entry& slot(std::vector<Entry>& entries, Index& index, uint64_t hash);
+
+    uint8_t st_id_;
+    size_t capacity_;
+    mutable std::mutex mutex_;
+    uint64_t clock_;
+    size_t hits_;
+    size_t misses_;
+    std::vector<DecodeEntry> decoded_;
+    std::vector<EncodeEntry> encoded_;
+    Index decoded_index_;
+    Index encoded_index_;
+};
+
+// Cached forms of the series helpers backed by process-wide caches
+std::shared_ptr<const std::vector<KLVSet>> decode_algorithm_series_cached(const std::vector<uint8_t>& bytes);
+std::shared_ptr<const std::vector<uint8_t>> encode_algorithm_series_cached(const std::vector<KLVSet>& sets);
+std::shared_ptr<const std::vector<KLVSet>> decode_ontology_series_cached(const std::vector<uint8_t>& bytes);
+std::shared_ptr<const std::vector<uint8_t>> encode_ontology_series_cached(const std::vector<KLVSet>& sets);
+
+} // namespace st0903
+} // namespace misb
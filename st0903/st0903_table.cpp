@@ -0,0 +1,440 @@
+#include "st0903_table.h"
+#include "klv_thread_pool.h"
+#include "st_common.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+namespace misb {
+namespace st0903 {
+
+namespace {
+
+// Open-addressing set of target ids; grows at 50% load
+class IdSet {
+public:
+    explicit IdSet(size_t expected) {
+        size_t cap = 16;
+        while (cap < expected * 2) cap <<= 1;
+        keys_.assign(cap, 0);
+        used_.assign(cap, 0);
+    }
+
+    // Returns false when |id| was already present
+    bool insert(uint64_t id) {
+        if ((count_ + 1) * 2 > keys_.size()) grow();
+        const size_t mask = keys_.size() - 1;
+        for (size_t i = mix(id) & mask;; i = (i + 1) & mask) {
+            if (!used_[i]) {
+                used_[i] = 1;
+                keys_[i] = id;
+                ++count_;
+                return true;
+            }
+            if (keys_[i] == id) return false;
+        }
+    }
+
+private:
+    static size_t mix(uint64_t x) {
+        x ^= x >> 33;
+        x *= 0xff51afd7ed558ccdULL;
+        x ^= x >> 33;
+        x *= 0xc4ceb9fe1a85ec53ULL;
+        x ^= x >> 33;
+        return static_cast<size_t>(x);
+    }
+
+    void grow() {
+        std::vector<uint64_t> keys;
+        std::vector<uint8_t> used;
+        keys.swap(keys_);
+        used.swap(used_);
+        keys_.assign(keys.size() * 2, 0);
+        used_.assign(used.size() * 2, 0);
+        count_ = 0;
+        for (size_t i = 0; i < keys.size(); ++i) {
+            if (used[i]) insert(keys[i]);
+        }
+    }
+
+    std::vector<uint64_t> keys_;
+    std::vector<uint8_t> used_;
+    size_t count_ = 0;
+};
+
+uint64_t read_uint(const uint8_t* p, size_t len) {
+    uint64_t v = 0;
+    misb::read_uint_be(p, len, len, v);
+    return v;
+}
+
+bool read_imap(const uint8_t* p, size_t len, const st1201::Imap& imap, double& out) {
+    if (len == 0 || len > 8) return false;
+    out = st1201::decode(imap, p, len);
+    return true;
+}
+
+
+// Store one vTarget item into row |row|. Unknown tags and malformed lengths
+// leave the column absent.
+void store_item(VTargetTable& t, size_t row, uint8_t tag, const uint8_t* v, size_t len) {
+    uint32_t& present = t.present[row];
+    switch (tag) {
+    case 1:
+        if (len < 1 || len > 6) return;
+        t.centroid[row] = read_uint(v, len);
+        present |= VTARGET_FIELD_CENTROID;
+        break;
+    case 2:
+        if (len < 1 || len > 6) return;
+        t.bbox_top_left[row] = read_uint(v, len);
+        present |= VTARGET_FIELD_BBOX_TOP_LEFT;
+        break;
+    case 3:
+        if (len < 1 || len > 6) return;
+        t.bbox_bottom_right[row] = read_uint(v, len);
+        present |= VTARGET_FIELD_BBOX_BOTTOM_RIGHT;
+        break;
+    case 4:
+        if (len != 1) return;
+        t.priority[row] = v[0];
+        present |= VTARGET_FIELD_PRIORITY;
+        break;
+    case 5:
+        if (len != 1) return;
+        t.confidence[row] = static_cast<double>(v[0]) / 100.0;
+        present |= VTARGET_FIELD_CONFIDENCE;
+        break;
+    case 10:
+        if (!read_imap(v, len, imap_location_offset(), t.lat_offset[row])) return;
+        present |= VTARGET_FIELD_LAT_OFFSET;
+        break;
+    case 11:
+        if (!read_imap(v, len, imap_location_offset(), t.lon_offset[row])) return;
+        present |= VTARGET_FIELD_LON_OFFSET;
+        break;
+    case 12:
+        if (!read_imap(v, len, imap_hae(), t.hae[row])) return;
+        present |= VTARGET_FIELD_HAE;
+        break;
+    case 19:
+        if (len < 1 || len > 4) return;
+        t.centroid_row[row] = static_cast<uint32_t>(read_uint(v, len));
+        present |= VTARGET_FIELD_CENTROID_ROW;
+        break;
+    case 20:
+        if (len < 1 || len > 4) return;
+        t.centroid_column[row] = static_cast<uint32_t>(read_uint(v, len));
+        present |= VTARGET_FIELD_CENTROID_COLUMN;
+        break;
+    case 22:
+        if (len < 1 || len > 3) return;
+        t.algorithm_id[row] = static_cast<uint32_t>(read_uint(v, len));
+        present |= VTARGET_FIELD_ALGORITHM_ID;
+        break;
+    case 23:
+        if (len != 1) return;
+        t.detection_status[row] = v[0];
+        present |= VTARGET_FIELD_DETECTION_STATUS;
+        break;
+    default:
+        break;
+    }
+}
+
+size_t uint_width(uint64_t v) {
+    return misb::uint_byte_width(v);
+}
+
+// Writers take the end of their presized destination and throw when a
+// value does not fit, i.e. when the size and write passes disagree
+size_t room(const uint8_t* p, const uint8_t* end) {
+    return p < end ? static_cast<size_t>(end - p) : 0;
+}
+
+uint8_t* advance(uint8_t* p, size_t written) {
+    if (written == 0) throw std::runtime_error("VTarget series overflows its buffer");
+    return p + written;
+}
+
+uint8_t* write_uint(uint8_t* p, uint8_t* end, uint64_t v, size_t width) {
+    return advance(p, misb::write_uint_be(p, room(p, end), v, width));
+}
+
+uint8_t* write_ber_length(uint8_t* p, uint8_t* end, size_t len) {
+    return advance(p, misb::write_ber_length(p, room(p, end), len));
+}
+
+uint64_t clamp_uint(uint64_t v, size_t max_width) {
+    const uint64_t max_value = (uint64_t{1} << (max_width * 8)) - 1;
+    return v > max_value ? max_value : v;
+}
+
+uint8_t percent_raw(double value) {
+    double scaled = value;
+    if (scaled <= 1.0) {
+        scaled *= 100.0;
+    }
+    const double clamped = scaled < 0.0 ? 0.0 : (scaled > 100.0 ? 100.0 : scaled);
+    return static_cast<uint8_t>(std::lround(clamped));
+}
+
+// Size of the items of row |r| (without target id and pack length)
+size_t items_size(const VTargetTable& t, size_t r) {
+    const uint32_t p = t.present[r];
+    size_t n = 0;
+    if (p & VTARGET_FIELD_CENTROID) n += 2 + uint_width(clamp_uint(t.centroid[r], 6));
+    if (p & VTARGET_FIELD_BBOX_TOP_LEFT) n += 2 + uint_width(clamp_uint(t.bbox_top_left[r], 6));
+    if (p & VTARGET_FIELD_BBOX_BOTTOM_RIGHT) n += 2 + uint_width(clamp_uint(t.bbox_bottom_right[r], 6));
+    if (p & VTARGET_FIELD_PRIORITY) n += 3;
+    if (p & VTARGET_FIELD_CONFIDENCE) n += 3;
+    if (p & VTARGET_FIELD_LAT_OFFSET) n += 5;
+    if (p & VTARGET_FIELD_LON_OFFSET) n += 5;
+    if (p & VTARGET_FIELD_HAE) n += 4;
+    if (p & VTARGET_FIELD_CENTROID_ROW) n += 2 + uint_width(t.centroid_row[r]);
+    if (p & VTARGET_FIELD_CENTROID_COLUMN) n += 2 + uint_width(t.centroid_column[r]);
+    if (p & VTARGET_FIELD_ALGORITHM_ID) n += 2 + uint_width(clamp_uint(t.algorithm_id[r], 3));
+    if (p & VTARGET_FIELD_DETECTION_STATUS) n += 3;
+    return n;
+}
+
+uint8_t* write_fixed_item(uint8_t* p, uint8_t* end, uint8_t tag, uint64_t v, size_t width) {
+    p = write_uint(p, end, tag, 1);
+    p = write_uint(p, end, width, 1);
+    return write_uint(p, end, v, width);
+}
+
+uint8_t* write_var_item(uint8_t* p, uint8_t* end, uint8_t tag, uint64_t v) {
+    return write_fixed_item(p, end, tag, v, uint_width(v));
+}
+
+uint8_t* write_pack(uint8_t* p, uint8_t* end, const VTargetTable& t, size_t r, size_t pack_len) {
+    const uint32_t f = t.present[r];
+    p = write_ber_length(p, end, pack_len);
+    p = advance(p, misb::write_ber_oid(p, room(p, end), t.id[r]));
+    if (f & VTARGET_FIELD_CENTROID) p = write_var_item(p, end, 1, clamp_uint(t.centroid[r], 6));
+    if (f & VTARGET_FIELD_BBOX_TOP_LEFT) p = write_var_item(p, end, 2, clamp_uint(t.bbox_top_left[r], 6));
+    if (f & VTARGET_FIELD_BBOX_BOTTOM_RIGHT) p = write_var_item(p, end, 3, clamp_uint(t.bbox_bottom_right[r], 6));
+    if (f & VTARGET_FIELD_PRIORITY) p = write_fixed_item(p, end, 4, t.priority[r], 1);
+    if (f & VTARGET_FIELD_CONFIDENCE) p = write_fixed_item(p, end, 5, percent_raw(t.confidence[r]), 1);
+    if (f & VTARGET_FIELD_LAT_OFFSET) p = write_fixed_item(p, end, 10, st1201::to_raw(imap_location_offset(), t.lat_offset[r]), 3);
+    if (f & VTARGET_FIELD_LON_OFFSET) p = write_fixed_item(p, end, 11, st1201::to_raw(imap_location_offset(), t.lon_offset[r]), 3);
+    if (f & VTARGET_FIELD_HAE) p = write_fixed_item(p, end, 12, st1201::to_raw(imap_hae(), t.hae[r]), 2);
+    if (f & VTARGET_FIELD_CENTROID_ROW) p = write_var_item(p, end, 19, t.centroid_row[r]);
+    if (f & VTARGET_FIELD_CENTROID_COLUMN) p = write_var_item(p, end, 20, t.centroid_column[r]);
+    if (f & VTARGET_FIELD_ALGORITHM_ID) p = write_var_item(p, end, 22, clamp_uint(t.algorithm_id[r], 3));
+    if (f & VTARGET_FIELD_DETECTION_STATUS) p = write_fixed_item(p, end, 23, t.detection_status[r], 1);
+    return p;
+}
+
+// Run |fn(begin, end)| over [0, n) split in at most |threads|
+// non-empty contiguous chunks, on the shared thread pool
+template <typename Fn>
+void for_chunks(size_t n, unsigned threads, Fn fn) {
+    if (threads <= 1 || n < 2 * static_cast<size_t>(threads)) {
+        fn(size_t{0}, n);
+        return;
+    }
+    const size_t chunk = (n + threads - 1) / threads;
+    ThreadPool::shared().parallel_for(n, chunk, fn);
+}
+
+// First pass: length of every pack and of the whole series
+size_t size_series(const VTargetTable& t, std::vector<size_t>& pack_len, unsigned threads) {
+    const size_t n = t.size();
+    pack_len.resize(n);
+    for_chunks(n, threads, [&](size_t begin, size_t end) {
+        for (size_t r = begin; r < end; ++r) {
+            const size_t items = items_size(t, r);
+            pack_len[r] = items ? misb::ber_oid_size(t.id[r]) + items : 0;
+        }
+    });
+    size_t total = 0;
+    for (size_t r = 0; r < n; ++r) {
+        if (pack_len[r] == 0) {
+            throw std::runtime_error("VTarget pack must include at least one TLV");
+        }
+        total += misb::ber_length_size(pack_len[r]) + pack_len[r];
+    }
+    return total;
+}
+
+// Second pass: write every pack to [out, end), presized by size_series
+void write_series(const VTargetTable& t,
+                  const std::vector<size_t>& pack_len,
+                  uint8_t* out,
+                  uint8_t* end,
+                  unsigned threads) {
+    const size_t n = t.size();
+    if (threads <= 1 || n < 2 * static_cast<size_t>(threads)) {
+        for (size_t r = 0; r < n; ++r) {
+            out = write_pack(out, end, t, r, pack_len[r]);
+        }
+        return;
+    }
+    // Each chunk starts at the running total of the packs before it
+    const size_t chunk = (n + threads - 1) / threads;
+    std::vector<size_t> starts;
+    size_t offset = 0;
+    for (size_t r = 0; r < n; ++r) {
+        if (r % chunk == 0) starts.push_back(offset);
+        offset += misb::ber_length_size(pack_len[r]) + pack_len[r];
+    }
+    starts.push_back(offset);
+    for_chunks(n, threads, [&](size_t begin, size_t stop) {
+        // Each chunk may only write up to the start of the next one
+        uint8_t* p = out + starts[begin / chunk];
+        uint8_t* chunk_end = std::min(end, out + starts[begin / chunk + 1]);
+        for (size_t r = begin; r < stop; ++r) {
+            p = write_pack(p, chunk_end, t, r, pack_len[r]);
+        }
+    });
+}
+
+void check_unique(const VTargetTable& t) {
+    IdSet seen(t.size());
+    for (uint64_t id : t.id) {
+        if (!seen.insert(id)) {
+            throw std::runtime_error("Duplicate targetId in vTarget series");
+        }
+    }
+}
+
+} // namespace
+
+void VTargetTable::clear() {
+    id.clear();
+    centroid.clear();
+    bbox_top_left.clear();
+    bbox_bottom_right.clear();
+    priority.clear();
+    confidence.clear();
+    lat_offset.clear();
+    lon_offset.clear();
+    hae.clear();
+    centroid_row.clear();
+    centroid_column.clear();
+    detection_status.clear();
+    algorithm_id.clear();
+    present.clear();
+}
+
+void VTargetTable::reserve(size_t n) {
+    id.reserve(n);
+    centroid.reserve(n);
+    bbox_top_left.reserve(n);
+    bbox_bottom_right.reserve(n);
+    priority.reserve(n);
+    confidence.reserve(n);
+    lat_offset.reserve(n);
+    lon_offset.reserve(n);
+    hae.reserve(n);
+    centroid_row.reserve(n);
+    centroid_column.reserve(n);
+    detection_status.reserve(n);
+    algorithm_id.reserve(n);
+    present.reserve(n);
+}
+
+size_t VTargetTable::add(uint64_t target_id) {
+    id.push_back(target_id);
+    centroid.push_back(0);
+    bbox_top_left.push_back(0);
+    bbox_bottom_right.push_back(0);
+    priority.push_back(0);
+    confidence.push_back(0.0);
+    lat_offset.push_back(0.0);
+    lon_offset.push_back(0.0);
+    hae.push_back(0.0);
+    centroid_row.push_back(0);
+    centroid_column.push_back(0);
+    detection_status.push_back(0);
+    algorithm_id.push_back(0);
+    present.push_back(0);
+    return id.size() - 1;
+}
+
+void decode_vtarget_table(const uint8_t* data, size_t size, VTargetTable& table) {
+    table.clear();
+    // Rough row estimate; dense detection packs are rarely under 16 bytes
+    table.reserve(size / 16);
+    IdSet seen(size / 16);
+    size_t offset = 0;
+    while (offset < size) {
+        size_t pack_len = 0;
+        size_t len_bytes = 0;
+        if (!misb::decode_ber_length(data, size, offset, pack_len, len_bytes)) {
+            throw std::runtime_error("Invalid BER length inside vTarget series");
+        }
+        offset += len_bytes;
+        if (pack_len > size - offset) {
+            throw std::runtime_error("Truncated vTarget pack");
+        }
+        if (pack_len == 0) {
+            throw std::runtime_error("Empty vTarget pack");
+        }
+        const uint8_t* pack = data + offset;
+        uint64_t target_id = 0;
+        const size_t oid_len = misb::read_ber_oid(pack, pack_len, target_id);
+        if (oid_len == 0) {
+            throw std::runtime_error("BER OID did not terminate before end of buffer");
+        }
+        if (oid_len >= pack_len) {
+            throw std::runtime_error("VTarget pack missing payload items");
+        }
+        if (!seen.insert(target_id)) {
+            throw std::runtime_error("Duplicate targetId encountered while decoding vTarget series");
+        }
+        const size_t row = table.add(target_id);
+        size_t i = oid_len;
+        size_t items = 0;
+        while (i < pack_len) {
+            const uint8_t tag = pack[i++];
+            size_t len = 0;
+            if (!misb::decode_ber_length(pack, pack_len, i, len, len_bytes)) break;
+            i += len_bytes;
+            if (len > pack_len - i) break;
+            store_item(table, row, tag, pack + i, len);
+            ++items;
+            i += len;
+        }
+        if (items == 0) {
+            throw std::runtime_error("VTarget pack contained no TLVs");
+        }
+        offset += pack_len;
+    }
+}
+
+std::vector<uint8_t> encode_vtarget_table(const VTargetTable& table, unsigned threads) {
+    check_unique(table);
+    std::vector<size_t> pack_len;
+    const size_t total = size_series(table, pack_len, threads);
+    std::vector<uint8_t> out(total);
+    write_series(table, pack_len, out.data(), out.data() + out.size(), threads);
+    return out;
+}
+
+std::vector<uint8_t> encode_vmti_frame(const KLVSet& header,
+                                       const VTargetTable& targets,
+                                       unsigned threads) {
+    if (header.uses_ul_keys()) {
+        throw std::runtime_error("VMTI header must be encoded using Tag-Length-Value items");
+    }
+    check_unique(targets);
+    const auto head = header.encode();
+    std::vector<size_t> pack_len;
+    const size_t series = size_series(targets, pack_len, threads);
+    std::vector<uint8_t> out(head.size() + 1 + misb::ber_length_size(series) + series);
+    uint8_t* const end = out.data() + out.size();
+    uint8_t* p = std::copy(head.begin(), head.end(), out.data());
+    *p++ = VMTI_VTARGET_SERIES[15];
+    p = write_ber_length(p, end, series);
+    write_series(targets, pack_len, p, end, threads);
+    return out;
+}
+
+} // namespace st0903
+} // namespace misb
@@ -0,0 +1,80 @@
+#pragma once
+
+#include "st0903.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace misb {
+namespace st0903 {
+
+// Presence bits of the columns of a VTargetTable
+enum VTargetField : uint32_t {
+    VTARGET_FIELD_CENTROID = 1u << 0,
+    VTARGET_FIELD_BBOX_TOP_LEFT = 1u << 1,
+    VTARGET_FIELD_BBOX_BOTTOM_RIGHT = 1u << 2,
+    VTARGET_FIELD_PRIORITY = 1u << 3,
+    VTARGET_FIELD_CONFIDENCE = 1u << 4,
+    VTARGET_FIELD_LAT_OFFSET = 1u << 5,
+    VTARGET_FIELD_LON_OFFSET = 1u << 6,
+    VTARGET_FIELD_HAE = 1u << 7,
+    VTARGET_FIELD_CENTROID_ROW = 1u << 8,
+    VTARGET_FIELD_CENTROID_COLUMN = 1u << 9,
+    VTARGET_FIELD_DETECTION_STATUS = 1u << 10,
+    VTARGET_FIELD_ALGORITHM_ID = 1u << 11
+};
+
+// Structure-of-arrays view of a vTarget series (tag 101). Row i of every
+// column describes target i; |present| holds the VTargetField bits telling
+// which columns were transmitted for that target. Absent values are zero.
+struct VTargetTable {
+    std::vector<uint64_t> id;
+    std::vector<uint64_t> centroid;
+    std::vector<uint64_t> bbox_top_left;
+    std::vector<uint64_t> bbox_bottom_right;
+    std::vector<uint8_t> priority;
+    std::vector<double> confidence;
+    std::vector<double> lat_offset;
+    std::vector<double> lon_offset;
+    std::vector<double> hae;
+    std::vector<uint32_t> centroid_row;
+    std::vector<uint32_t> centroid_column;
+    std::vector<uint8_t> detection_status;
+    std::vector<uint32_t> algorithm_id;
+    std::vector<uint32_t> present;
+
+    size_t size() const { return id.size(); }
+    bool has(size_t row, VTargetField field) const { return (present[row] & field) != 0; }
+    void clear();
+    void reserve(size_t n);
+    // Append a target with no fields set and return its row
+    size_t add(uint64_t target_id);
+};
+
+// Parse a vTarget series straight into |table| (previous content is
+// discarded). Same validation as decode_vtarget_series: malformed lengths,
+// empty packs and duplicate target ids throw std::runtime_error. Items that
+// have no column in the table are skipped.
+void decode_vtarget_table(const uint8_t* data, size_t size, VTargetTable& table);
+
+inline void decode_vtarget_table(const std::vector<uint8_t>& bytes, VTargetTable& table) {
+    decode_vtarget_table(bytes.data(), bytes.size(), table);
+}
+
+// Encode a columnar table as a vTarget series in one presized buffer. Each
+// target emits the items flagged in |present|, in tag order, with the same
+// codecs as the registry. With |threads| > 1 the targets are split in as
+// many chunks, run on ThreadPool::shared(), that write their packs at
+// precomputed offsets. Duplicate ids and targets without items throw
+// std::runtime_error.
+std::vector<uint8_t> encode_vtarget_table(const VTargetTable& table, unsigned threads = 1);
+
+// Encode a complete ST 0903 local set: the items of |header| (a tag-based
+// set) followed by VMTI_VTARGET_SERIES built from |targets|.
+std::vector<uint8_t> encode_vmti_frame(const KLVSet& header,
+                                       const VTargetTable& targets,
+                                       unsigned threads = 1);
+
+} // namespace st0903
+} // namespace misb
@@ -0,0 +1,243 @@
+#include "klv.h"
+#include "klv_index.h"
+#include "klv_macros.h"
+#include "st0601.h"
+#include "st0601_archive.h"
+#include "st0601_scan.h"
+#include "st_common.h"
+#include "stanag.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+static std::vector<uint8_t> make_packet(double ts, double lat, double lon) {
+    return STANAG4609_PACKET(
+        KLV_ST_ITEM(0601, UNIX_TIMESTAMP, ts),
+        KLV_ST_ITEM(0601, FRAME_CENTER_LATITUDE, lat),
+        KLV_ST_ITEM(0601, FRAME_CENTER_LONGITUDE, lon),
+        KLV_ST_ITEM(0601, PLATFORM_DESIGNATION, "FalconEye")
+    );
+}
+
+static void write_file(const std::string& path, const std::vector<uint8_t>& data) {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+}
+
+int main() {
+    auto& reg = KLVRegistry::instance();
+    misb::st0601::register_st0601(reg);
+
+    // Synthetic archive: 100 packets at 10 Hz with some junk between them
+    std::vector<uint8_t> archive;
+    std::vector<size_t> offsets;
+    for (int i = 0; i < 100; ++i) {
+        if (i % 10 == 3) {
+            archive.push_back(0x06);
+            archive.push_back(0x0E);
+            archive.push_back(0xFF);
+        }
+        offsets.push_back(archive.size());
+        auto packet = make_packet(1000000.0 + i * 100000.0, 45.0 + i * 0.01, 2.0 + i * 0.01);
+        archive.insert(archive.end(), packet.begin(), packet.end());
+    }
+
+    // Packet framing and tag lookup on raw bytes
+    stanag::PacketView view;
+    assert(stanag::find_next_packet(archive.data(), archive.size(), 0, view));
+    assert(view.offset == offsets[0]);
+    size_t value_offset = 0, value_len = 0;
+    assert(misb::find_local_tag(archive.data() + view.payload_offset, view.payload_length,
+                                2, value_offset, value_len));
+    assert(value_len == 8);
+    assert(!misb::find_local_tag(archive.data() + view.payload_offset, view.payload_length,
+                                 99, value_offset, value_len));
+
+    // Sidecar seek index
+    const std::string archive_path = "archive_tests.klv";
+    const std::string index_path = "archive_tests.klvidx";
+    write_file(archive_path, archive);
+    stanag::IndexBuilder builder;
+    assert(builder.scan_file(archive_path, 7) == 100);
+    assert(builder.write(index_path));
+
+    stanag::IndexReader index(index_path);
+    assert(index.size() == 100);
+    auto e = index.entry(42);
+    assert(e.offset == offsets[42]);
+    assert(e.timestamp == 1000000u + 42u * 100000u);
+    assert(e.feed_id == 7);
+    auto span = index.find(1000000u + 10u * 100000u, 1000000u + 19u * 100000u);
+    assert(span.first == 10 && span.second == 20);
+    auto range = index.range(1000000u + 10u * 100000u, 1000000u + 19u * 100000u);
+    assert(range.packets == 10);
+    assert(range.begin == offsets[10]);
+    assert(range.end == offsets[20]);
+    auto none = index.range(0, 10);
+    assert(none.packets == 0);
+    assert(index.range(0, UINT64_MAX, 8).packets == 0);
+
+    // A packet whose length runs past the end of the archive loses no
+    // packet behind it
+    {
+        std::vector<uint8_t> damaged(archive.begin(), archive.begin() + static_cast<long>(offsets[50]));
+        damaged.insert(damaged.end(), stanag::UAS_DATALINK_LOCAL_SET_UL.begin(),
+                       stanag::UAS_DATALINK_LOCAL_SET_UL.end());
+        const uint8_t huge[] = {0x83, 0xFF, 0xFF, 0xFF};
+        damaged.insert(damaged.end(), huge, huge + sizeof(huge));
+        damaged.insert(damaged.end(), archive.begin() + static_cast<long>(view.payload_offset),
+                       archive.begin() + static_cast<long>(view.payload_offset + view.payload_length));
+        damaged.insert(damaged.end(), archive.begin() + static_cast<long>(offsets[50]), archive.end());
+        size_t framed = 0;
+        for (size_t from = 0; stanag::find_next_packet(damaged.data(), damaged.size(), from, view);
+             from = view.offset + view.length) {
+            ++framed;
+        }
+        assert(framed == 100);
+        stanag::IndexBuilder damaged_index;
+        assert(damaged_index.scan(damaged.data(), damaged.size(), 7) == 100);
+        misb::st0601::ScanQuery all;
+        all.where(misb::st0601::FRAME_CENTER_LATITUDE, 40.0, 50.0);
+        assert(misb::st0601::scan(damaged.data(), damaged.size(), all).size() == 100);
+        stanag::PacketFramer framer;
+        size_t streamed = 0;
+        for (size_t pos = 0; pos < damaged.size(); pos += 1000) {
+            const size_t n = std::min<size_t>(1000, damaged.size() - pos);
+            framer.push(damaged.data() + pos, n, [&](const uint8_t*, size_t) { ++streamed; });
+        }
+        assert(streamed == 100 && framer.pending() == 0);
+    }
+
+    // Columnar archive round trip
+    std::vector<std::vector<uint8_t>> packets;
+    for (int i = 0; i < 100; ++i) {
+        packets.push_back(std::vector<uint8_t>(archive.begin() + static_cast<long>(offsets[i]),
+                                               archive.begin() + static_cast<long>(offsets[i]) +
+                                                   static_cast<long>(index.entry(static_cast<size_t>(i)).length)));
+    }
+    packets.push_back(STANAG4609_PACKET(KLV_ST_ITEM(0601, UNIX_TIMESTAMP, 1000000.0 + 100 * 100000.0)));
+    const std::string columnar_path = "archive_tests.klvcol";
+    {
+        misb::st0601::ArchiveWriter writer(columnar_path, 32);
+        for (const auto& p : packets) {
+            assert(writer.append(p));
+        }
+        std::vector<uint8_t> corrupt = packets.front();
+        corrupt.back() ^= 0xFF;
+        assert(!writer.append(corrupt));
+        writer.close();
+        assert(writer.block_count() == 4);
+    }
+    misb::st0601::ArchiveReader columnar(columnar_path);
+    assert(columnar.block_count() == 4);
+    assert(columnar.block(1).rows == 32);
+    assert(columnar.block(1).min_timestamp == 1000000u + 32u * 100000u);
+    std::vector<std::vector<uint8_t>> restored;
+    for (size_t b = 0; b < columnar.block_count(); ++b) {
+        auto block = columnar.read_block(b);
+        restored.insert(restored.end(), block.begin(), block.end());
+    }
+    assert(restored == packets);
+    bool found_lat = false;
+    for (const auto& stats : columnar.block_stats(0)) {
+        if (stats.tag == 23) {
+            found_lat = true;
+            assert(stats.numeric && stats.is_signed && stats.width == 4);
+            assert(stats.count == 32);
+            assert(stats.min < stats.max);
+        } else if (stats.tag == 10) {
+            assert(!stats.numeric);
+        }
+    }
+    assert(found_lat);
+    assert(columnar.find_block(1000000u + 40u * 100000u) == 1);
+    assert(columnar.find_block(UINT64_MAX) == columnar.block_count());
+
+    // Seeking still finds blocks after the clock jumps back
+    {
+        const std::string jumpy_path = "archive_tests_jumpy.klvcol";
+        {
+            misb::st0601::ArchiveWriter writer(jumpy_path, 2);
+            const double times[] = {10, 20, 30, 40, 5, 6, 50, 60};
+            for (double t : times) {
+                assert(writer.append(STANAG4609_PACKET(KLV_ST_ITEM(0601, UNIX_TIMESTAMP, t))));
+            }
+            writer.close();
+        }
+        misb::st0601::ArchiveReader jumpy(jumpy_path);
+        assert(jumpy.block_count() == 4);
+        assert(jumpy.find_block(25) == 1);
+        assert(jumpy.find_block(6) == 0 && jumpy.find_block(45) == 3);
+        assert(jumpy.find_block(61) == 4);
+        std::remove(jumpy_path.c_str());
+    }
+
+    // Predicate pushdown on raw bytes agrees with decode-then-filter
+    misb::st0601::ScanQuery query;
+    query.time_range(1000000u + 20u * 100000u, 1000000u + 80u * 100000u)
+        .frame_center_within(45.30, 45.60, 2.0, 2.5);
+    auto hits = misb::st0601::scan(archive.data(), archive.size(), query);
+    auto hits_mt = misb::st0601::scan(archive.data(), archive.size(), query, 4);
+    assert(hits.size() == hits_mt.size());
+    size_t expected_hits = 0;
+    for (size_t i = 0; i < offsets.size(); ++i) {
+        const double lat = 45.0 + static_cast<double>(i) * 0.01;
+        const double lon = 2.0 + static_cast<double>(i) * 0.01;
+        const bool in_time = i >= 20 && i <= 80;
+        const bool in_box = lat >= 45.30 - 1e-6 && lat <= 45.60 + 1e-6 && lon <= 2.5 + 1e-6;
+        if (in_time && in_box) ++expected_hits;
+    }
+    assert(hits.size() == expected_hits);
+    for (size_t i = 0; i < hits.size(); ++i) {
+        assert(hits[i].offset == hits_mt[i].offset);
+    }
+    auto decoded_hits = misb::st0601::decode_matches(archive.data(), hits);
+    assert(decoded_hits.size() == hits.size());
+    for (const auto& set : decoded_hits) {
+        double fc_lat = 0.0, ts = 0.0;
+        ST_GET(set, 0601, FRAME_CENTER_LATITUDE, fc_lat);
+        ST_GET(set, 0601, UNIX_TIMESTAMP, ts);
+        assert(fc_lat >= 45.30 - 1e-6 && fc_lat <= 45.60 + 1e-6);
+        assert(ts >= 1000000.0 + 20 * 100000.0 && ts <= 1000000.0 + 80 * 100000.0);
+    }
+    misb::st0601::ScanQuery open_ended;
+    open_ended.time_range(1000000u + 90u * 100000u, UINT64_MAX);
+    assert(misb::st0601::scan(archive.data(), archive.size(), open_ended).size() == 10);
+    bool rejected = false;
+    try {
+        misb::st0601::ScanQuery().frame_center_within(45.0, 46.0, 179.0, -179.0);
+    } catch (const std::invalid_argument&) {
+        rejected = true;
+    }
+    assert(rejected);
+    misb::st0601::ScanQuery impossible;
+    impossible.where(misb::st0601::SENSOR_LATITUDE, -10.0, 10.0);
+    assert(misb::st0601::scan(archive.data(), archive.size(), impossible).empty());
+
+    // A repeated tag cannot stand in for a missing one
+    {
+        const auto doubled = stanag::create_stanag4609_packet({
+            stanag::TagValue(misb::st0601::UNIX_TIMESTAMP, 1000000.0 + 30 * 100000.0),
+            stanag::TagValue(misb::st0601::FRAME_CENTER_LATITUDE, 45.40),
+            stanag::TagValue(misb::st0601::FRAME_CENTER_LATITUDE, 45.50)
+        });
+        assert(misb::st0601::scan(doubled.data(), doubled.size(), query).empty());
+        const auto complete = stanag::create_stanag4609_packet({
+            stanag::TagValue(misb::st0601::UNIX_TIMESTAMP, 1000000.0 + 30 * 100000.0),
+            stanag::TagValue(misb::st0601::FRAME_CENTER_LATITUDE, 45.40),
+            stanag::TagValue(misb::st0601::FRAME_CENTER_LATITUDE, 45.50),
+            stanag::TagValue(misb::st0601::FRAME_CENTER_LONGITUDE, 2.20)
+        });
+        assert(misb::st0601::scan(complete.data(), complete.size(), query).size() == 1);
+    }
+
+    std::remove(archive_path.c_str());
+    std::remove(index_path.c_str());
+    std::remove(columnar_path.c_str());
+    return 0;
+}
@@ -0,0 +1,210 @@
+#include "klv.h"
+#include "st0601.h"
+#include "st0601_codec.h"
+#include "stanag.h"
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+using namespace misb::st0601;
+
+static_assert(find_codec(2)->width == 8, "UNIX_TIMESTAMP is 8 bytes");
+static_assert(find_codec(13)->kind == CodecKind::Symmetric, "latitude is symmetric");
+static_assert(find_codec(10) == nullptr, "PLATFORM_DESIGNATION is not numeric");
+static_assert(raw_max(*find_codec(6)) == 32767, "s16 range");
+
+namespace {
+
+std::vector<uint8_t> pack(const CodecDescriptor& c, uint64_t raw) {
+    std::vector<uint8_t> bytes(c.width);
+    misb::write_uint_be(bytes.data(), bytes.size(), raw, c.width);
+    return bytes;
+}
+
+bool same(double a, double b) {
+    return (std::isnan(a) && std::isnan(b)) || a == b;
+}
+
+// Output of the per-tag lambdas registered before the descriptor table
+struct Golden {
+    uint8_t tag;
+    double value;
+    std::vector<uint8_t> bytes;
+    double decoded;
+};
+
+const double NAN_VALUE = std::numeric_limits<double>::quiet_NaN();
+
+const std::vector<Golden>& golden() {
+    static const std::vector<Golden> table = {
+        {2, 0, {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, 0},
+        {2, 1700000000123456, {0x00, 0x06, 0x0A, 0x24, 0x18, 0x20, 0x22, 0x40}, 1700000000123456},
+        {5, 0, {0x00, 0x00}, 0},
+        {5, 90, {0x40, 0x00}, 90.00137331197071},
+        {5, 359.99, {0xFF, 0xFD}, 359.9890135042344},
+        {5, 360, {0xFF, 0xFF}, 360},
+        {5, 400, {0xFF, 0xFF}, 360},
+        {5, -5, {0x00, 0x00}, 0},
+        {6, -20, {0x80, 0x01}, -20},
+        {6, -3.25, {0xEB, 0x33}, -3.250221259193701},
+        {6, 0, {0x00, 0x00}, 0},
+        {6, 12.5, {0x4F, 0xFF}, 12.49977111117893},
+        {6, 20, {0x7F, 0xFF}, 20},
+        {6, 25, {0x7F, 0xFF}, 20},
+        {6, NAN_VALUE, {0x80, 0x00}, NAN_VALUE},
+        {8, 0, {0x00}, 0},
+        {8, 37, {0x25}, 37},
+        {8, 255, {0xFF}, 255},
+        {8, 300, {0xFF}, 255},
+        {13, -90, {0x80, 0x00, 0x00, 0x01}, -90},
+        {13, -33.5, {0xD0, 0x5B, 0x05, 0xB1}, -33.4999999885913},
+        {13, 0, {0x00, 0x00, 0x00, 0x00}, 0},
+        {13, 48.8566, {0x45, 0x7C, 0x25, 0x2C}, 48.85660000557853},
+        {13, 90, {0x7F, 0xFF, 0xFF, 0xFF}, 90},
+        {13, 95, {0x7F, 0xFF, 0xFF, 0xFF}, 90},
+        {13, NAN_VALUE, {0x80, 0x00, 0x00, 0x00}, NAN_VALUE},
+        {14, -180, {0x80, 0x00, 0x00, 0x01}, -180},
+        {14, 2.3522, {0x01, 0xAC, 0x34, 0x77}, 2.3521999932602977},
+        {14, 179.999, {0x7F, 0xFF, 0xD1, 0x65}, 179.99900003895118},
+        {14, 180, {0x7F, 0xFF, 0xFF, 0xFF}, 180},
+        {14, NAN_VALUE, {0x80, 0x00, 0x00, 0x00}, NAN_VALUE},
+        {15, -900, {0x00, 0x00}, -900},
+        {15, 0, {0x0B, 0x94}, 0.03204394598299132},
+        {15, 1234.5, {0x1B, 0x75}, 1234.3877317463948},
+        {15, 19000, {0xFF, 0xFF}, 19000},
+        {15, 20000, {0xFF, 0xFF}, 19000},
+        {18, 0, {0x00, 0x00, 0x00, 0x00}, 0},
+        {18, 45.125, {0x20, 0x16, 0xC1, 0x6C}, 45.1250000030559},
+        {18, 359.999, {0xFF, 0xFF, 0xD1, 0x65}, 359.9990000389514},
+        {21, 0, {0x00, 0x00, 0x00, 0x00}, 0},
+        {21, 12345.6, {0x00, 0xA1, 0xD0, 0xF6}, 12345.600410445035},
+        {21, 5000000, {0xFF, 0xFF, 0xFF, 0xFF}, 5000000},
+        {36, 0, {0x00}, 0},
+        {36, 33.3, {0x55}, 33.333333333333336},
+        {36, 100, {0xFF}, 100},
+        {39, -128, {0x80}, -128},
+        {39, -12, {0xF4}, -12},
+        {39, 0, {0x00}, 0},
+        {39, 127, {0x7F}, 127},
+        {39, 200, {0x7F}, 127},
+        {47, 0, {0x00, 0x00}, 0},
+        {47, 513, {0x02, 0x01}, 513},
+        {47, 65535, {0xFF, 0xFF}, 65535},
+        {90, -90, {0x80, 0x00, 0x00, 0x01}, -90},
+        {90, -1.5, {0xFD, 0xDD, 0xDD, 0xDE}, -1.4999999951105565},
+        {90, 0, {0x00, 0x00, 0x00, 0x00}, 0},
+        {90, 89.9, {0x7F, 0xDB, 0x97, 0x52}, 89.89999999753199},
+    };
+    return table;
+}
+
+} // namespace
+
+int main() {
+    auto& reg = KLVRegistry::instance();
+    register_st0601(reg);
+
+    // Registered entries and raw reads agree with the descriptor table
+    for (size_t i = 0; i < CODEC_COUNT; ++i) {
+        const CodecDescriptor& c = CODECS[i];
+        assert(codec_descriptor(c.tag) && codec_descriptor(c.tag)->tag == c.tag);
+        const KLVEntry* entry = reg.find(misb::make_st_ul(ST_ID, c.tag));
+        assert(entry);
+        RawFormat f;
+        assert(raw_format(c.tag, f) == c.fixed_width());
+        if (!c.fixed_width()) continue;
+        assert(f.width == c.width && f.is_signed == c.is_signed());
+
+        const uint64_t top = raw_max(c);
+        const uint64_t raws[] = {0, 1, 2, top / 3, top / 2, top - 1, top,
+                                 static_cast<uint64_t>(-1), static_cast<uint64_t>(-static_cast<int64_t>(top)),
+                                 static_cast<uint64_t>(-static_cast<int64_t>(top) - 1)};
+        for (uint64_t raw : raws) {
+            uint64_t read = 0;
+            const auto bytes = pack(c, raw);
+            assert(read_raw(c, bytes.data(), bytes.size(), read));
+            const uint64_t low = c.width < 8 ? raw & ((uint64_t{1} << (8 * c.width)) - 1) : raw;
+            const uint64_t expected = c.is_signed() ? static_cast<uint64_t>(misb::sign_extend(low, c.width)) : low;
+            assert(read == expected);
+            if (c.width < 8) assert(same(to_engineering(c, read), entry->decoder(bytes)));
+        }
+
+        const double span = c.kind == CodecKind::Linear || c.kind == CodecKind::Symmetric
+                                ? c.hi - c.lo : 300.0;
+        const double base = c.kind == CodecKind::Linear || c.kind == CodecKind::Symmetric ? c.lo : -10.0;
+        for (int k = -2; k <= 22; ++k) {
+            const double v = base + span * k / 20.0 + 0.37;
+            const auto encoded = entry->encoder(v);
+            assert(encoded == pack(c, to_raw(c, v)));
+        }
+        if (c.kind == CodecKind::Symmetric) {
+            assert(entry->encoder(std::nan("")) == pack(c, to_raw(c, std::nan(""))));
+        }
+    }
+    assert(codec_descriptor(10) == nullptr && codec_descriptor(1) == nullptr);
+
+    // Both registry paths give the bytes and values of the original codecs
+    for (const Golden& g : golden()) {
+        const UL ul = misb::make_st_ul(ST_ID, g.tag);
+        const KLVEntry* entry = reg.find(ul);
+        const KLVCodecRef codec = reg.lookup(ul);
+        assert(entry && codec);
+        assert(entry->encoder(g.value) == g.bytes && codec.encode(g.value) == g.bytes);
+        assert(same(entry->decoder(g.bytes), g.decoded));
+        assert(same(codec.decode(g.bytes.data(), g.bytes.size()), g.decoded));
+    }
+
+    // Raw decoding keeps every bit of 64-bit timestamps
+    const uint64_t ts = (uint64_t{1} << 53) + 1;
+    std::vector<uint8_t> payload = {0x02, 0x08};
+    for (int i = 7; i >= 0; --i) payload.push_back(static_cast<uint8_t>(ts >> (8 * i)));
+    const uint8_t lat[] = {0x0D, 0x04, 0x80, 0x00, 0x00, 0x00};
+    payload.insert(payload.end(), lat, lat + sizeof(lat));
+    const uint8_t heading[] = {0x05, 0x02, 0x80, 0x00, 0x0A, 0x03, 'U', 'A', 'V'};
+    payload.insert(payload.end(), heading, heading + sizeof(heading));
+    const auto height = misb::st1201::encode(imap_extended_height(), 1234.5);
+    payload.push_back(0x68);
+    payload.push_back(static_cast<uint8_t>(height.size()));
+    payload.insert(payload.end(), height.begin(), height.end());
+    const uint8_t short_pitch[] = {0x06, 0x01, 0x7F};
+    payload.insert(payload.end(), short_pitch, short_pitch + sizeof(short_pitch));
+
+    std::vector<RawItem> items;
+    assert(decode_raw(payload.data(), payload.size(), items));
+    assert(items.size() == 6);
+    assert(items[0].tag == 2 && items[0].numeric() && items[0].as_unsigned() == ts);
+    assert(static_cast<uint64_t>(items[0].value()) != ts); // not representable as double
+    assert(items[1].tag == 13 && items[1].is_sentinel() && std::isnan(items[1].value()));
+    assert(items[2].tag == 5 && items[2].as_unsigned() == 0x8000);
+    assert(std::fabs(items[2].value() - 180.0) < 0.01);
+    assert(items[3].tag == 10 && !items[3].numeric() && items[3].length == 3);
+    assert(std::memcmp(items[3].data, "UAV", 3) == 0);
+    assert(items[4].tag == 104 && !items[4].numeric());
+    assert(std::fabs(items[4].value() - 1234.5) < 0.01);
+    assert(items[5].tag == 6 && items[5].codec == nullptr);
+
+    // Malformed lengths stop the walk
+    payload.push_back(0x07);
+    payload.push_back(0x05);
+    assert(!decode_raw(payload.data(), payload.size(), items));
+    assert(items.size() == 6);
+
+    // A packet built by the registry encoders reads back through the raw path
+    const auto packet = stanag::create_stanag4609_packet({
+        stanag::TagValue(UNIX_TIMESTAMP, 1700000000000000.0),
+        stanag::TagValue(SENSOR_LATITUDE, -33.5),
+        stanag::TagValue(OUTSIDE_AIR_TEMPERATURE, -12.0)
+    });
+    stanag::PacketView view;
+    assert(stanag::find_next_packet(packet.data(), packet.size(), 0, view));
+    assert(decode_raw(packet.data() + view.payload_offset, view.payload_length, items));
+    for (const auto& item : items) {
+        if (item.tag == UNIX_TIMESTAMP[15]) assert(item.as_unsigned() == 1700000000000000ull);
+        if (item.tag == SENSOR_LATITUDE[15]) assert(std::fabs(item.value() + 33.5) < 1e-6);
+        if (item.tag == OUTSIDE_AIR_TEMPERATURE[15]) assert(item.as_signed() == -12);
+    }
+
+    return 0;
+}
@@ -12,6 +12,29 @@
 #include <string>
 #include <stdexcept>
 #include <limits>
+#include <cstdio>
+#include <thread>
+
+// Tracked node counting its encodes
+class CountingNode : public KLVNode {
+public:
+    explicit CountingNode(uint8_t tag) : tag_(tag), value_(0), revision_(next_revision()) {}
+    std::vector<uint8_t> encode() const override {
+        ++encodes;
+        return {tag_, 0x01, value_};
+    }
+    void decode(const std::vector<uint8_t>&) override {}
+    uint64_t revision() const override { return revision_; }
+    void set(uint8_t v) {
+        value_ = v;
+        revision_ = touch();
+    }
+    mutable int encodes = 0;
+private:
+    uint8_t tag_;
+    uint8_t value_;
+    uint64_t revision_;
+};
 
 int main() {
     auto& reg = KLVRegistry::instance();
@@ -227,11 +250,14 @@ int main() {
     for (const auto& node : decoded.children()) {
         if (auto bytes = std::dynamic_pointer_cast<KLVBytes>(node)) {
             if (bytes->ul() == misb::st0601::PLATFORM_DESIGNATION) {
-                platform.assign(bytes->value().begin(), bytes->value().end());
+                const std::vector<uint8_t> v = bytes->value();
+                platform.assign(v.begin(), v.end());
             } else if (bytes->ul() == misb::st0601::IMAGE_SOURCE_SENSOR) {
-                sensor.assign(bytes->value().begin(), bytes->value().end());
+                const std::vector<uint8_t> v = bytes->value();
+                sensor.assign(v.begin(), v.end());
             } else if (bytes->ul() == misb::st0601::IMAGE_COORDINATE_SYSTEM) {
-                coord.assign(bytes->value().begin(), bytes->value().end());
+                const std::vector<uint8_t> v = bytes->value();
+                coord.assign(v.begin(), v.end());
             }
         }
     }
@@ -299,5 +325,231 @@ int main() {
     big_bytes_dec.decode(encoded_big);
     assert(big_bytes_dec.value() == big_vec);
 
+    // Memoized encoding only re-encodes changed children
+    auto security = std::make_shared<KLVSet>(false, misb::st0102::ST_ID);
+    auto classification = std::make_shared<CountingNode>(0x01);
+    auto marking = std::make_shared<CountingNode>(0x02);
+    security->add(classification);
+    security->add(marking);
+    security->set_encode_cache(true);
+
+    KLVSet memo_root(false, misb::st0601::ST_ID);
+    auto memo_heading = std::make_shared<KLVLeaf>(misb::st0601::PLATFORM_HEADING_ANGLE, 10.0, true);
+    memo_root.add(memo_heading);
+    memo_root.add(security);
+    memo_root.set_encode_cache(true);
+
+    KLVSet plain_root(false, misb::st0601::ST_ID);
+    plain_root.add(memo_heading);
+    plain_root.add(security);
+
+    auto memo_first = memo_root.encode();
+    assert(memo_first == plain_root.encode());
+    assert(classification->encodes == 1 && marking->encodes == 1);
+    const uint64_t clean_revision = memo_root.revision();
+
+    assert(memo_root.encode() == memo_first);
+    assert(classification->encodes == 1 && marking->encodes == 1);
+    assert(memo_root.revision() == clean_revision);
+
+    marking->set(7);
+    assert(memo_root.revision() > clean_revision);
+    auto memo_second = memo_root.encode();
+    assert(memo_second != memo_first);
+    assert(classification->encodes == 1 && marking->encodes == 2);
+    assert(memo_second.back() == 7);
+
+    memo_heading->set_value(20.0);
+    const int marking_encodes = marking->encodes;
+    std::vector<uint8_t> appended = {0xAA};
+    memo_root.encode_into(appended);
+    assert(std::vector<uint8_t>(appended.begin() + 1, appended.end()) == plain_root.encode());
+    assert(classification->encodes == 1);
+    assert(marking->encodes == marking_encodes); // security set is memoized too
+
+    // Untracked children are always re-encoded
+    struct Untracked : KLVNode {
+        std::vector<uint8_t> encode() const override { return {0x05, 0x00}; }
+        void decode(const std::vector<uint8_t>&) override {}
+    };
+    memo_root.add(std::make_shared<Untracked>());
+    assert(memo_root.revision() == 0);
+    auto memo_third = memo_root.encode();
+    assert(memo_third.size() == memo_second.size() + 2);
+    assert(classification->encodes == 1);
+
+    // Changes reach every set holding a node, copies included. Sets under a
+    // memoizing set are notified; the others walk their subtree.
+    {
+        const uint64_t plain_before = plain_root.revision();
+        auto copy = std::make_shared<KLVSet>(plain_root);
+        KLVSet outer(false, misb::st0601::ST_ID);
+        outer.set_encode_cache(true);
+        outer.add(copy);
+        const uint64_t outer_before = outer.revision();
+        marking->set(9);
+        assert(plain_root.revision() != plain_before);
+        assert(outer.revision() > outer_before && copy->revision() > outer_before);
+
+        std::vector<KLVSet> moved;
+        moved.push_back(*copy);
+        moved.push_back(std::move(*copy));
+        moved.resize(8);
+        const uint64_t moved_before = moved[1].revision();
+        memo_heading->set_value(30.0);
+        assert(moved[1].revision() != moved_before);
+        assert(moved[0].encode() == plain_root.encode());
+        moved.clear();
+        copy.reset();
+        memo_heading->set_value(40.0);  // the destroyed sets are no longer notified
+
+        // An untracked grandchild makes every set above it untracked
+        auto inner = std::make_shared<KLVSet>(false, misb::st0601::ST_ID);
+        outer.add(inner);
+        assert(outer.revision() != 0);
+        inner->add(std::make_shared<Untracked>());
+        assert(inner->revision() == 0 && outer.revision() == 0);
+        inner->decode(std::vector<uint8_t>{0x05, 0x02, 0x40, 0x00});
+        assert(inner->revision() != 0 && outer.revision() != 0);
+    }
+
+    // A plain set starts recording its parents when a memoizing set takes
+    // it, and stops when it is released
+    {
+        auto leaf = std::make_shared<KLVLeaf>(misb::st0601::PLATFORM_HEADING_ANGLE, 10.0, true);
+        auto plain = std::make_shared<KLVSet>(false, misb::st0601::ST_ID);
+        plain->add(leaf);
+        KLVSet memo(false, misb::st0601::ST_ID);
+        memo.set_encode_cache(true);
+        memo.add(plain);
+        const auto first = memo.encode();
+        const uint64_t before = memo.revision();
+        leaf->set_value(20.0);
+        assert(memo.revision() > before);
+        assert(memo.encode() != first && memo.encode() == plain->encode());
+
+        KLVSet holder(false, misb::st0601::ST_ID);
+        holder.add(plain);
+        memo.set_encode_cache(false);
+        const uint64_t held = holder.revision();
+        leaf->set_value(30.0);
+        assert(holder.revision() != held);
+
+        *plain = KLVSet(false, misb::st0601::ST_ID);
+        memo.set_encode_cache(true);
+        const auto emptied = memo.encode();
+        plain->add(leaf);
+        assert(memo.encode() != emptied && memo.encode() == plain->encode());
+    }
+
+    // Revisions stay unique when nodes are built on several threads
+    {
+        std::vector<std::vector<uint64_t>> revs(4);
+        std::vector<std::thread> builders;
+        for (size_t t = 0; t < revs.size(); ++t) {
+            builders.emplace_back([&revs, t]() {
+                for (int i = 0; i < 3000; ++i) {
+                    revs[t].push_back(KLVLeaf(misb::st0601::SENSOR_LATITUDE, i).revision());
+                }
+            });
+        }
+        for (auto& b : builders) b.join();
+        std::vector<uint64_t> all;
+        for (const auto& r : revs) all.insert(all.end(), r.begin(), r.end());
+        std::sort(all.begin(), all.end());
+        assert(std::adjacent_find(all.begin(), all.end()) == all.end());
+    }
+
+    // Large values are referenced into the received buffer and spliced on encode
+    std::vector<uint8_t> chip(20000);
+    for (size_t i = 0; i < chip.size(); ++i) chip[i] = static_cast<uint8_t>(i * 31);
+    auto chip_series = misb::st0903::encode_vtarget_series({
+        {5, misb::st0903::make_local_set(misb::st0903::VTARGET_ST_ID, {
+            KLV_LOCAL_LEAF(misb::st0903::VTARGET_CENTROID, 1234.0),
+            KLV_LOCAL_BYTES(misb::st0903::VTARGET_VCHIP, chip)
+        })}
+    });
+    const ByteSlice received = ByteSlice::copy(chip_series);
+    auto chip_packs = misb::st0903::decode_vtarget_series(received);
+    assert(chip_packs.size() == 1 && chip_packs[0].target_id == 5);
+    std::shared_ptr<KLVBytes> chip_node;
+    for (const auto& node : chip_packs[0].set.children()) {
+        if (auto b = std::dynamic_pointer_cast<KLVBytes>(node)) chip_node = b;
+    }
+    assert(chip_node);
+    assert(chip_node->slice().buffer() == received.buffer());
+    assert(chip_node->slice().data() >= received.data() &&
+           chip_node->slice().end() <= received.end());
+    assert(chip_node->value() == chip);
+    assert(chip_packs[0].set.encode() ==
+           misb::st0903::decode_vtarget_series(chip_series)[0].set.encode());
+
+    SegmentList segments;
+    chip_packs[0].set.encode_segments(segments);
+    assert(segments.size() == chip_packs[0].set.encode().size());
+    assert(segments.flatten() == chip_packs[0].set.encode());
+    bool chip_referenced = false;
+    for (size_t i = 0; i < segments.segment_count(); ++i) {
+        if (segments.segment(i).data == chip_node->slice().data()) chip_referenced = true;
+    }
+    assert(chip_referenced);
+
+    // Slices are bounds checked and compare by content
+    assert(received.slice(2, 3) == ByteSlice::copy(&chip_series[2], 3));
+    bool slice_error = false;
+    try {
+        received.slice(received.size(), 1);
+    } catch (const std::out_of_range&) {
+        slice_error = true;
+    }
+    assert(slice_error);
+    KLVBytes replaced(misb::st0903::VTARGET_VCHIP, {}, true);
+    const uint64_t before = replaced.revision();
+    replaced.set_value(received.slice(0, 4));
+    assert(replaced.revision() > before);
+    assert(replaced.value() == std::vector<uint8_t>(chip_series.begin(), chip_series.begin() + 4));
+
+    // Scatter-gather packet output matches the contiguous packet
+    KLVSet vmti_with_chip(false, misb::st0903::ST_ID);
+    vmti_with_chip.add(KLV_LOCAL_LEAF(misb::st0903::VMTI_FRAME_WIDTH, 1280.0));
+    vmti_with_chip.add(KLV_LOCAL_BYTES(misb::st0903::VMTI_VTARGET_SERIES, chip_series));
+    std::vector<uint8_t> designation(300, 'D');
+    std::vector<stanag::TagValue> gather_tags = {
+        stanag::TagValue(misb::st0601::UNIX_TIMESTAMP, 1700000000.0),
+        stanag::TagValue(misb::st0601::PLATFORM_DESIGNATION, designation),
+        stanag::TagValue(misb::st0601::VMTI_LOCAL_SET, vmti_with_chip),
+        stanag::TagValue(misb::st0601::UAS_LS_VERSION_NUMBER, 12.0)
+    };
+    SegmentList gathered = stanag::create_stanag4609_segments(gather_tags);
+    const auto contiguous = stanag::create_stanag4609_packet(gather_tags);
+    assert(gathered.size() == contiguous.size());
+    assert(gathered.flatten() == contiguous);
+    bool designation_referenced = false;
+    for (size_t i = 0; i < gathered.segment_count(); ++i) {
+        if (gathered.segment(i).data == gather_tags[1].bytes.data()) designation_referenced = true;
+    }
+    assert(designation_referenced);
+    assert(gathered.segment_count() >= 5);
+
+    // Incremental checksum agrees with the one-shot form at any split
+    for (size_t split = 0; split <= 7; ++split) {
+        const std::vector<uint8_t> sample = {1, 2, 3, 4, 5, 6, 7};
+        uint16_t crc = misb::klv_checksum_16(0, sample.data(), split, 0);
+        crc = misb::klv_checksum_16(crc, sample.data() + split, sample.size() - split, split);
+        assert(crc == misb::klv_checksum_16(sample));
+    }
+
+#ifdef KLV_HAVE_IOVEC
+    FILE* sink = std::tmpfile();
+    assert(sink);
+    assert(write_segments(fileno(sink), gathered));
+    std::rewind(sink);
+    std::vector<uint8_t> written(contiguous.size() + 1);
+    assert(std::fread(written.data(), 1, written.size(), sink) == contiguous.size());
+    written.pop_back();
+    assert(written == contiguous);
+    std::fclose(sink);
+#endif
+
     return 0;
 }
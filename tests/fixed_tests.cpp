@@ -0,0 +1,99 @@
+#include "klv.h"
+#include "st0601.h"
+#include "st0601_codec.h"
+#include "st0601_fixed.h"
+#include "stanag.h"
+#include <cassert>
+#include <cmath>
+#include <vector>
+
+using namespace misb::st0601;
+
+typedef FixedPacket<tags::UNIX_TIMESTAMP,
+                    tags::PLATFORM_HEADING_ANGLE,
+                    tags::PLATFORM_PITCH_ANGLE,
+                    tags::SENSOR_LATITUDE,
+                    tags::SENSOR_LONGITUDE,
+                    tags::SENSOR_TRUE_ALTITUDE,
+                    tags::OUTSIDE_AIR_TEMPERATURE,
+                    tags::UAS_LS_VERSION_NUMBER> Telemetry;
+
+// 8 + 2 + 2 + 4 + 4 + 2 + 1 + 1 value bytes, two header bytes per item and
+// the checksum item
+static_assert(Telemetry::PAYLOAD_SIZE == 24 + 16 + 4, "payload size");
+static_assert(Telemetry::HEADER_SIZE == 17, "short BER length");
+static_assert(Telemetry::SIZE == 61, "packet size");
+static_assert(Telemetry::value_offset(0) == 19, "first value");
+static_assert(Telemetry::value_offset(3) == 17 + 10 + 4 + 4 + 2, "latitude value");
+
+// Enough items for a long-form BER length
+typedef FixedPacket<tags::CORNER_LAT_PT1_FULL, tags::CORNER_LON_PT1_FULL,
+                    tags::CORNER_LAT_PT2_FULL, tags::CORNER_LON_PT2_FULL,
+                    tags::CORNER_LAT_PT3_FULL, tags::CORNER_LON_PT3_FULL,
+                    tags::CORNER_LAT_PT4_FULL, tags::CORNER_LON_PT4_FULL,
+                    tags::FRAME_CENTER_LATITUDE, tags::FRAME_CENTER_LONGITUDE,
+                    tags::TARGET_LATITUDE, tags::TARGET_LONGITUDE,
+                    tags::ALTERNATE_PLATFORM_LATITUDE, tags::ALTERNATE_PLATFORM_LONGITUDE,
+                    tags::PLATFORM_PITCH_ANGLE_FULL, tags::PLATFORM_ROLL_ANGLE_FULL,
+                    tags::PLATFORM_AOA_FULL, tags::PLATFORM_SIDESLIP_ANGLE_FULL,
+                    tags::SENSOR_RELATIVE_AZIMUTH_ANGLE, tags::SENSOR_RELATIVE_ROLL_ANGLE,
+                    tags::SLANT_RANGE, tags::GROUND_RANGE> Corners;
+
+static_assert(Corners::PAYLOAD_SIZE == 22 * 6 + 4, "payload size");
+static_assert(Corners::HEADER_SIZE == 18, "long BER length");
+
+int main() {
+    auto& reg = KLVRegistry::instance();
+    register_st0601(reg);
+
+    const uint64_t now = 1700000000123456ull;
+    const Telemetry::Buffer packet = Telemetry::encode(now, 123.4, -5.5, 45.25, -75.5, 1500.0, -12.0, 12.0);
+    const std::vector<uint8_t> expected = stanag::create_stanag4609_packet({
+        stanag::TagValue(UNIX_TIMESTAMP, static_cast<double>(now)),
+        stanag::TagValue(PLATFORM_HEADING_ANGLE, 123.4),
+        stanag::TagValue(PLATFORM_PITCH_ANGLE, -5.5),
+        stanag::TagValue(SENSOR_LATITUDE, 45.25),
+        stanag::TagValue(SENSOR_LONGITUDE, -75.5),
+        stanag::TagValue(SENSOR_TRUE_ALTITUDE, 1500.0),
+        stanag::TagValue(OUTSIDE_AIR_TEMPERATURE, -12.0),
+        stanag::TagValue(UAS_LS_VERSION_NUMBER, 12.0)
+    });
+    assert(std::vector<uint8_t>(packet.begin(), packet.end()) == expected);
+    assert(stanag::verify_packet_checksum(packet.data(), packet.size()));
+
+    // Timestamps beyond 2^53 keep every bit
+    const uint64_t odd = (uint64_t{1} << 53) + 1;
+    Telemetry::Buffer reused;
+    Telemetry::encode_into(reused, odd, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 12.0);
+    uint64_t raw = 0;
+    assert(read_raw(*codec_descriptor(tags::UNIX_TIMESTAMP), reused.data() + Telemetry::value_offset(0), 8, raw));
+    assert(raw == odd);
+
+    // Out-of-range values clamp and NaN maps to the sentinel, as in the
+    // registered codecs
+    const Telemetry::Buffer extreme = Telemetry::encode(now, 400.0, std::nan(""), 95.0, -190.0, -1000.0, 300.0, 12.0);
+    const std::vector<uint8_t> extreme_expected = stanag::create_stanag4609_packet({
+        stanag::TagValue(UNIX_TIMESTAMP, static_cast<double>(now)),
+        stanag::TagValue(PLATFORM_HEADING_ANGLE, 400.0),
+        stanag::TagValue(PLATFORM_PITCH_ANGLE, std::nan("")),
+        stanag::TagValue(SENSOR_LATITUDE, 95.0),
+        stanag::TagValue(SENSOR_LONGITUDE, -190.0),
+        stanag::TagValue(SENSOR_TRUE_ALTITUDE, -1000.0),
+        stanag::TagValue(OUTSIDE_AIR_TEMPERATURE, 300.0),
+        stanag::TagValue(UAS_LS_VERSION_NUMBER, 12.0)
+    });
+    assert(std::vector<uint8_t>(extreme.begin(), extreme.end()) == extreme_expected);
+
+    std::vector<stanag::TagValue> corner_tags;
+    const uint8_t corner_list[] = {82, 83, 84, 85, 86, 87, 88, 89, 23, 24, 40, 41, 67, 68,
+                                   90, 91, 92, 93, 18, 20, 21, 57};
+    for (size_t i = 0; i < sizeof(corner_list); ++i) {
+        corner_tags.push_back(stanag::TagValue(misb::make_st_ul(ST_ID, corner_list[i]), 10.0 + i));
+    }
+    const Corners::Buffer corners = Corners::encode(10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20,
+                                                    21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31);
+    assert(std::vector<uint8_t>(corners.begin(), corners.end()) ==
+           stanag::create_stanag4609_packet(corner_tags));
+
+    return 0;
+}
@@ -0,0 +1,132 @@
+#include "klv.h"
+#include "st0601.h"
+#include "st0903.h"
+#include "st_common.h"
+#include <cassert>
+#include <cmath>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Tree and flat decodes of the same bytes agree item for item
+static void check_same(const KLVFlatSet& flat, const KLVSet& tree) {
+    assert(flat.size() == tree.children().size());
+    for (size_t i = 0; i < flat.size(); ++i) {
+        const KLVFlatEntry& e = flat[i];
+        const auto& child = tree.children()[i];
+        if (auto leaf = std::dynamic_pointer_cast<KLVLeaf>(child)) {
+            assert(e.kind == KLVFlatKind::Numeric);
+            assert(flat.ul(e) == leaf->ul() && e.value == leaf->value());
+        } else {
+            auto bytes = std::dynamic_pointer_cast<KLVBytes>(child);
+            assert(bytes && e.kind == KLVFlatKind::Bytes && std::isnan(e.value));
+            assert(flat.ul(e) == bytes->ul() && flat.slice(e) == bytes->slice());
+        }
+        assert(flat.node(i)->encode() == child->encode());
+    }
+}
+
+int main() {
+    using namespace misb::st0601;
+
+    KLVSet local(false, ST_ID);
+    local.add(std::make_shared<KLVLeaf>(UNIX_TIMESTAMP, 1700000000000000.0, true));
+    local.add(std::make_shared<KLVLeaf>(PLATFORM_HEADING_ANGLE, 90.0, true));
+    local.add(std::make_shared<KLVLeaf>(SENSOR_LATITUDE, 45.25, true));
+    local.add(std::make_shared<KLVBytes>(PLATFORM_DESIGNATION, std::vector<uint8_t>{'U', 'A', 'V'}, true));
+    local.add(std::make_shared<KLVBytes>(IMAGE_SOURCE_SENSOR, std::vector<uint8_t>(300, 'S'), true));
+    local.add(std::make_shared<KLVLeaf>(SENSOR_LONGITUDE, -75.0, true));
+    const std::vector<uint8_t> local_bytes = local.encode();
+
+    // Local set: same items as KLVSet, bytes shared with the source
+    {
+        const ByteSlice source = ByteSlice::copy(local_bytes);
+        KLVFlatSet flat(false, ST_ID);
+        flat.decode(source);
+        KLVSet tree(false, ST_ID);
+        tree.decode(source);
+        check_same(flat, tree);
+        assert(flat.size() == 6 && flat.source().buffer() == source.buffer());
+
+        double lat = 0.0;
+        assert(flat.get(SENSOR_LATITUDE, lat) && std::fabs(lat - 45.25) < 1e-6);
+        assert(std::fabs(flat.value(PLATFORM_HEADING_ANGLE) - 90.0) < 0.01);
+        assert(std::isnan(flat.value(PLATFORM_TRUE_AIRSPEED)));
+        assert(flat.value(PLATFORM_TRUE_AIRSPEED, -1.0) == -1.0);
+
+        std::string platform;
+        assert(flat.get(PLATFORM_DESIGNATION, platform) && platform == "UAV");
+        double none = 7.0;
+        assert(!flat.get(PLATFORM_DESIGNATION, none) && none == 7.0);
+        ByteSlice sensor;
+        assert(flat.get(IMAGE_SOURCE_SENSOR, sensor) && sensor.size() == 300);
+        assert(sensor.buffer() == source.buffer());
+        assert(!flat.find(misb::make_st_ul(misb::st0903::ST_ID, 13)));
+
+        // Re-encoding and the tree adapter give the source bytes back
+        assert(flat.encode() == local_bytes);
+        assert(flat.to_set().encode() == local_bytes);
+        SegmentList segments;
+        flat.encode_segments(segments);
+        assert(segments.flatten() == local_bytes);
+
+        const KLVSet rebuilt = flat.to_set();
+        auto view = std::dynamic_pointer_cast<KLVBytes>(rebuilt.children()[4]);
+        assert(view && view->slice().buffer() == source.buffer());
+    }
+
+    // Universal set keyed by ULs, one table slot per distinct key
+    {
+        KLVSet universal(true);
+        universal.add(std::make_shared<KLVLeaf>(SENSOR_LATITUDE, 10.0));
+        universal.add(std::make_shared<KLVBytes>(misb::make_st_ul(0x40, 1), std::vector<uint8_t>{1, 2}));
+        universal.add(std::make_shared<KLVLeaf>(SENSOR_LATITUDE, 20.0));
+        universal.add(std::make_shared<KLVLeaf>(misb::st0903::VTARGET_CENTROID, 5000.0));
+        const std::vector<uint8_t> bytes = universal.encode();
+
+        KLVFlatSet flat;
+        flat.decode(bytes);
+        KLVSet tree;
+        tree.decode(bytes);
+        check_same(flat, tree);
+        assert(flat[0].key == flat[2].key && flat[3].key == 2);
+        assert(flat.value(SENSOR_LATITUDE) == flat[0].value);  // first match
+        assert(flat.value(misb::st0903::VTARGET_CENTROID) == 5000.0);
+        assert(flat.encode() == bytes);
+    }
+
+    // Parsing stops at a truncated item
+    {
+        std::vector<uint8_t> cut(local_bytes.begin(), local_bytes.end() - 2);
+        KLVFlatSet flat(false, ST_ID);
+        flat.decode(cut);
+        KLVSet tree(false, ST_ID);
+        tree.decode(cut);
+        check_same(flat, tree);
+        assert(flat.size() == 5);
+
+        const std::vector<uint8_t> bad_length = {0x02, 0x01, 0x05, 0x05, 0x80};
+        flat.decode(bad_length);
+        assert(flat.size() == 1 && flat[0].length == 1);
+        flat.decode(std::vector<uint8_t>());
+        assert(flat.empty());
+    }
+
+    // Nested in a KLVSet like any other node
+    {
+        auto flat = std::make_shared<KLVFlatSet>(false, ST_ID);
+        flat->decode(local_bytes);
+        const uint64_t rev = flat->revision();
+        KLVSet outer(false, ST_ID);
+        outer.add(std::make_shared<KLVLeaf>(UAS_LS_VERSION_NUMBER, 12.0, true));
+        outer.add(flat);
+        std::vector<uint8_t> expected = {0x41, 0x01, 0x0C};
+        expected.insert(expected.end(), local_bytes.begin(), local_bytes.end());
+        assert(outer.encode() == expected);
+        const uint64_t outer_rev = outer.revision();
+        flat->decode(local_bytes);
+        assert(flat->revision() > rev && outer.revision() != outer_rev);
+    }
+
+    return 0;
+}
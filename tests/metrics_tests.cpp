@@ -0,0 +1,149 @@
+#include "klv.h"
+#include "klv_metrics.h"
+#include "st0601.h"
+#include "st0903.h"
+#include "stanag.h"
+#include <atomic>
+#include <cassert>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+int main() {
+    auto& reg = KLVRegistry::instance();
+    misb::st0601::register_st0601(reg);
+    misb::st0903::register_st0903(reg);
+
+    // Bucket bounds tile the value range without gaps
+    for (size_t b = 1; b < 200; ++b) {
+        assert(LatencyHistogram::bucket_low(b) == LatencyHistogram::bucket_high(b - 1) + 1);
+        assert(LatencyHistogram::bucket_index(LatencyHistogram::bucket_low(b)) == b);
+        assert(LatencyHistogram::bucket_index(LatencyHistogram::bucket_high(b)) == b);
+    }
+    assert(LatencyHistogram::bucket_index(~uint64_t{0}) < LatencyHistogram::BUCKETS);
+
+    // Percentiles stay within the 12.5% bucket resolution
+    {
+        LatencyHistogram h;
+        for (uint64_t v = 1; v <= 10000; ++v) h.record(v);
+        assert(h.count() == 10000);
+        assert(h.min() == 1 && h.max() == 10000);
+        assert(h.sum() == 10000ull * 10001 / 2);
+        const double expected[] = {0.5, 0.9, 0.99};
+        for (double q : expected) {
+            const double p = static_cast<double>(h.percentile(q));
+            assert(p >= q * 10000 && p <= q * 10000 * 1.125);
+        }
+        assert(h.percentile(1.0) == 10000);
+
+        LatencyHistogram other;
+        other.record(50000, 10);
+        h.merge(other);
+        assert(h.count() == 10010 && h.max() == 50000);
+        h.reset();
+        assert(h.count() == 0 && h.percentile(0.5) == 0 && h.min() == 0);
+    }
+
+#if KLV_METRICS
+    KLVMetrics::reset();
+    std::vector<uint8_t> stream;
+    for (int i = 0; i < 10; ++i) {
+        const auto packet = stanag::create_stanag4609_packet({
+            stanag::TagValue(misb::st0601::UNIX_TIMESTAMP, 1700000000.0 + i),
+            stanag::TagValue(misb::st0601::PLATFORM_HEADING_ANGLE, 90.0),
+            stanag::TagValue(misb::st0601::UAS_LS_VERSION_NUMBER, 12.0)
+        });
+        stream.insert(stream.end(), packet.begin(), packet.end());
+    }
+    {
+        KLVMetricsSnapshot s = KLVMetrics::snapshot();
+        assert(s.counter(KLVCounter::PacketsEncoded) == 10);
+        assert(s.counter(KLVCounter::BytesEncoded) == stream.size());
+        assert(s.stage(KLVStage::PacketEncode).count() == 10);
+    }
+
+    // Framing, decoding and a corrupted checksum, recorded on a worker thread
+    // whose counts must survive its exit
+    stream[stream.size() - 1] ^= 0xFF;
+    std::thread worker([&stream]() {
+        const ByteSlice all = ByteSlice::copy(stream);
+        stanag::PacketView view;
+        size_t from = 0, good = 0;
+        while (stanag::find_next_packet(all.data(), all.size(), from, view)) {
+            KLVSet set;
+            if (stanag::decode_stanag4609_packet(all.slice(view.offset, view.length), set)) ++good;
+            from = view.offset + view.length;
+        }
+        assert(good == 9);
+    });
+    worker.join();
+    {
+        KLVMetricsSnapshot s = KLVMetrics::snapshot();
+        assert(s.counter(KLVCounter::PacketsFramed) == 10);
+        assert(s.counter(KLVCounter::BytesFramed) == stream.size());
+        assert(s.counter(KLVCounter::ErrorChecksum) == 1);
+        assert(s.stage(KLVStage::Framing).count() >= 10);
+        assert(s.stage(KLVStage::SetDecode).count() >= 9);
+        assert(s.stage(KLVStage::SetDecode).max() >= s.stage(KLVStage::SetDecode).min());
+    }
+
+    // Truncated items and rejected series
+    {
+        KLVSet set(false, misb::st0601::ST_ID);
+        const uint8_t truncated[] = {0x05, 0x04, 0x12, 0x34};
+        set.decode(ByteSlice::copy(std::vector<uint8_t>(truncated, truncated + sizeof(truncated))));
+        bool threw = false;
+        try {
+            misb::st0903::decode_vtarget_series(std::vector<uint8_t>{0x05, 0x01});
+        } catch (const std::runtime_error&) {
+            threw = true;
+        }
+        assert(threw);
+        KLVMetricsSnapshot s = KLVMetrics::snapshot();
+        assert(s.counter(KLVCounter::ErrorTruncated) == 1);
+        assert(s.counter(KLVCounter::ErrorSeries) == 1);
+        assert(s.stage(KLVStage::SeriesDecode).count() == 1);
+
+        const std::string text = s.to_text();
+        assert(text.find("klv_packets_framed_total 10\n") != std::string::npos);
+        assert(text.find("klv_stage_latency_ns_count{stage=\"set_decode\"}") != std::string::npos);
+        assert(text.find("quantile=\"0.99\"") != std::string::npos);
+    }
+
+    KLVMetrics::reset();
+    {
+        KLVMetricsSnapshot s = KLVMetrics::snapshot();
+        for (size_t i = 0; i < KLV_COUNTER_COUNT; ++i) assert(s.counters[i] == 0);
+        for (size_t i = 0; i < KLV_STAGE_COUNT; ++i) assert(s.stages[i].count() == 0);
+    }
+
+    // reset() leaves live blocks to their owners: a thread idle across the
+    // reset reports nothing, then only what it adds afterwards
+    {
+        std::atomic<int> phase(0);
+        std::thread idle([&phase]() {
+            KLVMetrics::add(KLVCounter::UnknownTags, 5);
+            phase.store(1);
+            while (phase.load() != 2) std::this_thread::yield();
+            KLVMetrics::add(KLVCounter::UnknownTags, 1);
+            phase.store(3);
+            while (phase.load() != 4) std::this_thread::yield();
+        });
+        while (phase.load() != 1) std::this_thread::yield();
+        assert(KLVMetrics::snapshot().counter(KLVCounter::UnknownTags) == 5);
+        KLVMetrics::reset();
+        assert(KLVMetrics::snapshot().counter(KLVCounter::UnknownTags) == 0);
+        phase.store(2);
+        while (phase.load() != 3) std::this_thread::yield();
+        assert(KLVMetrics::snapshot().counter(KLVCounter::UnknownTags) == 1);
+        KLVMetrics::reset();
+        phase.store(4);
+        idle.join();
+        // Exited without updating since the reset
+        assert(KLVMetrics::snapshot().counter(KLVCounter::UnknownTags) == 0);
+    }
+#endif
+
+    return 0;
+}
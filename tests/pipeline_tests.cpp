@@ -0,0 +1,188 @@
+#include "klv.h"
+#include "klv_pipeline.h"
+#include "klv_ring.h"
+#include "st0601.h"
+#include "stanag.h"
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <map>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using namespace stanag;
+
+namespace {
+
+std::vector<uint8_t> make_packet(uint32_t feed, int i) {
+    return create_stanag4609_packet({
+        TagValue(misb::st0601::UNIX_TIMESTAMP, 1700000000.0 + i),
+        TagValue(misb::st0601::PLATFORM_DESIGNATION, std::vector<uint8_t>(feed + 1, 'T')),
+        TagValue(misb::st0601::UAS_LS_VERSION_NUMBER, 12.0)
+    });
+}
+
+} // namespace
+
+int main() {
+    auto& reg = KLVRegistry::instance();
+    misb::st0601::register_st0601(reg);
+
+    // Ring basics
+    {
+        BoundedRing<int> ring(5);
+        assert(ring.capacity() == 8 && ring.empty());
+        for (int i = 0; i < 8; ++i) assert(ring.try_push(std::move(i)));
+        int extra = 8;
+        assert(!ring.try_push(std::move(extra)));
+        assert(ring.size() == 8);
+        int v = -1;
+        for (int i = 0; i < 8; ++i) {
+            assert(ring.try_pop(v) && v == i);
+        }
+        assert(!ring.try_pop(v) && ring.empty());
+    }
+
+    // Several producers, one consumer: every producer's items stay in order
+    {
+        BoundedRing<uint64_t> ring(64);
+        const int producers = 4, per_producer = 20000;
+        std::vector<std::thread> threads;
+        for (int p = 0; p < producers; ++p) {
+            threads.emplace_back([&ring, p]() {
+                for (int i = 0; i < per_producer; ++i) {
+                    uint64_t item = (static_cast<uint64_t>(p) << 32) | static_cast<uint32_t>(i);
+                    while (!ring.try_push(std::move(item))) std::this_thread::yield();
+                }
+            });
+        }
+        std::vector<int64_t> last(producers, -1);
+        int received = 0;
+        while (received < producers * per_producer) {
+            uint64_t item;
+            if (!ring.try_pop(item)) {
+                std::this_thread::yield();
+                continue;
+            }
+            const int p = static_cast<int>(item >> 32);
+            const int64_t i = static_cast<int64_t>(item & 0xFFFFFFFFu);
+            assert(i == last[p] + 1);
+            last[p] = i;
+            ++received;
+        }
+        for (auto& t : threads) t.join();
+        assert(ring.empty());
+    }
+
+    // Many feeds pushed in uneven interleaved pieces
+    {
+        const uint32_t feeds = 8;
+        const int per_feed = 50;
+        std::map<uint32_t, std::vector<uint64_t>> sequences;
+        std::map<uint32_t, std::vector<size_t>> designations;
+        PipelineConfig config;
+        config.decode_workers = 3;
+        config.queue_capacity = 16;
+        IngestPipeline pipeline(config, [&](const DecodedPacket& p) {
+            // Single consumer thread: no lock needed
+            sequences[p.feed].push_back(p.sequence);
+            for (const auto& node : p.set.children()) {
+                if (auto bytes = std::dynamic_pointer_cast<KLVBytes>(node)) {
+                    if (bytes->ul() == misb::st0601::PLATFORM_DESIGNATION) {
+                        designations[p.feed].push_back(bytes->value().size());
+                    }
+                }
+            }
+        });
+        pipeline.start();
+
+        std::vector<std::vector<uint8_t>> streams(feeds);
+        for (uint32_t f = 0; f < feeds; ++f) {
+            streams[f].push_back(0x55); // stray byte before the first packet
+            for (int i = 0; i < per_feed; ++i) {
+                const auto p = make_packet(f, i);
+                streams[f].insert(streams[f].end(), p.begin(), p.end());
+            }
+        }
+        std::vector<size_t> pos(feeds, 0);
+        bool more = true;
+        for (size_t round = 0; more; ++round) {
+            more = false;
+            for (uint32_t f = 0; f < feeds; ++f) {
+                const size_t piece = 7 + (round * 13 + f * 5) % 61;
+                const size_t n = std::min(piece, streams[f].size() - pos[f]);
+                if (n == 0) continue;
+                pipeline.push(f, streams[f].data() + pos[f], n);
+                pos[f] += n;
+                more = true;
+            }
+        }
+        auto corrupt = make_packet(0, 99);
+        corrupt[corrupt.size() - 1] ^= 0xFF;
+        pipeline.push_packet(feeds, ByteSlice::copy(corrupt));
+        pipeline.stop();
+
+        const PipelineStats stats = pipeline.stats();
+        assert(stats.framed == feeds * per_feed + 1);
+        assert(stats.decoded == feeds * per_feed);
+        assert(stats.delivered == feeds * per_feed);
+        assert(stats.invalid == 1);
+        assert(stats.discarded_bytes == feeds);
+        assert(stats.feeds == feeds + 1);
+        assert(stats.decode_queues.size() == 3);
+        for (const auto& q : stats.decode_queues) {
+            assert(q.capacity == 16 && q.depth == 0 && q.drops == 0);
+            assert(q.max_depth >= 1 && q.max_depth <= 16);
+        }
+        assert(stats.output_queue.depth == 0 && stats.output_queue.max_depth >= 1);
+        assert(sequences.size() == feeds);
+        for (uint32_t f = 0; f < feeds; ++f) {
+            const auto& seq = sequences[f];
+            assert(seq.size() == static_cast<size_t>(per_feed));
+            for (size_t i = 0; i < seq.size(); ++i) assert(seq[i] == i);
+            assert(designations[f].size() == static_cast<size_t>(per_feed));
+            for (size_t len : designations[f]) assert(len == f + 1);
+        }
+
+        bool threw = false;
+        try {
+            pipeline.push(0, streams[0].data(), 1);
+        } catch (const std::runtime_error&) {
+            threw = true;
+        }
+        assert(threw);
+    }
+
+    // Drop-oldest never blocks the producer and keeps order among survivors
+    {
+        std::atomic<bool> release(false);
+        std::vector<uint64_t> seen;
+        PipelineConfig config;
+        config.decode_workers = 1;
+        config.queue_capacity = 2;
+        config.backpressure = Backpressure::DropOldest;
+        IngestPipeline pipeline(config, [&](const DecodedPacket& p) {
+            while (!release.load()) std::this_thread::yield();
+            seen.push_back(p.sequence);
+        });
+        pipeline.start();
+        const int count = 200;
+        for (int i = 0; i < count; ++i) {
+            pipeline.push_packet(0, ByteSlice::adopt(make_packet(0, i)));
+        }
+        release.store(true);
+        pipeline.stop();
+
+        const PipelineStats stats = pipeline.stats();
+        const uint64_t drops = stats.decode_queues[0].drops + stats.output_queue.drops;
+        assert(drops > 0);
+        assert(stats.delivered + drops == static_cast<uint64_t>(count));
+        assert(seen.size() == stats.delivered);
+        for (size_t i = 1; i < seen.size(); ++i) assert(seen[i] > seen[i - 1]);
+        // The newest packet always survives
+        assert(seen.back() == static_cast<uint64_t>(count - 1));
+    }
+
+    return 0;
+}
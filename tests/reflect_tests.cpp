@@ -0,0 +1,146 @@
+#include "klv.h"
+#include "klv_macros.h"
+#include "st0601.h"
+#include "st0601_reflect.h"
+#include "stanag.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace app {
+
+struct Telemetry {
+    uint64_t time;
+    double heading;
+    double pitch;
+    double lat;
+    double lon;
+    float height;
+    int air_temperature;
+    std::string platform;
+    std::string sensor;
+    std::vector<uint8_t> vmti;
+    uint8_t version;
+};
+
+#define TELEMETRY_FIELDS(X) \
+    X(time, UNIX_TIMESTAMP) \
+    X(heading, PLATFORM_HEADING_ANGLE) \
+    X(pitch, PLATFORM_PITCH_ANGLE) \
+    X(lat, SENSOR_LATITUDE) \
+    X(lon, SENSOR_LONGITUDE) \
+    X(height, SENSOR_ELLIPSOID_HEIGHT_EXTENDED) \
+    X(air_temperature, OUTSIDE_AIR_TEMPERATURE) \
+    X(platform, PLATFORM_DESIGNATION) \
+    X(sensor, IMAGE_SOURCE_SENSOR) \
+    X(vmti, VMTI_LOCAL_SET) \
+    X(version, UAS_LS_VERSION_NUMBER)
+
+KLV_ST0601_STRUCT(Telemetry, TELEMETRY_FIELDS)
+
+} // namespace app
+
+using namespace misb::st0601;
+
+int main() {
+    auto& reg = KLVRegistry::instance();
+    register_st0601(reg);
+
+    app::Telemetry t;
+    t.time = uint64_t{1} << 53;
+    t.heading = 123.4;
+    t.pitch = -5.5;
+    t.lat = 48.8566;
+    t.lon = 2.3522;
+    t.height = 1234.5f;
+    t.air_temperature = -12;
+    t.platform = "FalconEye";
+    t.sensor = std::string(200, 'S');  // long-form BER item length
+    t.vmti = {0x03, 0x01, 0x06};
+    t.version = 12;
+
+    // Same bytes as the TagValue path
+    const std::vector<uint8_t> packet = encode_struct(t);
+    const std::vector<uint8_t> expected = stanag::create_stanag4609_packet({
+        stanag::TagValue(UNIX_TIMESTAMP, static_cast<double>(uint64_t{1} << 53)),
+        stanag::TagValue(PLATFORM_HEADING_ANGLE, 123.4),
+        stanag::TagValue(PLATFORM_PITCH_ANGLE, -5.5),
+        stanag::TagValue(SENSOR_LATITUDE, 48.8566),
+        stanag::TagValue(SENSOR_LONGITUDE, 2.3522),
+        stanag::TagValue(SENSOR_ELLIPSOID_HEIGHT_EXTENDED, 1234.5),
+        stanag::TagValue(OUTSIDE_AIR_TEMPERATURE, -12.0),
+        stanag::TagValue(PLATFORM_DESIGNATION, t.platform),
+        stanag::TagValue(IMAGE_SOURCE_SENSOR, t.sensor),
+        stanag::TagValue(VMTI_LOCAL_SET, t.vmti),
+        stanag::TagValue(UAS_LS_VERSION_NUMBER, 12.0)
+    });
+    assert(packet == expected);
+
+    app::Telemetry back = app::Telemetry();
+    assert(decode_struct_packet(packet.data(), packet.size(), back));
+    assert(back.time == t.time);
+    assert(std::fabs(back.heading - t.heading) < 0.01);
+    assert(std::fabs(back.pitch - t.pitch) < 0.001);
+    assert(std::fabs(back.lat - t.lat) < 1e-6 && std::fabs(back.lon - t.lon) < 1e-6);
+    assert(std::fabs(back.height - t.height) < 0.1);
+    assert(back.air_temperature == -12);
+    assert(back.platform == t.platform && back.sensor == t.sensor);
+    assert(back.vmti == t.vmti && back.version == 12);
+
+    // 64-bit counters keep every bit
+    {
+        app::Telemetry odd = t;
+        odd.time = (uint64_t{1} << 53) + 1;
+        const std::vector<uint8_t> bytes = encode_struct(odd);
+        assert(bytes != packet && bytes.size() == packet.size());
+        app::Telemetry read = app::Telemetry();
+        assert(decode_struct_packet(bytes.data(), bytes.size(), read));
+        assert(read.time == odd.time);
+    }
+
+    // The TagValue path decodes what the struct path wrote
+    stanag::PacketView view;
+    assert(stanag::find_next_packet(packet.data(), packet.size(), 0, view));
+    const std::vector<uint8_t> payload(packet.begin() + view.payload_offset, packet.end() - 4);
+    KLVSet decoded(false, ST_ID);
+    decoded.decode(payload);
+    double lat = 0.0;
+    ST_GET(decoded, 0601, SENSOR_LATITUDE, lat);
+    assert(std::fabs(lat - t.lat) < 1e-6);
+
+    // Absent tags keep the member; unbound tags and mismatched lengths are
+    // skipped; a malformed length stops the walk
+    {
+        app::Telemetry partial = t;
+        const uint8_t items[] = {0x0D, 0x02, 0x00, 0x00,        // latitude, wrong length
+                                 0x27, 0x01, 0x05,              // air temperature
+                                 0x30, 0x01, 0x00,              // unbound tag 48
+                                 0x0A, 0x03, 'U', 'A', 'V'};
+        assert(decode_struct(items, sizeof(items), partial));
+        assert(partial.lat == t.lat && partial.air_temperature == 5);
+        assert(partial.platform == "UAV" && partial.time == t.time);
+
+        const uint8_t truncated[] = {0x27, 0x01, 0x07, 0x0A, 0x09, 'U'};
+        assert(!decode_struct(truncated, sizeof(truncated), partial));
+        assert(partial.air_temperature == 7 && partial.platform == "UAV");
+    }
+
+    // Corrupted checksum and appended output
+    {
+        std::vector<uint8_t> bad = packet;
+        bad[30] ^= 0xFF;
+        app::Telemetry ignored = app::Telemetry();
+        assert(!decode_struct_packet(bad.data(), bad.size(), ignored));
+
+        std::vector<uint8_t> stream;
+        encode_struct_into(t, stream);
+        encode_struct_into(t, stream);
+        assert(stream.size() == 2 * packet.size());
+        assert(std::equal(packet.begin(), packet.end(), stream.begin() + packet.size()));
+    }
+
+    return 0;
+}
@@ -0,0 +1,92 @@
+#include "klv.h"
+#include "klv_macros.h"
+#include "st0102.h"
+#include "st0601.h"
+#include "st0903.h"
+#include "stanag.h"
+#include <cassert>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+static double find_value(const KLVSet& set, const UL& ul) {
+    for (const auto& node : set.children()) {
+        if (auto leaf = std::dynamic_pointer_cast<KLVLeaf>(node)) {
+            if (leaf->ul() == ul) return leaf->value();
+        }
+    }
+    return std::numeric_limits<double>::quiet_NaN();
+}
+
+int main() {
+    // No register_* call: the built-in codecs are static tables
+    auto& reg = KLVRegistry::instance();
+    assert(reg.find(misb::st0601::SENSOR_LATITUDE) == nullptr);
+    assert(reg.lookup(misb::st0601::SENSOR_LATITUDE).codec == misb::st0601::builtin_codec(13));
+    assert(reg.lookup(misb::st0903::VTARGET_CENTROID).codec);
+    assert(reg.lookup(misb::st0102::CLASSIFICATION).codec);
+    assert(!reg.lookup(misb::st0601::PLATFORM_DESIGNATION));
+    assert(!reg.lookup(misb::make_st_ul(0x40, 1)));
+
+    const auto packet = stanag::create_stanag4609_packet({
+        stanag::TagValue(misb::st0601::UNIX_TIMESTAMP, 1700000000000000.0),
+        stanag::TagValue(misb::st0601::SENSOR_LATITUDE, 45.25),
+        stanag::TagValue(misb::st0601::SENSOR_ELLIPSOID_HEIGHT_EXTENDED, 1234.5),
+        stanag::TagValue(misb::st0601::PLATFORM_DESIGNATION, "UAV")
+    });
+    stanag::PacketView view;
+    assert(stanag::find_next_packet(packet.data(), packet.size(), 0, view));
+    KLVSet decoded(false, misb::st0601::ST_ID);
+    decoded.decode(std::vector<uint8_t>(packet.begin() + view.payload_offset, packet.end() - 4));
+    assert(find_value(decoded, misb::st0601::UNIX_TIMESTAMP) == 1700000000000000.0);
+    assert(std::fabs(find_value(decoded, misb::st0601::SENSOR_LATITUDE) - 45.25) < 1e-6);
+    assert(std::fabs(find_value(decoded, misb::st0601::SENSOR_ELLIPSOID_HEIGHT_EXTENDED) - 1234.5) < 0.01);
+
+    const auto series = misb::st0903::encode_vtarget_series({
+        KLV_VTARGET_PACK(7.0,
+                         KLV_TAG(misb::st0903::VTARGET_CENTROID, 5000.0),
+                         KLV_TAG(misb::st0903::VTARGET_CONFIDENCE_LEVEL, 0.5),
+                         KLV_TAG(misb::st0903::VTARGET_LOCATION_HAE, 100.0))
+    });
+    const auto packs = misb::st0903::decode_vtarget_series(series);
+    assert(packs.size() == 1 && packs[0].target_id == 7);
+    assert(find_value(packs[0].set, misb::st0903::VTARGET_CENTROID) == 5000.0);
+    assert(find_value(packs[0].set, misb::st0903::VTARGET_CONFIDENCE_LEVEL) == 0.5);
+    assert(std::fabs(find_value(packs[0].set, misb::st0903::VTARGET_LOCATION_HAE) - 100.0) < 1.0);
+
+    // Registration keeps find() working and still resolves to the tables
+    misb::st0601::register_st0601(reg);
+    misb::st0903::register_st0903(reg);
+    const KLVEntry* lat = reg.find(misb::st0601::SENSOR_LATITUDE);
+    assert(lat && lat->codec == misb::st0601::builtin_codec(13));
+    const auto bytes = lat->encoder(-33.5);
+    assert(lat->decoder(bytes) == reg.lookup(misb::st0601::SENSOR_LATITUDE).decode(bytes.data(), bytes.size()));
+    assert(reg.lookup(misb::st0601::SENSOR_LATITUDE).codec == lat->codec);
+    assert(reg.find(misb::st0903::ALGORITHM_CONFIDENCE)->codec ==
+           misb::st0903::builtin_codec(misb::st0903::ALGORITHM_ST_ID, 5));
+
+    // Run-time codecs extend the registry and override built-in tags until
+    // the standard is registered again
+    const UL custom = misb::make_st_ul(0x40, 1);
+    reg.register_ul(custom, {
+        [](double v) { return std::vector<uint8_t>{static_cast<uint8_t>(v)}; },
+        [](const std::vector<uint8_t>& b) { return b.size() == 1 ? b[0] * 10.0 : 0.0; }
+    });
+    const uint8_t raw = 3;
+    assert(reg.lookup(custom) && !reg.lookup(custom).codec);
+    assert(reg.lookup(custom).decode(&raw, 1) == 30.0);
+
+    reg.register_ul(misb::st0601::PLATFORM_TRUE_AIRSPEED, {
+        [](double) { return std::vector<uint8_t>{0x2A}; },
+        [](const std::vector<uint8_t>&) { return -1.0; },
+        nullptr
+    });
+    const KLVCodecRef airspeed = reg.lookup(misb::st0601::PLATFORM_TRUE_AIRSPEED);
+    assert(!airspeed.codec && airspeed.encode(100.0) == std::vector<uint8_t>{0x2A});
+    assert(airspeed.decode(&raw, 1) == -1.0);
+    misb::st0601::register_st0601(reg);
+    assert(reg.lookup(misb::st0601::PLATFORM_TRUE_AIRSPEED).codec == misb::st0601::builtin_codec(8));
+    assert(reg.lookup(misb::st0601::PLATFORM_TRUE_AIRSPEED).decode(&raw, 1) == 3.0);
+
+    return 0;
+}
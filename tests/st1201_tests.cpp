@@ -0,0 +1,89 @@
+#include "klv.h"
+#include "st0601.h"
+#include "st0903.h"
+#include "st1201.h"
+#include <cassert>
+#include <cmath>
+#include <vector>
+
+using namespace misb;
+
+int main() {
+    auto& reg = KLVRegistry::instance();
+    st0601::register_st0601(reg);
+    st0903::register_st0903(reg);
+
+    // Derived constants and reference values
+    const st1201::Imap hae2 = st1201::imapb(-900.0, 19000.0, 2);
+    assert(hae2.b_pow == 15 && hae2.d_pow == 15);
+    assert(hae2.forward == 1.0 && hae2.z_offset == 0.0);
+    assert((st1201::encode(hae2, 10000.0) == std::vector<uint8_t>{0x2A, 0x94}));
+    const st1201::Imap hae3 = st1201::imapb(-900.0, 19000.0, 3);
+    assert((st1201::encode(hae3, 10000.0) == std::vector<uint8_t>{0x2A, 0x94, 0x00}));
+    assert(st1201::decode(hae3, st1201::encode(hae3, 10000.0)) == 10000.0);
+
+    const st1201::Imap fov = st1201::imapb(0.0, 180.0, 2);
+    assert((st1201::encode(fov, 90.0) == std::vector<uint8_t>{0x2D, 0x00}));
+    assert(st1201::decode(fov, st1201::encode(fov, 180.0)) == 180.0);
+    assert(st1201::decode(fov, st1201::encode(fov, 200.0)) == 180.0);
+    assert(st1201::decode(fov, st1201::encode(fov, -5.0)) == 0.0);
+
+    // Zero stays exact across a signed range
+    const st1201::Imap offset = st1201::imapb(-19.2, 19.2, 3);
+    assert(offset.z_offset > 0.0);
+    assert(std::fabs(st1201::decode(offset, st1201::encode(offset, 0.0))) < 1e-9);
+    for (double v = -19.2; v <= 19.2; v += 0.37) {
+        assert(std::fabs(st1201::decode(offset, st1201::encode(offset, v)) - v) <= offset.reverse);
+    }
+
+    // IMAPA picks the shortest length resolving the precision
+    assert(st1201::imapa(0.0, 180.0, 0.01).length == 2);
+    assert(st1201::imapa(-900.0, 19000.0, 1.0).length == 2);
+    assert(st1201::imapa(-900.0, 19000.0, 0.5).length == 3);
+
+    // Special values
+    auto nan_bytes = st1201::encode(hae2, std::nan(""));
+    assert(nan_bytes[0] == st1201::POSITIVE_QUIET_NAN && nan_bytes[1] == 0);
+    assert(std::isnan(st1201::decode(hae2, nan_bytes)));
+    auto inf_bytes = st1201::encode(hae2, INFINITY);
+    assert(inf_bytes[0] == st1201::POSITIVE_INFINITY);
+    assert(st1201::decode(hae2, inf_bytes) == INFINITY);
+    auto ninf_bytes = st1201::encode(hae2, -INFINITY);
+    assert(ninf_bytes[0] == st1201::NEGATIVE_INFINITY);
+    assert(st1201::decode(hae2, ninf_bytes) == -INFINITY);
+    assert(std::isnan(st1201::decode(hae2, std::vector<uint8_t>{})));
+    assert(std::isnan(st1201::decode(hae2, std::vector<uint8_t>(9, 0))));
+
+    // The decoder follows the received length
+    const auto long_form = st1201::encode(hae3, 1234.5);
+    assert(std::fabs(st1201::decode(hae2, long_form) - 1234.5) <= hae3.reverse);
+
+    // Array forms
+    std::vector<double> values;
+    for (int i = 0; i < 100; ++i) values.push_back(-900.0 + i * 199.0);
+    std::vector<uint8_t> packed(values.size() * hae3.length);
+    assert(st1201::encode_array(hae3, values.data(), values.size(), packed.data(), packed.size() - 1) == 0);
+    assert(st1201::encode_array(hae3, values.data(), values.size(), packed.data(), packed.size()) == packed.size());
+    std::vector<double> decoded(values.size());
+    assert(st1201::decode_array(hae3, packed.data(), packed.size(), decoded.data(), decoded.size()) == packed.size());
+    for (size_t i = 0; i < values.size(); ++i) {
+        assert(std::fabs(decoded[i] - values[i]) <= hae3.reverse);
+        assert(decoded[i] == st1201::decode(hae3, packed.data() + i * 3, 3));
+    }
+
+    // ST 0601 extended heights and ST 0903 items go through the descriptors
+    const KLVEntry* height = reg.find(st0601::SENSOR_ELLIPSOID_HEIGHT_EXTENDED);
+    assert(height);
+    auto ext = height->encoder(12345.6);
+    assert(ext.size() == 3);
+    const double ext_back = height->decoder(ext);
+    assert(std::fabs(ext_back - 12345.6) <= st0601::imap_extended_height().reverse);
+    assert(std::fabs(reg.find(st0601::DENSITY_ALTITUDE_EXTENDED)->decoder({0x2A, 0x94}) - 20900.0) < 1e-9);
+    st0601::RawFormat fmt;
+    assert(!st0601::raw_format(103, fmt));
+    assert(st0601::raw_format(102, fmt) && fmt.width == 2);
+
+    assert((reg.find(st0903::VTARGET_LOCATION_HAE)->encoder(10000.0) == std::vector<uint8_t>{0x2A, 0x94}));
+    assert((reg.find(st0903::VMTI_HORIZONTAL_FOV)->encoder(90.0) == std::vector<uint8_t>{0x2D, 0x00}));
+    return 0;
+}
@@ -0,0 +1,115 @@
+#include "klv.h"
+#include "klv_macros.h"
+#include "st0601.h"
+#include "st0601_state.h"
+#include "st0601_history.h"
+#include "st_common.h"
+#include <cassert>
+#include <cmath>
+#include <memory>
+#include <string>
+#include <vector>
+
+int main() {
+    auto& reg = KLVRegistry::instance();
+    misb::st0601::register_st0601(reg);
+
+    // Carry-forward merge of sparse packets
+    misb::st0601::FeedState state;
+    assert(!state.has(13));
+    assert(std::isnan(state.value(13)));
+
+    KLVSet first = KLV_LOCAL_DATASET(
+        KLV_ST_ITEM(0601, UNIX_TIMESTAMP, 1000.0),
+        KLV_ST_ITEM(0601, SENSOR_LATITUDE, 45.0),
+        KLV_ST_ITEM(0601, SENSOR_LONGITUDE, 2.0),
+        KLV_ST_ITEM(0601, PLATFORM_DESIGNATION, "FalconEye")
+    );
+    assert(state.apply(first) == 4);
+    assert(state.timestamp() == 1000u);
+    assert(state.known_count() == 4);
+
+    KLVSet second = KLV_LOCAL_DATASET(
+        KLV_ST_ITEM(0601, UNIX_TIMESTAMP, 2000.0),
+        KLV_ST_ITEM(0601, SENSOR_LATITUDE, 46.0)
+    );
+    assert(state.apply(second) == 2);
+    assert(state.packet_count() == 2);
+    assert(state.known_count() == 4);
+    assert(std::fabs(state.value(13) - 46.0) < 1e-6);
+    assert(std::fabs(state.value(14) - 2.0) < 1e-6);
+    assert(state.updated_at(13) == 2000u);
+    assert(state.updated_at(14) == 1000u);
+    assert(state.slot(13).updates == 2);
+    const auto& designation = state.bytes(10);
+    assert(std::string(designation.begin(), designation.end()) == "FalconEye");
+    assert(std::isnan(state.value(10)));
+
+    KLVSet full = state.snapshot();
+    assert(full.children().size() == 4);
+    double lon = 0.0;
+    ST_GET(full, 0601, SENSOR_LONGITUDE, lon);
+    assert(std::fabs(lon - 2.0) < 1e-6);
+
+    state.reset();
+    assert(!state.has(13));
+    assert(state.known_count() == 0);
+
+    // Time-indexed history with linear and wrapping-angle interpolation
+    using misb::st0601::FeedHistory;
+    FeedHistory history(3, {13, 5});
+    assert(history.empty());
+    double row0[] = {10.0, 350.0};
+    double row1[] = {20.0, 10.0};
+    double row2[] = {30.0, 90.0};
+    double row3[] = {40.0, 180.0};
+    assert(history.push(1000, row0));
+    assert(history.push(2000, row1));
+    assert(!history.push(1500, row0));
+    double out[2] = {0.0, 0.0};
+    assert(history.sample_at(1500, out));
+    assert(std::fabs(out[0] - 15.0) < 1e-9);
+    assert(std::fabs(out[1] - 0.0) < 1e-9);
+    assert(history.sample_at(1250, out));
+    assert(std::fabs(out[1] - 355.0) < 1e-9);
+    assert(!history.sample_at(999, out));
+    assert(!history.sample_at(2001, out));
+    assert(std::fabs(history.value_at(2000, 13) - 20.0) < 1e-9);
+    assert(std::isnan(history.value_at(1500, 14)));
+
+    // Ring buffer evicts the oldest sample once full
+    assert(history.push(3000, row2));
+    assert(history.push(4000, row3));
+    assert(history.size() == 3);
+    assert(history.oldest() == 2000u);
+    assert(history.newest() == 4000u);
+    assert(!history.sample_at(1500, out));
+    assert(std::fabs(history.value_at(3500, 13) - 35.0) < 1e-9);
+    assert(std::fabs(history.value_at(3500, 5) - 135.0) < 1e-9);
+
+    // Longitudes and relative elevation cross the antimeridian the short way
+    {
+        FeedHistory signed_angles(2, {14, 19, 13});
+        const double west[] = {179.9, -170.0, 10.0};
+        const double east[] = {-179.9, 170.0, 20.0};
+        assert(signed_angles.push(1000, west));
+        assert(signed_angles.push(2000, east));
+        assert(std::fabs(signed_angles.value_at(1250, 14) - 179.95) < 1e-9);
+        assert(std::fabs(signed_angles.value_at(1750, 14) + 179.95) < 1e-9);
+        assert(std::fabs(signed_angles.value_at(1250, 19) + 175.0) < 1e-9);
+        assert(std::fabs(signed_angles.value_at(1750, 19) - 175.0) < 1e-9);
+        assert(std::fabs(signed_angles.value_at(1500, 13) - 15.0) < 1e-9);
+    }
+
+    // Feed the history from the carry-forward state
+    FeedHistory from_state(8, {13, 14});
+    misb::st0601::FeedState feed;
+    feed.apply(first);
+    from_state.push(feed);
+    feed.apply(second);
+    from_state.push(feed);
+    assert(std::fabs(from_state.value_at(1500, 13) - 45.5) < 1e-6);
+    assert(std::fabs(from_state.value_at(1500, 14) - 2.0) < 1e-6);
+
+    return 0;
+}
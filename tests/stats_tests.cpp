@@ -0,0 +1,106 @@
+#include "klv.h"
+#include "st0601.h"
+#include "st0601_stats.h"
+#include "stanag.h"
+#include <cassert>
+#include <cmath>
+#include <limits>
+#include <thread>
+#include <vector>
+
+using namespace misb::st0601;
+
+namespace {
+
+bool near(double a, double b, double tol) {
+    return std::fabs(a - b) <= tol;
+}
+
+// 30 Hz feed; pitch on even packets only, out of range on packet 4 and NaN
+// on packet 8
+std::vector<uint8_t> make_packet(int i) {
+    std::vector<stanag::TagValue> tags = {
+        stanag::TagValue(UNIX_TIMESTAMP, 1700000000000000.0 + i * 1e6 / 30.0),
+        stanag::TagValue(PLATFORM_HEADING_ANGLE, static_cast<double>(10 * (i % 10))),
+        stanag::TagValue(PLATFORM_DESIGNATION, std::string("UAV")),
+        stanag::TagValue(UAS_LS_VERSION_NUMBER, 12.0)
+    };
+    if (i % 2 == 0) {
+        double pitch = 1.0;
+        if (i == 4) pitch = 25.0;
+        if (i == 8) pitch = std::numeric_limits<double>::quiet_NaN();
+        tags.push_back(stanag::TagValue(PLATFORM_PITCH_ANGLE, pitch));
+    }
+    return stanag::create_stanag4609_packet(tags);
+}
+
+} // namespace
+
+int main() {
+    auto& reg = KLVRegistry::instance();
+    register_st0601(reg);
+
+    std::vector<uint8_t> archive;
+    for (int i = 0; i < 100; ++i) {
+        const auto p = make_packet(i);
+        archive.insert(archive.end(), p.begin(), p.end());
+    }
+
+    // Two collectors over halves of the archive, merged
+    std::vector<stanag::PacketView> views;
+    stanag::PacketView view;
+    for (size_t from = 0; stanag::find_next_packet(archive.data(), archive.size(), from, view);
+         from = view.offset + view.length) {
+        views.push_back(view);
+    }
+    assert(views.size() == 100);
+    FeedStats first, second;
+    std::thread worker([&]() {
+        for (size_t i = 50; i < views.size(); ++i) second.apply(archive.data(), views[i]);
+    });
+    for (size_t i = 0; i < 50; ++i) first.apply(archive.data(), views[i]);
+    worker.join();
+    first.merge(second);
+    FeedStats& stats = first;
+    assert(stats.packet_count() == 100);
+
+    const TagSummary heading = stats.summary(PLATFORM_HEADING_ANGLE[15]);
+    assert(heading.updates == 100 && heading.presence == 1.0);
+    assert(near(heading.min, 0.0, 0.01) && near(heading.max, 90.0, 0.01));
+    assert(near(heading.mean, 45.0, 0.01));
+    assert(near(heading.update_hz, 30.0, 0.01));
+    assert(heading.saturated == 0 && heading.sentinels == 0);
+
+    const TagSummary pitch = stats.summary(PLATFORM_PITCH_ANGLE[15]);
+    assert(pitch.updates == 50 && pitch.presence == 0.5);
+    assert(pitch.sentinels == 1 && pitch.saturated == 1 && pitch.values == 49);
+    assert(near(pitch.max, 20.0, 1e-3) && near(pitch.min, 1.0, 1e-3));
+    assert(near(pitch.update_hz, 15.0, 0.01));
+
+    // Non-numeric tags only report presence and rate
+    const TagSummary designation = stats.summary(PLATFORM_DESIGNATION[15]);
+    assert(designation.updates == 100 && designation.values == 0);
+    assert(std::isnan(designation.mean));
+    assert(stats.summary(SENSOR_LATITUDE[15]).updates == 0);
+    assert(stats.summaries().size() == 5);
+
+    // Whole packets, malformed items and reset
+    {
+        FeedStats single;
+        const auto packet = make_packet(0);
+        assert(single.apply_packet(packet.data(), packet.size()));
+        assert(!single.apply_packet(packet.data() + 1, packet.size() - 1));
+        assert(single.packet_count() == 1);
+        assert(single.summary(PLATFORM_PITCH_ANGLE[15]).values == 1);
+
+        const uint8_t payload[] = {0x05, 0x01, 0x20, 0x41, 0x01, 0x0C};
+        single.apply(payload, sizeof(payload));
+        assert(single.tag(PLATFORM_HEADING_ANGLE[15]).malformed == 1);
+        assert(single.summary(UAS_LS_VERSION_NUMBER[15]).presence == 1.0);
+
+        single.reset();
+        assert(single.packet_count() == 0 && single.summaries().empty());
+    }
+
+    return 0;
+}
@@ -0,0 +1,169 @@
+#include "klv.h"
+#include "klv_macros.h"
+#include "klv_thread_pool.h"
+#include "st0601.h"
+#include "st0601_scan.h"
+#include "st0903.h"
+#include "stanag.h"
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <ctime>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+int main() {
+    auto& reg = KLVRegistry::instance();
+    misb::st0601::register_st0601(reg);
+    misb::st0903::register_st0903(reg);
+
+    // Every index visited once, chunks aligned on the grain
+    for (unsigned threads : {1u, 2u, 4u}) {
+        ThreadPool pool(threads);
+        assert(pool.concurrency() == threads);
+        const size_t count = 10007, grain = 100;
+        std::vector<std::atomic<int>> hits(count);
+        for (auto& h : hits) h.store(0);
+        std::atomic<size_t> chunks(0);
+        pool.parallel_for(count, grain, [&](size_t begin, size_t end) {
+            assert(begin % grain == 0);
+            assert(end == std::min(count, begin + grain));
+            for (size_t i = begin; i < end; ++i) hits[i].fetch_add(1);
+            chunks.fetch_add(1);
+        });
+        for (const auto& h : hits) assert(h.load() == 1);
+        assert(chunks.load() == (count + grain - 1) / grain);
+        pool.parallel_for(0, grain, [](size_t, size_t) { assert(false); });
+    }
+
+    // Nested loops, task groups and exceptions
+    {
+        ThreadPool pool(4);
+        std::atomic<int> total(0);
+        pool.parallel_for(16, 1, [&](size_t, size_t) {
+            pool.parallel_for(64, 4, [&](size_t begin, size_t end) {
+                total.fetch_add(static_cast<int>(end - begin));
+            });
+        });
+        assert(total.load() == 16 * 64);
+
+        TaskGroup group(pool);
+        std::atomic<int> ran(0);
+        for (int i = 0; i < 100; ++i) group.run([&ran]() { ran.fetch_add(1); });
+        group.wait();
+        assert(ran.load() == 100);
+
+        bool threw = false;
+        try {
+            pool.parallel_for(1000, 10, [](size_t begin, size_t) {
+                if (begin == 500) throw std::runtime_error("chunk failed");
+            });
+        } catch (const std::runtime_error&) {
+            threw = true;
+        }
+        assert(threw);
+
+        std::atomic<bool> done(false);
+        pool.submit([&done]() { done.store(true); });
+        while (!done.load()) {
+            if (!pool.run_one()) std::this_thread::yield();
+        }
+    }
+
+    // A waiter with nothing left to run sleeps until the last task ends
+    {
+        ThreadPool pool(2);
+        TaskGroup group(pool);
+        std::atomic<bool> started(false);
+        group.run([&started]() {
+            started.store(true);
+            std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        });
+        while (!started.load()) std::this_thread::yield();
+        timespec before, after;
+        clock_gettime(CLOCK_THREAD_CPUTIME_ID, &before);
+        group.wait();
+        clock_gettime(CLOCK_THREAD_CPUTIME_ID, &after);
+        const double cpu_ms = (after.tv_sec - before.tv_sec) * 1e3 +
+                              (after.tv_nsec - before.tv_nsec) / 1e6;
+        assert(cpu_ms < 50.0);
+    }
+
+    // Pinned workers still run everything
+    {
+        ThreadPoolConfig config;
+        config.threads = 3;
+        config.pin_threads = true;
+        config.cpus = {0};
+        ThreadPool pool(config);
+        std::atomic<int> total(0);
+        pool.parallel_for(300, 7, [&](size_t begin, size_t end) {
+            total.fetch_add(static_cast<int>(end - begin));
+        });
+        assert(total.load() == 300);
+    }
+
+    // Batch entry points match their sequential forms
+    {
+        ThreadPool pool(4);
+        std::vector<std::vector<stanag::TagValue>> feeds;
+        for (int i = 0; i < 300; ++i) {
+            feeds.push_back({
+                stanag::TagValue(misb::st0601::UNIX_TIMESTAMP, 1700000000.0 + i),
+                stanag::TagValue(misb::st0601::PLATFORM_HEADING_ANGLE, static_cast<double>(i % 360)),
+                stanag::TagValue(misb::st0601::SENSOR_LATITUDE, -45.0 + 0.1 * i),
+                stanag::TagValue(misb::st0601::UAS_LS_VERSION_NUMBER, 12.0)
+            });
+        }
+        const auto packets = stanag::create_stanag4609_packets(feeds, pool);
+        assert(packets.size() == feeds.size());
+        std::vector<uint8_t> archive;
+        for (size_t i = 0; i < feeds.size(); ++i) {
+            assert(packets[i] == stanag::create_stanag4609_packet(feeds[i]));
+            archive.insert(archive.end(), packets[i].begin(), packets[i].end());
+        }
+
+        misb::st0601::ScanQuery query;
+        query.where(misb::st0601::SENSOR_LATITUDE, -30.0, 30.0);
+        const auto hits = misb::st0601::scan(archive.data(), archive.size(), query);
+        const auto hits_pool = misb::st0601::scan(archive.data(), archive.size(), query, pool);
+        assert(!hits.empty() && hits.size() == hits_pool.size());
+        for (size_t i = 0; i < hits.size(); ++i) assert(hits[i].offset == hits_pool[i].offset);
+
+        const auto sets = misb::st0601::decode_matches(archive.data(), hits);
+        const auto sets_pool = misb::st0601::decode_matches(archive.data(), hits, pool);
+        assert(sets.size() == sets_pool.size());
+        for (size_t i = 0; i < sets.size(); ++i) assert(sets[i].encode() == sets_pool[i].encode());
+
+        std::vector<misb::st0903::VTargetPack> packs;
+        for (uint64_t id = 1; id <= 500; ++id) {
+            packs.push_back(KLV_VTARGET_PACK(id,
+                KLV_TAG(misb::st0903::VTARGET_CENTROID, static_cast<double>(1000 + id)),
+                KLV_TAG(misb::st0903::VTARGET_CONFIDENCE_LEVEL, 0.5)));
+        }
+        const ByteSlice series = ByteSlice::adopt(misb::st0903::encode_vtarget_series(packs));
+        const auto serial = misb::st0903::decode_vtarget_series(series);
+        const auto parallel = misb::st0903::decode_vtarget_series(series, pool);
+        assert(parallel.size() == packs.size());
+        for (size_t i = 0; i < parallel.size(); ++i) {
+            assert(parallel[i].target_id == serial[i].target_id);
+            assert(parallel[i].set.encode() == serial[i].set.encode());
+        }
+
+        // Duplicate ids are rejected before any decoding
+        auto twice = misb::st0903::encode_vtarget_series({packs.front()});
+        const auto once = twice;
+        twice.insert(twice.end(), once.begin(), once.end());
+        const ByteSlice duplicate = ByteSlice::adopt(std::move(twice));
+        bool threw = false;
+        try {
+            misb::st0903::decode_vtarget_series(duplicate, pool);
+        } catch (const std::runtime_error&) {
+            threw = true;
+        }
+        assert(threw);
+    }
+
+    return 0;
+}
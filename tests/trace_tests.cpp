@@ -0,0 +1,131 @@
+#include "klv.h"
+#include "klv_macros.h"
+#include "klv_trace.h"
+#include "st0601.h"
+#include "st0903.h"
+#include "stanag.h"
+#include <atomic>
+#include <cassert>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+#if KLV_TRACE
+size_t count_of(const std::string& text, const std::string& needle) {
+    size_t n = 0;
+    for (size_t pos = text.find(needle); pos != std::string::npos; pos = text.find(needle, pos + 1)) ++n;
+    return n;
+}
+#endif
+
+std::vector<uint8_t> make_packet(int i) {
+    return stanag::create_stanag4609_packet({
+        stanag::TagValue(misb::st0601::UNIX_TIMESTAMP, 1700000000.0 + i),
+        stanag::TagValue(misb::st0601::PLATFORM_HEADING_ANGLE, 90.0),
+        stanag::TagValue(misb::st0601::UAS_LS_VERSION_NUMBER, 12.0)
+    });
+}
+
+} // namespace
+
+int main() {
+    auto& reg = KLVRegistry::instance();
+    misb::st0601::register_st0601(reg);
+    misb::st0903::register_st0903(reg);
+
+    // Nothing is recorded before start()
+    assert(!KLVTrace::enabled());
+    make_packet(0);
+    assert(KLVTrace::event_count() == 0);
+
+#if KLV_TRACE
+    KLVTrace::start();
+    assert(KLVTrace::enabled());
+    const std::vector<uint8_t> packet = make_packet(1);
+    std::thread worker([&packet]() {
+        KLVSet set;
+        assert(stanag::decode_stanag4609_packet(ByteSlice::copy(packet), set));
+        std::vector<misb::st0903::VTargetPack> packs;
+        for (uint64_t id = 1; id <= 3; ++id) {
+            packs.push_back(KLV_VTARGET_PACK(id,
+                KLV_TAG(misb::st0903::VTARGET_CENTROID, static_cast<double>(100 + id))));
+        }
+        const auto series = misb::st0903::decode_vtarget_series(misb::st0903::encode_vtarget_series(packs));
+        assert(series.size() == 3);
+    });
+    worker.join();
+    KLVTrace::stop();
+    make_packet(2);
+
+    // Spans of the exited worker are kept, nested spans included
+    const std::string json = KLVTrace::to_json();
+    assert(json.compare(0, 16, "{\"traceEvents\":[") == 0);
+    assert(count_of(json, "\"ph\":\"X\"") == KLVTrace::event_count());
+    assert(count_of(json, "\"name\":\"stanag::create_packet\"") == 1);
+    assert(count_of(json, "\"name\":\"stanag::decode_packet\"") == 1);
+    assert(count_of(json, "\"name\":\"st0903::decode_vtarget_series\"") == 1);
+    assert(count_of(json, "\"name\":\"st0903::frame_vtarget_series\"") == 1);
+    assert(count_of(json, "\"name\":\"KLVSet::decode\"") == 4);
+    assert(count_of(json, "\"name\":\"leaf_codec\"") >= 6);
+    assert(json.find("\"args\":{\"st_id\":1}") != std::string::npos);
+    assert(json.find("\"tid\":1,") != std::string::npos && json.find("\"tid\":2,") != std::string::npos);
+
+    const char* path = "klv_trace_tests.json";
+    assert(KLVTrace::write_json(path));
+    std::ifstream file(path);
+    assert(std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()) == json);
+    std::remove(path);
+
+    // A full buffer drops instead of growing; start() discards everything
+    KLVTrace::start();
+    for (size_t i = 0; i < KLVTrace::THREAD_CAPACITY + 10; ++i) {
+        KLV_TRACE_SPAN("filler");
+    }
+    KLVTrace::stop();
+    assert(KLVTrace::event_count() == KLVTrace::THREAD_CAPACITY);
+    assert(KLVTrace::dropped() == 10);
+    KLVTrace::start();
+    KLVTrace::stop();
+    assert(KLVTrace::event_count() == 0 && KLVTrace::dropped() == 0);
+    assert(KLVTrace::to_json() == "{\"traceEvents\":[\n],\"displayTimeUnit\":\"ns\"}\n");
+
+    // start() leaves live buffers to their owners: a thread idle across it
+    // reports nothing, then only its new spans
+    {
+        std::atomic<int> phase(0);
+        KLVTrace::start();
+        std::thread idle([&phase]() {
+            for (int i = 0; i < 3; ++i) {
+                KLV_TRACE_SPAN("before");
+            }
+            phase.store(1);
+            while (phase.load() != 2) std::this_thread::yield();
+            {
+                KLV_TRACE_SPAN("after");
+            }
+            phase.store(3);
+            while (phase.load() != 4) std::this_thread::yield();
+        });
+        while (phase.load() != 1) std::this_thread::yield();
+        assert(KLVTrace::event_count() == 3);
+        KLVTrace::start();
+        assert(KLVTrace::event_count() == 0);
+        phase.store(2);
+        while (phase.load() != 3) std::this_thread::yield();
+        assert(KLVTrace::event_count() == 1);
+        assert(KLVTrace::to_json().find("\"before\"") == std::string::npos);
+        KLVTrace::start();
+        phase.store(4);
+        idle.join();
+        KLVTrace::stop();
+        assert(KLVTrace::event_count() == 0);
+    }
+#endif
+
+    return 0;
+}
@@ -0,0 +1,301 @@
+#include "klv.h"
+#include "klv_udp.h"
+#include "klv_udp_receiver.h"
+#include "klv_udp_sender.h"
+#include "st0601.h"
+#include "stanag.h"
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace stanag::net;
+
+namespace {
+
+std::vector<uint8_t> make_packet(double timestamp, double heading) {
+    return stanag::create_stanag4609_packet({
+        stanag::TagValue(misb::st0601::UNIX_TIMESTAMP, timestamp),
+        stanag::TagValue(misb::st0601::PLATFORM_HEADING_ANGLE, heading),
+        stanag::TagValue(misb::st0601::UAS_LS_VERSION_NUMBER, 12.0)
+    });
+}
+
+double leaf_value(const KLVSet& set, const UL& ul) {
+    for (const auto& node : set.children()) {
+        if (auto leaf = std::dynamic_pointer_cast<KLVLeaf>(node)) {
+            if (leaf->ul() == ul) return leaf->value();
+        }
+    }
+    return NAN;
+}
+
+template <typename Pred>
+bool wait_for(Pred done) {
+    for (int i = 0; i < 400; ++i) {
+        if (done()) return true;
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    return done();
+}
+
+} // namespace
+
+int main() {
+    auto& reg = KLVRegistry::instance();
+    misb::st0601::register_st0601(reg);
+
+    // Single packet decode and checksum verification
+    const auto packet = make_packet(1700000000.0, 90.0);
+    assert(stanag::verify_packet_checksum(packet.data(), packet.size()));
+    KLVSet decoded;
+    assert(stanag::decode_stanag4609_packet(ByteSlice::copy(packet), decoded));
+    assert(leaf_value(decoded, misb::st0601::UNIX_TIMESTAMP) == 1700000000.0);
+    assert(std::fabs(leaf_value(decoded, misb::st0601::PLATFORM_HEADING_ANGLE) - 90.0) < 1e-2);
+    auto corrupt = packet;
+    corrupt[corrupt.size() - 6] ^= 0xFF;
+    assert(!stanag::verify_packet_checksum(corrupt.data(), corrupt.size()));
+    assert(!stanag::decode_stanag4609_packet(ByteSlice::copy(corrupt), decoded));
+
+    // Framer: split, concatenated and garbage-prefixed input
+    {
+        std::vector<uint8_t> stream = {0x00, 0x06, 0x0E};
+        for (int i = 0; i < 3; ++i) {
+            const auto p = make_packet(1700000000.0 + i, 10.0 * i);
+            stream.insert(stream.end(), p.begin(), p.end());
+        }
+        for (size_t piece : {size_t(1), size_t(5), size_t(17), stream.size()}) {
+            stanag::PacketFramer framer;
+            std::vector<std::vector<uint8_t>> out;
+            for (size_t pos = 0; pos < stream.size(); pos += piece) {
+                const size_t n = std::min(piece, stream.size() - pos);
+                framer.push(stream.data() + pos, n, [&](const uint8_t* p, size_t len) {
+                    out.emplace_back(p, p + len);
+                });
+            }
+            assert(out.size() == 3);
+            assert(out[0] == make_packet(1700000000.0, 0.0));
+            assert(out[2] == make_packet(1700000002.0, 20.0));
+            assert(framer.pending() == 0);
+            assert(framer.discarded_bytes() == 3);
+        }
+
+        // A bogus 4 KiB packet is dropped instead of accumulating
+        stanag::PacketFramer small(64);
+        std::vector<uint8_t> prefix(stanag::UAS_DATALINK_LOCAL_SET_UL.begin(),
+                                    stanag::UAS_DATALINK_LOCAL_SET_UL.end());
+        prefix.insert(prefix.end(), {0x82, 0x10, 0x00, 0x02});
+        std::vector<uint8_t> filler(100, 0x00);
+        size_t count = 0;
+        auto counter = [&](const uint8_t*, size_t) { ++count; };
+        small.push(prefix.data(), prefix.size(), counter);
+        assert(small.pending() == 20);
+        small.push(filler.data(), filler.size(), counter);
+        assert(small.pending() == 0 && small.discarded_bytes() == 120);
+        small.push(packet.data(), packet.size(), counter);
+        assert(count == 1);
+    }
+
+    // Loopback receiver: two feeds, each split across datagrams
+    {
+        std::mutex mutex;
+        std::map<uint32_t, std::vector<double>> timestamps;
+        ReceiverConfig config;
+        config.bind_address = "127.0.0.1";
+        config.batch_size = 8;
+        config.datagram_capacity = 2048;
+        config.decoder_threads = 2;
+        UdpReceiver receiver(config, [&](const ReceivedPacket& p, const KLVSet& set) {
+            std::lock_guard<std::mutex> lock(mutex);
+            timestamps[p.feed].push_back(leaf_value(set, misb::st0601::UNIX_TIMESTAMP));
+        });
+        assert(receiver.ports().size() == 1 && receiver.ports()[0] != 0);
+        receiver.start();
+
+        const Endpoint to = make_endpoint("127.0.0.1", receiver.ports()[0]);
+        DatagramSender a, b;
+        const int per_feed = 50;
+        for (int i = 0; i < per_feed; ++i) {
+            const auto pa = make_packet(1700000000.0 + i, 1.0);
+            assert(a.send_to(to, pa.data(), pa.size()));
+            // Feed b sends every packet in two datagrams
+            const auto pb = make_packet(1800000000.0 + i, 2.0);
+            const size_t half = pb.size() / 2;
+            assert(b.send_to(to, pb.data(), half));
+            assert(b.send_to(to, pb.data() + half, pb.size() - half));
+            // Let the socket buffer breathe on slow machines
+            if (i % 10 == 9) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        assert(b.send_to(to, corrupt.data(), corrupt.size()));
+        assert(wait_for([&]() {
+            const ReceiverStats s = receiver.stats();
+            return s.decoded + s.invalid == 2 * per_feed + 1;
+        }));
+        receiver.stop();
+
+        const ReceiverStats stats = receiver.stats();
+        assert(stats.datagrams == 3 * per_feed + 1);
+        assert(stats.packets == 2 * per_feed + 1);
+        assert(stats.decoded == 2 * per_feed);
+        assert(stats.invalid == 1);
+        assert(stats.queue_drops == 0);
+        assert(stats.truncated == 0 && stats.feed_drops == 0);
+        assert(stats.feeds == 2);
+        assert(stats.batches >= 1);
+
+        const auto feeds = receiver.feeds();
+        assert(feeds.size() == 2);
+        assert(feeds[0].source.port != feeds[1].source.port);
+        assert(feeds[0].local_port == receiver.ports()[0]);
+        for (const auto& entry : timestamps) {
+            const auto& ts = entry.second;
+            assert(ts.size() == static_cast<size_t>(per_feed));
+            for (size_t i = 1; i < ts.size(); ++i) assert(ts[i] == ts[i - 1] + 1.0);
+        }
+    }
+
+    // Oversized datagrams and sources beyond max_feeds are dropped and counted
+    {
+        size_t delivered = 0;
+        ReceiverConfig config;
+        config.bind_address = "127.0.0.1";
+        config.datagram_capacity = 256;
+        config.max_feeds = 1;
+        UdpReceiver receiver(config, [&](const ReceivedPacket&, const KLVSet&) { ++delivered; });
+        receiver.start();
+
+        const Endpoint to = make_endpoint("127.0.0.1", receiver.ports()[0]);
+        DatagramSender a, b;
+        std::vector<uint8_t> oversized(make_packet(1700000000.0, 1.0));
+        oversized.resize(1024, 0x00);
+        assert(a.send_to(to, oversized.data(), oversized.size()));
+        const auto pa = make_packet(1700000001.0, 1.0);
+        assert(a.send_to(to, pa.data(), pa.size()));
+        assert(wait_for([&]() { return receiver.stats().decoded == 1; }));
+        const auto pb = make_packet(1800000000.0, 2.0);
+        assert(b.send_to(to, pb.data(), pb.size()));
+        assert(wait_for([&]() { return receiver.stats().feed_drops == 1; }));
+        receiver.stop();
+
+        const ReceiverStats stats = receiver.stats();
+        assert(stats.datagrams == 3);
+        assert(stats.truncated == 1);
+        assert(stats.feeds == 1 && stats.packets == 1 && delivered == 1);
+        assert(stats.discarded_bytes == 0);
+    }
+
+    // Paced sender: one feed at a fixed rate, one paced by UNIX_TIMESTAMP,
+    // each to its own receiver port
+    {
+        std::mutex mutex;
+        std::map<uint16_t, std::vector<double>> timestamps;
+        ReceiverConfig config;
+        config.bind_address = "127.0.0.1";
+        config.ports = {0, 0};
+        UdpReceiver receiver(config, [&](const ReceivedPacket& p, const KLVSet& set) {
+            std::lock_guard<std::mutex> lock(mutex);
+            timestamps[p.local_port].push_back(leaf_value(set, misb::st0601::UNIX_TIMESTAMP));
+        });
+        receiver.start();
+
+        PacedSender sender;
+        const uint32_t fixed = sender.add_feed(make_endpoint("127.0.0.1", receiver.ports()[0]), 100.0);
+        const uint32_t timed = sender.add_feed(make_endpoint("127.0.0.1", receiver.ports()[1]));
+        const int count = 20;
+        const auto begin = std::chrono::steady_clock::now();
+        for (int i = 0; i < count; ++i) {
+            assert(sender.submit(fixed, make_packet(1700000000.0 + i, 1.0)));
+            // 10 ms apart, in microseconds
+            assert(sender.submit(timed, make_packet(1700000000.0 + i * 10000.0, 2.0)));
+        }
+        assert(sender.pending() == 2 * count);
+        sender.start();
+        assert(wait_for([&]() { return receiver.stats().decoded == 2 * count; }));
+        const auto elapsed = std::chrono::steady_clock::now() - begin;
+        // Never early: 19 periods of 10 ms at least
+        assert(elapsed >= std::chrono::milliseconds(189));
+        sender.stop();
+        receiver.stop();
+
+        const SenderStats stats = sender.stats();
+        assert(stats.submitted == 2 * count && stats.sent == 2 * count);
+        assert(stats.errors == 0 && stats.rejected == 0 && stats.pending == 0);
+        assert(stats.batches >= 1 && stats.batches <= stats.sent);
+        assert(stats.feeds.size() == 2);
+        for (const auto& f : stats.feeds) {
+            assert(f.sent == static_cast<uint64_t>(count));
+            assert(f.rate_hz > 0.0 && f.rate_hz < 110.0);
+            assert(f.min_lateness_us >= 0.0 && f.mean_lateness_us >= f.min_lateness_us);
+            assert(f.max_lateness_us >= f.mean_lateness_us && f.jitter_us >= 0.0);
+        }
+        assert(timestamps.size() == 2);
+        for (const auto& entry : timestamps) {
+            const auto& ts = entry.second;
+            assert(ts.size() == static_cast<size_t>(count));
+            for (size_t i = 1; i < ts.size(); ++i) assert(ts[i] > ts[i - 1]);
+        }
+
+        // Ticks coarser than the period: packets due inside a tick wait for
+        // the next one instead of leaving at the start of theirs
+        {
+            SenderConfig coarse;
+            coarse.tick_ns = 25000000;
+            PacedSender paced(coarse);
+            const uint32_t feed = paced.add_feed(make_endpoint("127.0.0.1", receiver.ports()[0]), 100.0);
+            for (int i = 0; i < 10; ++i) {
+                assert(paced.submit(feed, make_packet(1700000100.0 + i, 1.0)));
+            }
+            paced.start();
+            assert(wait_for([&]() { return paced.stats().sent == 10; }));
+            paced.stop();
+            const SenderFeedStats f = paced.stats().feeds[0];
+            assert(f.min_lateness_us >= 0.0 && f.max_lateness_us >= f.min_lateness_us);
+        }
+
+        // Bounded backlog
+        SenderConfig small;
+        small.max_pending = 2;
+        PacedSender bounded(small);
+        const uint32_t feed = bounded.add_feed(make_endpoint("127.0.0.1", 9), 1.0);
+        assert(bounded.submit(feed, make_packet(1.0, 0.0)));
+        assert(bounded.submit(feed, make_packet(2.0, 0.0)));
+        assert(!bounded.submit(feed, make_packet(3.0, 0.0)));
+        assert(bounded.stats().rejected == 1);
+    }
+
+    // A stall longer than a wheel revolution keeps a feed in order
+    {
+        std::mutex mutex;
+        std::vector<double> timestamps;
+        ReceiverConfig config;
+        config.bind_address = "127.0.0.1";
+        UdpReceiver receiver(config, [&](const ReceivedPacket&, const KLVSet& set) {
+            std::lock_guard<std::mutex> lock(mutex);
+            timestamps.push_back(leaf_value(set, misb::st0601::UNIX_TIMESTAMP));
+        });
+        receiver.start();
+
+        SenderConfig tiny;
+        tiny.wheel_slots = 4;
+        PacedSender sender(tiny);
+        const uint32_t feed = sender.add_feed(make_endpoint("127.0.0.1", receiver.ports()[0]));
+        const int count = 8;
+        for (int i = 0; i < count; ++i) {
+            // 3 ms apart, so consecutive packets land in scattered slots
+            assert(sender.submit(feed, make_packet(1700000000.0 + i * 3000.0, 3.0)));
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(40));
+        sender.start();
+        assert(wait_for([&]() { return receiver.stats().decoded == count; }));
+        sender.stop();
+        receiver.stop();
+        assert(timestamps.size() == static_cast<size_t>(count));
+        for (size_t i = 1; i < timestamps.size(); ++i) assert(timestamps[i] > timestamps[i - 1]);
+    }
+
+    return 0;
+}
@@ -0,0 +1,127 @@
+#include "klv_varint.h"
+#include "st_common.h"
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+// Reference encoders mirroring the original byte-by-byte implementations
+static std::vector<uint8_t> reference_ber_length(uint64_t length) {
+    if (length < 0x80) return {static_cast<uint8_t>(length)};
+    std::vector<uint8_t> bytes;
+    while (length > 0) {
+        bytes.push_back(static_cast<uint8_t>(length & 0xFF));
+        length >>= 8;
+    }
+    std::vector<uint8_t> out;
+    out.push_back(static_cast<uint8_t>(0x80 | bytes.size()));
+    out.insert(out.end(), bytes.rbegin(), bytes.rend());
+    return out;
+}
+
+static std::vector<uint8_t> reference_ber_oid(uint64_t value) {
+    std::vector<uint8_t> tmp;
+    do {
+        tmp.push_back(static_cast<uint8_t>(value & 0x7Fu));
+        value >>= 7;
+    } while (value > 0);
+    std::vector<uint8_t> out;
+    for (size_t i = tmp.size(); i-- > 0;) {
+        out.push_back(static_cast<uint8_t>(tmp[i] | (i != 0 ? 0x80u : 0u)));
+    }
+    return out;
+}
+
+static void check_ber_length(uint64_t len) {
+    const auto expected = reference_ber_length(len);
+    uint8_t buf[16];
+    const size_t n = misb::write_ber_length(buf, sizeof(buf), len);
+    assert(n == expected.size());
+    assert(n == misb::ber_length_size(len));
+    assert(std::vector<uint8_t>(buf, buf + n) == expected);
+    assert(misb::write_ber_length(buf, n - 1, len) == 0);
+    size_t decoded = 0;
+    assert(misb::read_ber_length(buf, n, decoded) == n);
+    assert(decoded == len);
+    assert(misb::read_ber_length(buf, n - 1, decoded) == 0);
+}
+
+static void check_ber_oid(uint64_t v) {
+    const auto expected = reference_ber_oid(v);
+    uint8_t buf[16];
+    const size_t n = misb::write_ber_oid(buf, sizeof(buf), v);
+    assert(n == expected.size());
+    assert(n == misb::ber_oid_size(v));
+    assert(std::vector<uint8_t>(buf, buf + n) == expected);
+    assert(misb::write_ber_oid(buf, n - 1, v) == 0);
+    uint64_t decoded = 0;
+    assert(misb::read_ber_oid(buf, n, decoded) == n);
+    assert(decoded == v);
+    assert(misb::read_ber_oid(buf, n - 1, decoded) == 0);
+}
+
+static void check_uint(uint64_t v) {
+    size_t width = 1;
+    while (width < 8 && (v >> (width * 8)) != 0) ++width;
+    assert(misb::uint_byte_width(v) == width);
+    for (size_t w = 1; w <= 8; ++w) {
+        uint8_t buf[8];
+        assert(misb::write_uint_be(buf, w, v, w) == w);
+        for (size_t i = 0; i < w; ++i) {
+            assert(buf[i] == static_cast<uint8_t>(v >> ((w - 1 - i) * 8)));
+        }
+        uint64_t decoded = 0;
+        assert(misb::read_uint_be(buf, w, w, decoded) == w);
+        const uint64_t mask = w == 8 ? ~uint64_t{0} : ((uint64_t{1} << (w * 8)) - 1);
+        assert(decoded == (v & mask));
+        assert(misb::read_uint_be(buf, w - 1, w, decoded) == 0);
+    }
+}
+
+int main() {
+    // Exhaustive over the ranges seen in practice, then every power-of-two
+    // boundary up to 64 bits
+    for (uint64_t len = 0; len < (1u << 20); ++len) {
+        check_ber_length(len);
+    }
+    for (uint64_t v = 0; v < (1u << 21); ++v) {
+        check_ber_oid(v);
+    }
+    for (uint64_t v = 0; v < (1u << 17); ++v) {
+        check_uint(v);
+    }
+    for (unsigned bit = 0; bit < 64; ++bit) {
+        const uint64_t p = uint64_t{1} << bit;
+        const uint64_t values[] = {p - 1, p, p + 1, ~uint64_t{0} >> (63 - bit)};
+        for (uint64_t v : values) {
+            check_ber_length(v);
+            check_ber_oid(v);
+            check_uint(v);
+        }
+    }
+
+    // Malformed input
+    size_t len = 0;
+    const uint8_t indefinite[] = {0x80};
+    assert(misb::read_ber_length(indefinite, 1, len) == 0);
+    const uint8_t too_wide[] = {0x89, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+    assert(misb::read_ber_length(too_wide, sizeof(too_wide), len) == 0);
+    assert(misb::read_ber_length(nullptr, 0, len) == 0);
+    uint64_t oid = 0;
+    const uint8_t unterminated[] = {0x81, 0x82, 0x83};
+    assert(misb::read_ber_oid(unterminated, sizeof(unterminated), oid) == 0);
+    const uint8_t overflow[] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x7F};
+    assert(misb::read_ber_oid(overflow, sizeof(overflow), oid) == 0);
+    assert(misb::sign_extend(0x8000, 2) == -32768);
+    assert(misb::sign_extend(0x7FFF, 2) == 32767);
+    assert(misb::sign_extend(0xFFFFFFFFu, 4) == -1);
+
+    // Vector wrappers in st_common.h share the primitives
+    auto long_form = misb::encode_ber_length(300);
+    assert(long_form == reference_ber_length(300));
+    size_t len_bytes = 0;
+    assert(misb::decode_ber_length(long_form, 0, len, len_bytes));
+    assert(len == 300 && len_bytes == 3);
+    assert(!misb::decode_ber_length(long_form, 3, len, len_bytes));
+
+    return 0;
+}
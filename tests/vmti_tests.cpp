@@ -0,0 +1,227 @@
+#include "klv.h"
+#include "klv_macros.h"
+#include "st0903.h"
+#include "st0903_table.h"
+#include "st0903_cache.h"
+#include "st_common.h"
+#include <cassert>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+static double find_value(const KLVSet& set, const UL& ul) {
+    for (const auto& node : set.children()) {
+        if (auto leaf = std::dynamic_pointer_cast<KLVLeaf>(node)) {
+            if (leaf->ul() == ul) return leaf->value();
+        }
+    }
+    return std::numeric_limits<double>::quiet_NaN();
+}
+
+int main() {
+    auto& reg = KLVRegistry::instance();
+    misb::st0903::register_st0903(reg);
+    using namespace misb::st0903;
+
+    // Columnar decode matches the KLVSet-based decoder
+    std::vector<VTargetPack> packs;
+    for (int i = 0; i < 300; ++i) {
+        const double id = 1000.0 + i * 7;
+        if (i % 3 == 0) {
+            packs.push_back(KLV_VTARGET_PACK(
+                id,
+                KLV_TAG(VTARGET_CENTROID, 5000.0 + i),
+                KLV_TAG(VTARGET_CONFIDENCE_LEVEL, 0.5)
+            ));
+        } else {
+            packs.push_back(KLV_VTARGET_PACK(
+                id,
+                KLV_TAG(VTARGET_CENTROID, 5000.0 + i),
+                KLV_TAG(VTARGET_BBOX_TOP_LEFT_PIXEL, 4000.0 + i),
+                KLV_TAG(VTARGET_BBOX_BOTTOM_RIGHT_PIXEL, 6000.0 + i),
+                KLV_TAG(VTARGET_PRIORITY, static_cast<double>(i % 255 + 1)),
+                KLV_TAG(VTARGET_CONFIDENCE_LEVEL, (i % 100) / 100.0),
+                KLV_TAG(VTARGET_LOCATION_OFFSET_LAT, -0.001 * i),
+                KLV_TAG(VTARGET_LOCATION_OFFSET_LON, 0.002 * i),
+                KLV_TAG(VTARGET_LOCATION_HAE, 100.0 + i),
+                KLV_TAG(VTARGET_CENTROID_ROW, 10.0 + i),
+                KLV_TAG(VTARGET_CENTROID_COLUMN, 20.0 + i),
+                KLV_TAG(VTARGET_ALGORITHM_ID, 3.0),
+                KLV_TAG(VTARGET_DETECTION_STATUS, 1.0)
+            ));
+        }
+    }
+    auto series = encode_vtarget_series(packs);
+    auto reference = decode_vtarget_series(series);
+
+    VTargetTable table;
+    decode_vtarget_table(series, table);
+    assert(table.size() == reference.size());
+    for (size_t i = 0; i < table.size(); ++i) {
+        const KLVSet& set = reference[i].set;
+        assert(table.id[i] == reference[i].target_id);
+        assert(table.has(i, VTARGET_FIELD_CENTROID));
+        assert(static_cast<double>(table.centroid[i]) == find_value(set, VTARGET_CENTROID));
+        assert(std::fabs(table.confidence[i] - find_value(set, VTARGET_CONFIDENCE_LEVEL)) < 1e-12);
+        if (i % 3 == 0) {
+            assert(!table.has(i, VTARGET_FIELD_HAE));
+            assert(!table.has(i, VTARGET_FIELD_BBOX_TOP_LEFT));
+            continue;
+        }
+        assert(table.has(i, VTARGET_FIELD_HAE));
+        assert(static_cast<double>(table.bbox_top_left[i]) == find_value(set, VTARGET_BBOX_TOP_LEFT_PIXEL));
+        assert(static_cast<double>(table.bbox_bottom_right[i]) == find_value(set, VTARGET_BBOX_BOTTOM_RIGHT_PIXEL));
+        assert(static_cast<double>(table.priority[i]) == find_value(set, VTARGET_PRIORITY));
+        assert(std::fabs(table.lat_offset[i] - find_value(set, VTARGET_LOCATION_OFFSET_LAT)) < 1e-12);
+        assert(std::fabs(table.lon_offset[i] - find_value(set, VTARGET_LOCATION_OFFSET_LON)) < 1e-12);
+        assert(std::fabs(table.hae[i] - find_value(set, VTARGET_LOCATION_HAE)) < 1e-12);
+        assert(static_cast<double>(table.centroid_row[i]) == find_value(set, VTARGET_CENTROID_ROW));
+        assert(static_cast<double>(table.centroid_column[i]) == find_value(set, VTARGET_CENTROID_COLUMN));
+        assert(table.detection_status[i] == 1);
+        assert(table.algorithm_id[i] == 3);
+    }
+
+    // Bulk encoding reproduces the KLVSet-based series byte for byte
+    assert(encode_vtarget_table(table) == series);
+    assert(encode_vtarget_table(table, 4) == series);
+
+    // Thread counts that leave the last chunks empty (12 rows, 5 threads)
+    {
+        const std::vector<VTargetPack> few(packs.begin(), packs.begin() + 12);
+        const auto few_series = encode_vtarget_series(few);
+        VTargetTable few_table;
+        decode_vtarget_table(few_series, few_table);
+        assert(encode_vtarget_table(few_table, 5) == few_series);
+    }
+
+    KLVSet header = KLV_LOCAL_DATASET(
+        KLV_TAG(VMTI_FRAME_WIDTH, 1920.0),
+        KLV_TAG(VMTI_FRAME_HEIGHT, 1080.0)
+    );
+    auto frame = encode_vmti_frame(header, table, 3);
+    KLVSet decoded_frame(false, ST_ID);
+    decoded_frame.decode(frame);
+    assert(find_value(decoded_frame, VMTI_FRAME_WIDTH) == 1920.0);
+    bool found_series = false;
+    for (const auto& node : decoded_frame.children()) {
+        if (auto bytes = std::dynamic_pointer_cast<KLVBytes>(node)) {
+            if (bytes->ul() == VMTI_VTARGET_SERIES) {
+                found_series = true;
+                assert(bytes->value() == series);
+            }
+        }
+    }
+    assert(found_series);
+
+    VTargetTable invalid;
+    invalid.add(5);
+    invalid.present[0] = VTARGET_FIELD_CENTROID;
+    invalid.add(5);
+    invalid.present[1] = VTARGET_FIELD_CENTROID;
+    bool encode_duplicate_error = false;
+    try {
+        encode_vtarget_table(invalid);
+    } catch (const std::runtime_error&) {
+        encode_duplicate_error = true;
+    }
+    assert(encode_duplicate_error);
+    invalid.id[1] = 6;
+    invalid.present[1] = 0;
+    bool empty_pack_error = false;
+    try {
+        encode_vtarget_table(invalid);
+    } catch (const std::runtime_error&) {
+        empty_pack_error = true;
+    }
+    assert(empty_pack_error);
+
+    // Duplicate ids and truncated packs are rejected
+    auto duplicated = series;
+    auto first = encode_vtarget_series({packs.front()});
+    duplicated.insert(duplicated.end(), first.begin(), first.end());
+    bool duplicate_error = false;
+    try {
+        decode_vtarget_table(duplicated, table);
+    } catch (const std::runtime_error&) {
+        duplicate_error = true;
+    }
+    assert(duplicate_error);
+
+    auto truncated = series;
+    truncated.pop_back();
+    bool truncated_error = false;
+    try {
+        decode_vtarget_table(truncated, table);
+    } catch (const std::runtime_error&) {
+        truncated_error = true;
+    }
+    assert(truncated_error);
+
+    // Repeated algorithm series share one decode and one encode
+    SeriesCache algorithms(ALGORITHM_ST_ID, 2);
+    const std::vector<uint8_t> name = {'D', 'e', 't'};
+    std::vector<KLVSet> algorithm_sets = {
+        KLV_ALGORITHM_SET(
+            KLV_LOCAL_LEAF(ALGORITHM_ID, 7.0),
+            KLV_LOCAL_BYTES(ALGORITHM_NAME, name),
+            KLV_LOCAL_LEAF(ALGORITHM_CONFIDENCE, 0.75)
+        )
+    };
+    auto algorithm_bytes = algorithms.encode(algorithm_sets);
+    assert(*algorithm_bytes == encode_algorithm_series(algorithm_sets));
+    assert(algorithms.encode(algorithm_sets) == algorithm_bytes);
+    assert(algorithms.hits() == 1 && algorithms.misses() == 1);
+
+    auto decoded_series = algorithms.decode(*algorithm_bytes);
+    assert(decoded_series->size() == 1);
+    assert(find_value(decoded_series->front(), ALGORITHM_ID) == 7.0);
+    const std::vector<uint8_t> same_bytes(algorithm_bytes->begin(), algorithm_bytes->end());
+    assert(algorithms.decode(same_bytes) == decoded_series);
+    assert(algorithms.hits() == 2);
+
+    // A changed value misses and is encoded afresh
+    std::dynamic_pointer_cast<KLVLeaf>(algorithm_sets[0].children()[0])->set_value(8.0);
+    auto changed = algorithms.encode(algorithm_sets);
+    assert(changed != algorithm_bytes);
+    assert(*changed == encode_algorithm_series(algorithm_sets));
+    assert(find_value(algorithms.decode(*changed)->front(), ALGORITHM_ID) == 8.0);
+
+    // Malformed payloads still throw and are not cached
+    bool series_error = false;
+    try {
+        algorithms.decode(std::vector<uint8_t>{0x05, 0x01});
+    } catch (const std::runtime_error&) {
+        series_error = true;
+    }
+    assert(series_error);
+    assert(algorithms.size() <= 4);
+
+    // Concurrent callers agree on one entry per series
+    {
+        SeriesCache shared(ALGORITHM_ST_ID, 2);
+        const auto expected = encode_algorithm_series(algorithm_sets);
+        std::vector<std::thread> workers;
+        for (int t = 0; t < 4; ++t) {
+            workers.emplace_back([&]() {
+                for (int i = 0; i < 200; ++i) {
+                    assert(*shared.encode(algorithm_sets) == expected);
+                    assert(shared.decode(expected)->size() == 1);
+                }
+            });
+        }
+        for (auto& w : workers) w.join();
+        assert(shared.size() == 2 && shared.hits() + shared.misses() == 1600);
+    }
+
+    // Process-wide helpers
+    auto ontology_bytes = encode_ontology_series_cached({
+        KLV_ONTOLOGY_SET(KLV_LOCAL_LEAF(ONTOLOGY_ID, 301.0))
+    });
+    auto ontologies = decode_ontology_series_cached(*ontology_bytes);
+    assert(decode_ontology_series_cached(*ontology_bytes) == ontologies);
+    assert(find_value(ontologies->front(), ONTOLOGY_ID) == 301.0);
+
+    return 0;
+}